@@ -0,0 +1,128 @@
+#!/bin/bash
+# Runs the benchmark suite: generates proofs of increasing size for every kind
+# of workload (see genproof.sh), verifies them and prints time, peak RSS and
+# number of comparisons per size. The growth exponents between two consecutive
+# sizes (e.g. 2 for quadratic growth) make complexity regressions obvious.
+# If the hardware performance counters are available, they are printed per
+# size below the table, split into parsing and verification.
+#
+# usage: bench.sh [<proveparser binary>]
+#
+# environment:
+#   KINDS           kinds of workloads (default: all)
+#   SIZES_<kind>    sizes of a kind (e.g. SIZES_incidence="4 8 16")
+#   TIMEOUT         time limit of a single run in seconds (default: 60)
+
+BIN=${1:-bin/proveparser}
+DIR=$(dirname "$0")
+OUT=$DIR/out
+KINDS=${KINDS:-"incidence conjuncts vars nesting"}
+TIMEOUT=${TIMEOUT:-60}
+
+# the search for "vars" grows combinatorially (size 7 exceeds the timeout)
+: ${SIZES_incidence:="2 4 8 16 24 32"}
+: ${SIZES_conjuncts:="16 32 64 128 256"}
+: ${SIZES_vars:="1 2 3 4 5 6"}
+: ${SIZES_nesting:="16 32 64 128 256"}
+
+if [ ! -x "$BIN" ]
+then
+	echo "cannot execute '$BIN'" >&2
+	exit 1
+fi
+
+mkdir -p "$OUT"
+S=0
+HW=""
+
+for KIND in $KINDS
+do
+	SIZES=SIZES_$KIND
+	for VARIANT in valid invalid
+	do
+		printf "\n%s (%s):\n" "$KIND" "$VARIANT"
+		printf "%8s %-10s %10s %10s %14s %8s %8s\n" "size" "result" \
+			"time [ms]" "RSS [kB]" "comparisons" "exp(t)" "exp(cmp)"
+		PREV=""
+		: > "$OUT/hw"
+		for N in ${!SIZES}
+		do
+			T=$OUT/$KIND-$N-$VARIANT.prove
+			if [ "$VARIANT" = "valid" ]
+			then
+				$DIR/genproof.sh "$KIND" "$N" > "$T" || exit 1
+				EXPECTED=0
+			else
+				$DIR/genproof.sh "$KIND" "$N" invalid > "$T" || exit 1
+				EXPECTED=1
+			fi
+
+			START=$(date +%s%N)
+			timeout "$TIMEOUT" "$BIN" "$T" --stats --hwcounters \
+				> /dev/null 2> "$T.err"
+			RC=$?
+			END=$(date +%s%N)
+
+			if [ $RC -eq $EXPECTED ]
+			then
+				RESULT=ok
+			elif [ $RC -eq 124 ]
+			then
+				RESULT=timeout
+			elif [ $RC -ge 128 ]
+			then
+				RESULT=crash
+			else
+				RESULT=wrong
+				S=1
+			fi
+
+			# comparisons from the totals and peak RSS of "--stats"
+			CMP=$(awk '$1 == "total" { print $3 }' "$T.err")
+			RSS=$(awk '/^peak RSS/ { print $NF }' "$T.err")
+
+			awk -v n="$N" -v r="$RESULT" -v t="$(( (END - START) / 1000 ))" \
+				-v rss="${RSS:--}" -v cmp="${CMP:--}" -v prev="$PREV" '
+			function exponent(a, b, m, k) {
+				if (m <= 0 || k <= 0 || a <= 0 || b <= 0 || m == k) {
+					return "-"
+				}
+				return sprintf("%.2f", log(b / a) / log(k / m))
+			}
+			BEGIN {
+				split(prev, p, " ")
+				printf("%8d %-10s %10.1f %10s %14s %8s %8s\n", n, r,
+					t / 1000, rss, cmp, exponent(p[2], t, p[1], n),
+					exponent(p[3], cmp, p[1], n))
+			}'
+
+			# hardware counters of "--hwcounters" (parse and verify)
+			awk -v n="$N" '
+			$1 == "hw" { hw = 1; next }
+			hw && NF == 3 { printf("%8d %-16s %16s %16s\n", n, $1, $2, $3) }
+			' "$T.err" >> "$OUT/hw"
+
+			if [ "$RESULT" = "ok" ]
+			then
+				PREV="$N $(( (END - START) / 1000 )) ${CMP:-0}"
+			else
+				PREV=""
+			fi
+		done
+
+		if [ -s "$OUT/hw" ]
+		then
+			printf "\n%8s %-16s %16s %16s\n" "size" "hw counter" "parse" \
+				"verify"
+			cat "$OUT/hw"
+			HW=yes
+		fi
+	done
+done
+
+if [ -z "$HW" ]
+then
+	printf "\n(hardware counters are not available)\n"
+fi
+
+exit $S
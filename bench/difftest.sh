@@ -0,0 +1,172 @@
+#!/bin/bash
+# Differential testing of two verification engines: every proof is verified by
+# a reference and a candidate engine and every statement, on which they
+# disagree (e.g. the candidate verifies a statement, which the reference
+# rejects), is reported. The effort of both engines is printed side by side,
+# so that every speedup is shown to preserve the results.
+#
+# The reference has to be an engine independent of the candidate, so that
+# regressions of the search are detected: either its command is given in REF,
+# or it is built from a revision of the repository given in REF_REV (e.g. the
+# revision before the changes under test). There is no default, since
+# comparing a binary with itself would detect nothing.
+#
+# usage: REF_REV=<revision> difftest.sh [<proveparser binary>]
+#        REF=<command> difftest.sh [<proveparser binary>]
+#
+# environment:
+#   REF             command of the reference engine
+#   REF_REV         revision to build the reference proveparser from (only if
+#                   REF is not set; it has to support "--profile=json")
+#   CAND            command of the candidate engine (default: the binary with
+#                   its default strategies)
+#   SIZES_<kind>    sizes of the generated proofs of a kind (see genproof.sh)
+#   TIMEOUT         time limit of a single run in seconds (default: 60)
+#
+# Both commands are called with a file and "--profile=json" as arguments.
+# The script exits with 1, if the engines disagree on any statement.
+
+BIN=${1:-bin/proveparser}
+DIR=$(dirname "$0")
+OUT=$DIR/out/diff
+TIMEOUT=${TIMEOUT:-60}
+
+CAND=${CAND:-"$BIN"}
+
+# (the search for "vars" grows combinatorially with its size)
+: ${SIZES_incidence:="2 4 8"}
+: ${SIZES_conjuncts:="16 64"}
+: ${SIZES_vars:="1 2 3 4 5"}
+: ${SIZES_nesting:="16 64"}
+
+if [ ! -x "$BIN" ]
+then
+	echo "cannot execute '$BIN'" >&2
+	exit 1
+fi
+
+if [ -z "$REF" ] && [ -z "$REF_REV" ]
+then
+	echo "set REF to the command of the reference engine or REF_REV to the" \
+		"revision to build it from" >&2
+	exit 1
+fi
+
+mkdir -p "$OUT"
+
+# images of imported modules are cached in a temporary directory instead of
+# the cache of the user (see module.c), and the reference is built in another
+# one outside of the source tree
+export XDG_CACHE_HOME=$(mktemp -d)
+REFDIR=$(mktemp -d)
+trap 'rm -rf "$XDG_CACHE_HOME" "$REFDIR"' EXIT
+
+# reference engine built from a revision
+REFNAME=$REF
+if [ -z "$REF" ]
+then
+	REFNAME="revision $REF_REV"
+	git -C "$DIR/.." archive "$REF_REV" | tar -x -C "$REFDIR" || exit 1
+	make -C "$REFDIR" proveparser > /dev/null || exit 1
+	REF="$REFDIR/bin/proveparser"
+fi
+
+# generated corpora
+for KIND in incidence conjuncts vars nesting
+do
+	SIZES=SIZES_$KIND
+	for N in ${!SIZES}
+	do
+		$DIR/genproof.sh "$KIND" "$N" > "$OUT/$KIND-$N.prove" || exit 1
+		$DIR/genproof.sh "$KIND" "$N" invalid \
+			> "$OUT/$KIND-$N-invalid.prove" || exit 1
+	done
+done
+
+# Runs an engine on a file and writes its per-statement records as
+# "<line>:<col> <result> <comparisons> <wall_ns>" to the given file. The
+# exit status of the engine is written to the last line as "exit <status>".
+run_engine()
+{
+	timeout "$TIMEOUT" $1 "$2" --profile=json 2> /dev/null \
+		| sed -n 's/^.*\({"file".*\)$/\1/p' \
+		| awk '
+		function field(name) {
+			if (match($0, "\"" name "\":(\"[^\"]*\"|[^,}]*)")) {
+				v = substr($0, RSTART + length(name) + 3,
+						RLENGTH - length(name) - 3)
+				gsub("\"", "", v)
+				return v
+			}
+			return "-"
+		}
+		{
+			printf("%s:%s %s %s %s\n", field("line"), field("col"),
+				field("result"), field("comparisons"), field("wall_ns"))
+		}' > "$3"
+	echo "exit ${PIPESTATUS[0]}" >> "$3"
+}
+
+printf "reference: %s\ncandidate: %s\n\n" "$REFNAME" "$CAND"
+printf "%-44s %-6s %12s %12s %10s %10s %8s\n" "file" "status" "cmp (ref)" \
+	"cmp (cand)" "ms (ref)" "ms (cand)" "speedup"
+
+S=0
+NFILES=0
+NDIFF=0
+
+for T in testcases/valid/*.prove testcases/invalid/*.prove \
+	doc/examples/*.prove $OUT/*.prove
+do
+	B=$OUT/$(basename "$T" .prove)
+	run_engine "$REF" "$T" "$B.ref"
+	run_engine "$CAND" "$T" "$B.cand"
+
+	# statements, on which the engines disagree, and the totals of both
+	awk -v file="$T" '
+	FNR == NR {
+		if ($1 == "exit") { rexit = $2; next }
+		ref[$1] = $2; order[++n] = $1
+		rcmp += $3; rns += $4
+		next
+	}
+	{
+		if ($1 == "exit") { cexit = $2; next }
+		cand[$1] = $2
+		if (!($1 in ref)) { order[++n] = $1 }
+		ccmp += $3; cns += $4
+	}
+	END {
+		diff = 0
+		for (i = 1; i <= n; i++) {
+			k = order[i]
+			r = (k in ref) ? ref[k] : "missing"
+			c = (k in cand) ? cand[k] : "missing"
+			if (r != c) {
+				lines = lines sprintf("    %-20s reference: %-10s candidate: %s\n",
+					k, r, c)
+				diff = 1
+			}
+		}
+		if (rexit != cexit) {
+			lines = lines sprintf("    %-20s reference: %-10s candidate: %s\n",
+				"exit status", rexit, cexit)
+			diff = 1
+		}
+		printf("%-44s %-6s %12d %12d %10.1f %10.1f %8s\n", file,
+			diff ? "DIFF" : "same", rcmp, ccmp, rns / 1e6, cns / 1e6,
+			cns > 0 ? sprintf("%.2f", rns / cns) : "-")
+		printf("%s", lines)
+		exit diff
+	}' "$B.ref" "$B.cand"
+
+	if [ $? -ne 0 ]
+	then
+		S=1
+		NDIFF=$((NDIFF + 1))
+	fi
+	NFILES=$((NFILES + 1))
+done
+
+printf "\n%d of %d files with differences\n" "$NDIFF" "$NFILES"
+exit $S
@@ -0,0 +1,99 @@
+#!/bin/bash
+# Generates [prove] files of scalable size for benchmarking.
+#
+# usage: genproof.sh <kind> <size> [invalid]
+#
+# kinds:
+#   incidence   <size> points on a plane, which are shown to lie on the plane
+#               and to be joined with their neighbour (cf. IncAxiom3.prove)
+#   conjuncts   a single id with <size> properties, which are looked up in
+#               reverse order
+#   vars        an axiom quantifying over <size> points, which is applied to
+#               the points in reverse order
+#   nesting     modus ponens through <size> nested implications
+#
+# With "invalid", the proof ends with an unprovable statement, which has to be
+# searched for exhaustively (so verification is expected to fail).
+
+KIND=$1
+N=$2
+INVALID=$3
+
+if [ -z "$KIND" ] || [ -z "$N" ] || [ "$N" -lt 1 ]
+then
+	echo "usage: $0 <incidence|conjuncts|vars|nesting> <size> [invalid]" >&2
+	exit 1
+fi
+
+# hypotheses are printed directly, conclusions are collected and joined by "=>"
+CONCL=()
+
+case $KIND in
+incidence)
+	echo "[pln] [[pln]:plane]"
+	echo "[ [x] [[x]:point] => [[x]in[pln]] ]"
+	echo "[ [x] [[x]:point] [y] [[y]:point] => [[x][y]joined] ]"
+	for ((i = 1; i <= N; i++))
+	do
+		echo "[p$i] [[p$i]:point]"
+	done
+	for ((i = 1; i <= N; i++))
+	do
+		CONCL+=("[[p$i]in[pln]]" "[[p$i][p$((i % N + 1))]joined]")
+	done
+	;;
+conjuncts)
+	printf "[a]"
+	for ((i = 1; i <= N; i++))
+	do
+		printf " [[a]:c$i]"
+	done
+	echo
+	for ((i = N; i >= 1; i--))
+	do
+		CONCL+=("[[a]:c$i]")
+	done
+	;;
+vars)
+	HEAD=""
+	TUPLE=""
+	for ((i = 1; i <= N; i++))
+	do
+		HEAD="$HEAD[x$i] [[x$i]:point] "
+		TUPLE="$TUPLE[x$i]"
+	done
+	echo "[ $HEAD=> [${TUPLE}col] ]"
+	TUPLE=""
+	for ((i = 1; i <= N; i++))
+	do
+		echo "[p$i] [[p$i]:point]"
+		TUPLE="[p$i]$TUPLE"
+	done
+	CONCL+=("[${TUPLE}col]")
+	;;
+nesting)
+	IMPL="[[]T]"
+	for ((i = N; i >= 1; i--))
+	do
+		echo "[a$i] [[a$i]:t]"
+		IMPL="[ [[a$i]:t] => $IMPL ]"
+	done
+	echo "$IMPL"
+	CONCL+=("[[]T]")
+	;;
+*)
+	echo "unknown kind '$KIND'" >&2
+	exit 1
+	;;
+esac
+
+if [ "$INVALID" = "invalid" ]
+then
+	CONCL+=("[[]False]")
+fi
+
+for ((i = 0; i < ${#CONCL[@]}; i++))
+do
+	echo "=>"
+	echo "${CONCL[$i]}"
+done
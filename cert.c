@@ -0,0 +1,769 @@
+/* [prove]: A proof verification system using bracketed expressions.
+ * Copyright (C) 2021  Gregor Feierabend
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "cert.h"
+#include "pscanner.h"
+#include "strategy.h"
+#include "congr.h"
+#include "debug.h"
+
+/* --- preprocessor directives ---------------------------------------------- */
+#define TRUE 1
+#define FALSE 0
+
+/* initial number of steps and records */
+#define CERT_STEPS 64
+#define CERT_RECORDS 64
+
+/* maximal length of a strategy name in a certificate (as in the format
+ * string of cert_load) */
+#define CERT_NAMELEN 31
+
+/* first line of a certificate (followed by the version of the format) */
+#define CERT_MAGIC "prove-cert"
+#define CERT_VERSION 1
+
+/* maximal length of the name of a cache entry within the cache directory
+ * (including the suffix of a temporary file) */
+#define CACHE_NAMELEN 64
+
+/* initial number of slots of the in-memory cache (power of two) */
+#define CACHE_SLOTS 256
+
+/* A certificate is a text file with one record per verified list (in the order
+ * in which the lists are verified) of the form
+ *
+ *   s <line> <column> <strategy>
+ *
+ * followed by one line per step
+ *
+ *   <kind> <goal> <root> <justification> <n> [<variable> <constant>]...
+ *
+ * where the step kinds are those of CertKind and all Pnodes are given by their
+ * num_c (-1 if none). Lists, which have not been verified (i.e. which have been
+ * postponed to the parent level), have the strategy "-" and no steps. */
+
+/* --- function prototypes -------------------------------------------------- */
+void cache_store(int line, int col, unsigned short int verified,
+		char* strategy);
+
+/* --- global variables ----------------------------------------------------- */
+static FILE* cert = NULL;
+
+/* steps of the list currently being verified (or of all lists of a loaded
+ * certificate) */
+static CertStep* steps = NULL;
+static int n_steps = 0;
+static int size_steps = 0;
+
+/* records of a loaded certificate and the next one to be replayed */
+static CertRecord* records = NULL;
+static int n_records = 0;
+static int size_records = 0;
+static int next_record = 0;
+
+/* directory of the verification cache (NULL if none) and TRUE, if the list
+ * currently being verified has been found in the cache */
+static char* cache_dir = NULL;
+static unsigned short int cache_hit = FALSE;
+static uint64_t cache_key;
+
+/* in-memory cache (if there is no cache directory) */
+static CacheEntry* mem = NULL;
+static int n_mem = 0;
+static int size_mem = 0;
+
+/* --- certificate files ---------------------------------------------------- */
+/**
+ * @brief Opens a file to write a certificate to.
+ *
+ * @param filename name of the certificate file
+ *
+ * @return FALSE, if the file cannot be opened
+ */
+unsigned short int cert_open(char* filename)
+{
+	if ((cert = fopen(filename, "w")) == NULL) {
+		return FALSE;
+	}
+	fprintf(cert, "%s %d\n", CERT_MAGIC, CERT_VERSION);
+	do_cert = TRUE;
+	return TRUE;
+}
+
+/**
+ * @brief Allocates a new step.
+ *
+ * @return pointer to the new step
+ */
+CertStep* new_step()
+{
+	if (n_steps == size_steps) {
+		size_steps = size_steps == 0 ? CERT_STEPS : 2 * size_steps;
+		steps = (CertStep*) realloc(steps, sizeof(CertStep) * size_steps);
+	}
+	return &(steps[n_steps++]);
+}
+
+/**
+ * @brief Reads the records of a certificate (following its first line) and
+ * appends them to the loaded records and steps.
+ *
+ * @param file certificate file
+ *
+ * @return FALSE, if the file is not a valid certificate
+ */
+unsigned short int read_records(FILE* file)
+{
+	CertRecord* r;
+	CertStep* st;
+	char kind;
+	char name[CERT_NAMELEN + 1];
+	int version;
+	int i;
+
+	if (fscanf(file, CERT_MAGIC " %d", &version) != 1
+			|| version != CERT_VERSION) {
+		return FALSE;
+	}
+
+	r = NULL;
+	while (fscanf(file, " %c", &kind) == 1) {
+		if (kind == 's') {
+			if (n_records == size_records) {
+				size_records = size_records == 0 ? CERT_RECORDS
+					: 2 * size_records;
+				records = (CertRecord*) realloc(records,
+						sizeof(CertRecord) * size_records);
+			}
+			r = &(records[n_records++]);
+			r->strategy = NULL;
+			r->first = n_steps;
+			r->n_steps = 0;
+			if (fscanf(file, "%d %d %31s", &(r->line),
+						&(r->col), name) != 3) {
+				break;
+			}
+			if (strcmp(name, "-") != 0) {
+				r->strategy = (char*) malloc(strlen(name) + 1);
+				strcpy(r->strategy, name);
+			}
+			continue;
+		}
+
+		if (r == NULL || r->strategy == NULL) {
+			break;
+		}
+		st = new_step();
+		st->kind = kind;
+		st->n_binds = 0;
+		st->binds = NULL;
+		if (fscanf(file, "%d %d %d %d", &(st->goal), &(st->root),
+					&(st->expl), &(st->n_binds)) != 4 || st->n_binds < 0) {
+			st->n_binds = 0;
+			break;
+		}
+		st->binds = (int*) malloc(sizeof(int) * (2 * st->n_binds + 1));
+		for (i = 0; i < 2 * st->n_binds; i++) {
+			if (fscanf(file, "%d", &(st->binds[i])) != 1) {
+				break;
+			}
+		}
+		if (i < 2 * st->n_binds) {
+			break;
+		}
+		r->n_steps++;
+	}
+
+	return feof(file);
+}
+
+/**
+ * @brief Frees the loaded records.
+ */
+void free_records()
+{
+	int i;
+
+	for (i = 0; i < n_records; i++) {
+		free(records[i].strategy);
+	}
+	n_records = next_record = 0;
+}
+
+/**
+ * @brief Loads a certificate to be replayed.
+ *
+ * @param filename name of the certificate file
+ *
+ * @return FALSE, if the file cannot be read or is not a valid certificate
+ */
+unsigned short int cert_load(char* filename)
+{
+	FILE* file;
+
+	if ((file = fopen(filename, "r")) == NULL) {
+		fprintf(stderr, "error opening '%s'\n", filename);
+		return FALSE;
+	}
+
+	if (!read_records(file)) {
+		fprintf(stderr, "'%s' is not a valid certificate of version %d\n",
+				filename, CERT_VERSION);
+		fclose(file);
+		return FALSE;
+	}
+
+	fclose(file);
+	do_replay = TRUE;
+	return TRUE;
+}
+
+/**
+ * @brief Closes the certificate file and frees the recorded or loaded steps.
+ *
+ * @return FALSE, if a replayed certificate contains records of lists, which
+ * have not been verified
+ */
+unsigned short int cert_close()
+{
+	unsigned short int complete;
+	int i;
+
+	complete = (next_record == n_records);
+
+	cert_begin();
+	free(steps);
+	steps = NULL;
+	size_steps = 0;
+
+	free_records();
+	free(records);
+	records = NULL;
+	size_records = 0;
+
+	if (cert != NULL) {
+		fclose(cert);
+		cert = NULL;
+	}
+	free(cache_dir);
+	cache_dir = NULL;
+	for (i = 0; i < size_mem; i++) {
+		free(mem[i].text);
+	}
+	free(mem);
+	mem = NULL;
+	n_mem = size_mem = 0;
+	do_cert = do_replay = do_cache = FALSE;
+
+	return complete;
+}
+
+/* --- recording ------------------------------------------------------------ */
+/**
+ * @brief Discards the steps recorded so far (e.g. by a strategy, which has
+ * failed to verify the list).
+ */
+void cert_begin()
+{
+	int i;
+
+	for (i = 0; i < n_steps; i++) {
+		free(steps[i].binds);
+	}
+	n_steps = 0;
+}
+
+/**
+ * @brief Records a step justifying a statement.
+ *
+ * @param kind kind of the step
+ * @param goal statement to be verified (NULL for CERT_FORWARD)
+ * @param root Pnode, at which exploration has started (may be NULL)
+ * @param expl justifying constant or reachable sub-tree (may be NULL)
+ * @param subd substitutions in place (may be NULL)
+ */
+void cert_step(CertKind kind, Pnode* goal, Pnode* root, Pnode* expl,
+		SUB* subd)
+{
+	CertStep* st;
+	SUB* s;
+	int i;
+
+	if (!do_cert) {
+		return;
+	}
+
+	st = new_step();
+	st->kind = kind;
+	st->goal = (goal != NULL) ? goal->num_c : -1;
+	st->root = (root != NULL) ? root->num_c : -1;
+	st->expl = (expl != NULL) ? expl->num_c : -1;
+
+	st->n_binds = 0;
+	for (s = subd; s != NULL; s = s->prev) {
+		st->n_binds++;
+	}
+	st->binds = (int*) malloc(sizeof(int) * (2 * st->n_binds + 1));
+
+	/* the SUB list is linked backwards */
+	for (s = subd, i = st->n_binds - 1; s != NULL; s = s->prev, i--) {
+		st->binds[2 * i] = s->vtree->pnode->num_c;
+		st->binds[2 * i + 1] = s->known_const->num_c;
+	}
+}
+
+/**
+ * @brief Reverses the order of the recorded steps (vq_recurs records its steps
+ * while returning from the recursion).
+ */
+void cert_reverse()
+{
+	CertStep tmp;
+	int i;
+
+	for (i = 0; i < n_steps / 2; i++) {
+		tmp = steps[i];
+		steps[i] = steps[n_steps - 1 - i];
+		steps[n_steps - 1 - i] = tmp;
+	}
+}
+
+/**
+ * @brief Writes a record with the recorded steps to a file.
+ *
+ * @param file certificate file
+ * @param line line of the list in the source file
+ * @param col column of the list in the source file
+ * @param verified TRUE, if verification was successful
+ * @param strategy name of the strategy, which verified the list
+ */
+void write_record(FILE* file, int line, int col, unsigned short int verified,
+		char* strategy)
+{
+	CertStep* st;
+	int i;
+	int j;
+
+	fprintf(file, "s %d %d %s\n", line, col,
+			(verified && strategy != NULL) ? strategy : "-");
+	for (i = 0; verified && i < n_steps; i++) {
+		st = &(steps[i]);
+		fprintf(file, "%c %d %d %d %d", st->kind, st->goal, st->root,
+				st->expl, st->n_binds);
+		for (j = 0; j < 2 * st->n_binds; j++) {
+			fprintf(file, " %d", st->binds[j]);
+		}
+		fprintf(file, "\n");
+	}
+}
+
+/**
+ * @brief Writes the record of a list to the certificate and stores it in the
+ * cache, after verification has been attempted.
+ *
+ * @param line line of the list in the source file
+ * @param col column of the list in the source file
+ * @param verified TRUE, if verification was successful
+ * @param strategy name of the strategy, which verified the list
+ */
+void cert_finish(int line, int col, unsigned short int verified,
+		char* strategy)
+{
+	if (!do_cert) {
+		return;
+	}
+
+	if (cert != NULL) {
+		write_record(cert, line, col, verified, strategy);
+	}
+	/* an unknown outcome (see strategy.c) depends on the machine */
+	if (do_cache && !cache_hit && (verified || !budget_exhausted)) {
+		cache_store(line, col, verified, strategy);
+	}
+
+	cache_hit = FALSE;
+	cert_begin();
+}
+
+/**
+ * @brief Redirects the records written to the certificate to another stream
+ * (e.g. to be sent to another process, see jobs.c).
+ *
+ * @param file stream, to which records are written (NULL for none)
+ *
+ * @return stream, to which records have been written before
+ */
+FILE* cert_redirect(FILE* file)
+{
+	FILE* prev;
+
+	prev = cert;
+	cert = file;
+	return prev;
+}
+
+/**
+ * @brief Appends records (e.g. of another process) to the certificate.
+ *
+ * @param text records in the format of a certificate (without its first line)
+ */
+void cert_append(char* text)
+{
+	if (cert != NULL) {
+		fputs(text, cert);
+	}
+}
+
+/* --- replay --------------------------------------------------------------- */
+/**
+ * @brief Verifies a list by checking the justifications recorded in the next
+ * record of the loaded certificate instead of searching. The run is rejected,
+ * if the record does not belong to the list or if any justification does not
+ * hold.
+ *
+ * @param pn last Pnode of the list to be verified (followed by the dummy)
+ * @param pexstart Pnode at the beginning of the list
+ * @param line line of the list in the source file
+ * @param col column of the list in the source file
+ *
+ * @return TRUE, if the list has been verified; FALSE, if its verification has
+ * been postponed to the parent level
+ */
+unsigned short int cert_replay(Pnode* pn, Pnode* pexstart, int line, int col)
+{
+	CertRecord* r;
+	unsigned short int verified;
+
+	if (next_record == n_records) {
+		fprintf(stderr, SHELL_RED "certificate has no record for line %d, "
+				"column %d" SHELL_RESET1 "\n", line, col);
+		exit(EXIT_FAILURE);
+	}
+
+	r = &(records[next_record++]);
+	if (r->line != line || r->col != col) {
+		fprintf(stderr, SHELL_RED "certificate expects line %d, column %d "
+				"instead of line %d, column %d" SHELL_RESET1 "\n",
+				r->line, r->col, line, col);
+		exit(EXIT_FAILURE);
+	}
+
+	st_solved = NULL;
+	if (r->strategy == NULL) {
+		return FALSE;
+	}
+
+	if (strcmp(r->strategy, "facts") == 0) {
+		verified = check_facts(*(pn->right), pexstart, &(steps[r->first]),
+				r->n_steps);
+	} else {
+		verified = check_quantifiers(pexstart, &(steps[r->first]),
+				r->n_steps);
+	}
+	clear_cc();
+
+	if (!verified) {
+		fprintf(stderr, SHELL_RED "certificate rejected on line %d, "
+				"column %d" SHELL_RESET1 "\n", line, col);
+		exit(EXIT_FAILURE);
+	}
+
+	/* the records are freed before the statistics are printed */
+	st_solved = strategy_name(r->strategy);
+	SET_GFLAG_VRFD
+	return TRUE;
+}
+
+/* --- verification cache -------------------------------------------------- */
+/**
+ * @brief Sets up the verification cache. The outcome of every list (together
+ * with its steps) is stored under a key, which is calculated from the tokens
+ * preceding the end of the list (these determine the graph, against which the
+ * list is verified) and the strategy pipeline.
+ *
+ * @param dirname cache directory (created, if it does not exist) or NULL, if
+ * entries are only kept in memory
+ *
+ * @return FALSE, if the directory cannot be created
+ */
+unsigned short int cache_open(char* dirname)
+{
+	struct stat st;
+
+	if (dirname != NULL) {
+		if (stat(dirname, &st) == -1 && mkdir(dirname, 0777) == -1) {
+			return FALSE;
+		}
+		if (stat(dirname, &st) == -1 || !S_ISDIR(st.st_mode)) {
+			return FALSE;
+		}
+		cache_dir = (char*) malloc(strlen(dirname) + 1);
+		strcpy(cache_dir, dirname);
+	}
+
+	do_cache = do_cert = TRUE;
+	return TRUE;
+}
+
+/**
+ * @brief Gets the cache directory.
+ *
+ * @return name of the directory or NULL, if there is none
+ */
+char* cache_path()
+{
+	return cache_dir;
+}
+
+/**
+ * @brief Gets the name of the cache entry of a key.
+ *
+ * @param buf buffer of at least strlen(cache_dir) + CACHE_NAMELEN characters
+ * @param key key of the entry
+ * @param suffix suffix of the file name (e.g. of a temporary file)
+ */
+static void cache_name(char* buf, uint64_t key, char* suffix)
+{
+	sprintf(buf, "%s/%016llx.cert%s", cache_dir, (unsigned long long) key,
+			suffix);
+}
+
+/**
+ * @brief Calculates the slot of a key in the in-memory cache.
+ */
+static int mem_slot(uint64_t key)
+{
+	int i;
+
+	i = (int) (key & (size_mem - 1));
+	while (mem[i].text != NULL && mem[i].key != key) {
+		i = (i + 1) & (size_mem - 1);
+	}
+	return i;
+}
+
+/**
+ * @brief Adds an entry to the in-memory cache (replacing an entry with the
+ * same key).
+ *
+ * @param key key of the entry
+ * @param text record in the format of a certificate (taken over by the
+ * cache)
+ */
+void cache_insert(uint64_t key, char* text)
+{
+	CacheEntry* old;
+	int old_size;
+	int i;
+
+	if (2 * (n_mem + 1) > size_mem) {
+		old = mem;
+		old_size = size_mem;
+		size_mem = size_mem == 0 ? CACHE_SLOTS : 2 * size_mem;
+		mem = (CacheEntry*) calloc(size_mem, sizeof(CacheEntry));
+		for (i = 0; i < old_size; i++) {
+			if (old[i].text != NULL) {
+				mem[mem_slot(old[i].key)] = old[i];
+			}
+		}
+		free(old);
+	}
+
+	i = mem_slot(key);
+	if (mem[i].text == NULL) {
+		n_mem++;
+	}
+	free(mem[i].text);
+	mem[i].key = key;
+	mem[i].text = text;
+}
+
+/**
+ * @brief Opens the cache entry of a key for reading.
+ *
+ * @param key key of the entry
+ *
+ * @return stream of the entry or NULL, if there is no entry
+ */
+static FILE* cache_find(uint64_t key)
+{
+	FILE* file;
+	char* name;
+	int i;
+
+	if (cache_dir == NULL) {
+		if (size_mem == 0 || mem[i = mem_slot(key)].text == NULL) {
+			return NULL;
+		}
+		return fmemopen(mem[i].text, strlen(mem[i].text), "r");
+	}
+
+	name = (char*) malloc(strlen(cache_dir) + CACHE_NAMELEN);
+	cache_name(name, key, "");
+	file = fopen(name, "r");
+	free(name);
+	return file;
+}
+
+/**
+ * @brief Looks up the list in the cache and checks the cached justifications
+ * (as for a certificate). Entries, which cannot be read or whose
+ * justifications do not hold, are ignored (and replaced after the search).
+ *
+ * @param pn last Pnode of the list to be verified (followed by the dummy)
+ * @param pexstart Pnode at the beginning of the list
+ * @param verified set to the cached outcome on a hit
+ *
+ * @return TRUE, if the list has been found in the cache
+ */
+unsigned short int cache_lookup(Pnode* pn, Pnode* pexstart,
+		unsigned short int* verified)
+{
+	FILE* file;
+	CertRecord* r;
+	unsigned short int valid;
+
+	cache_hit = FALSE;
+	if (!do_cache) {
+		return FALSE;
+	}
+
+	cache_key = mix_fp(mix_fp(scan_fp, pipeline_fp()), CERT_VERSION);
+	if ((file = cache_find(cache_key)) == NULL) {
+		cache_misses++;
+		return FALSE;
+	}
+
+	/* the steps are loaded as if they had been recorded, so that they are
+	 * written to the certificate as well */
+	cert_begin();
+	valid = read_records(file) && n_records == 1;
+	fclose(file);
+
+	st_solved = NULL;
+	r = &(records[0]);
+	if (valid && r->strategy != NULL) {
+		st_solved = strategy_name(r->strategy);
+		valid = (st_solved != NULL) && (strcmp(st_solved, "facts") == 0
+				? check_facts(*(pn->right), pexstart, steps, n_steps)
+				: check_quantifiers(pexstart, steps, n_steps));
+		clear_cc();
+	}
+	*verified = valid && r->strategy != NULL;
+	free_records();
+
+	if (!valid) {
+		DBG_VERIFY(fprintf(stderr, SHELL_BROWN "<invalid cache entry %016llx>"
+					SHELL_RESET1, (unsigned long long) cache_key););
+		st_solved = NULL;
+		cert_begin();
+		cache_misses++;
+		return FALSE;
+	}
+
+	if (*verified) {
+		SET_GFLAG_VRFD
+	}
+	cache_hits++;
+	cache_hit = TRUE;
+	return TRUE;
+}
+
+/**
+ * @brief Stores the record of the list in the cache. Entries are written to
+ * a temporary file first, so that concurrent runs never read partial entries.
+ * Entries of the in-memory cache are also written to the export stream (if
+ * any).
+ *
+ * @param line line of the list in the source file
+ * @param col column of the list in the source file
+ * @param verified TRUE, if verification was successful
+ * @param strategy name of the strategy, which verified the list
+ */
+void cache_store(int line, int col, unsigned short int verified,
+		char* strategy)
+{
+	FILE* file;
+	char* name;
+	char* tmp;
+	char* text;
+	size_t len;
+	char suffix[CACHE_NAMELEN];
+
+	if (cache_dir == NULL) {
+		if ((file = open_memstream(&text, &len)) == NULL) {
+			return;
+		}
+		fprintf(file, "%s %d\n", CERT_MAGIC, CERT_VERSION);
+		write_record(file, line, col, verified, strategy);
+		fclose(file);
+
+		if (cache_export != NULL) {
+			fprintf(cache_export, "%016llx %lu\n%s",
+					(unsigned long long) cache_key, (unsigned long) len, text);
+		}
+		cache_insert(cache_key, text);
+		return;
+	}
+
+	name = (char*) malloc(strlen(cache_dir) + CACHE_NAMELEN);
+	tmp = (char*) malloc(strlen(cache_dir) + 2 * CACHE_NAMELEN);
+	cache_name(name, cache_key, "");
+	sprintf(suffix, ".%ld", (long) getpid());
+	cache_name(tmp, cache_key, suffix);
+
+	if ((file = fopen(tmp, "w")) != NULL) {
+		fprintf(file, "%s %d\n", CERT_MAGIC, CERT_VERSION);
+		write_record(file, line, col, verified, strategy);
+		if (fclose(file) != 0 || rename(tmp, name) != 0) {
+			remove(tmp);
+		}
+	}
+
+	free(name);
+	free(tmp);
+}
+
+/**
+ * @brief Reads the entries, which have been exported by another process (see
+ * cache_store), into the in-memory cache.
+ *
+ * @param file stream of exported entries (read until its end)
+ */
+void cache_import(FILE* file)
+{
+	unsigned long long key;
+	unsigned long len;
+	char* text;
+
+	while (fscanf(file, "%llx %lu", &key, &len) == 2 && fgetc(file) == '\n') {
+		text = (char*) malloc(len + 1);
+		if (fread(text, 1, len, file) != len) {
+			free(text);
+			break;
+		}
+		text[len] = '\0';
+		cache_insert((uint64_t) key, text);
+	}
+}
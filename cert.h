@@ -0,0 +1,105 @@
+/* [prove]: A proof verification system using bracketed expressions.
+ * Copyright (C) 2021  Gregor Feierabend
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef CERT_H
+#define CERT_H
+
+#include <stdio.h>
+#include "pgraph.h"
+#include "verify.h"
+
+/* kinds of steps, which justify the statements of a verified list */
+typedef enum {
+	CERT_FACT = 'f',	/* goal is equal to a visible constant sub-tree */
+	CERT_EQ = 'e',		/* goal follows from the known equalities */
+	CERT_CARRY = 'c',	/* goal consists of verified statements only */
+	CERT_REACH = 'q',	/* goal is equal to a reachable sub-tree */
+	CERT_FORWARD = 'w',	/* existential ids are substituted forwards */
+} CertKind;
+
+/* A single step of a certificate. Pnodes are referred to by num_c, which does
+ * not change under substitution and is the same whenever the file is parsed
+ * again. */
+typedef struct cert_step {
+	CertKind kind;
+	int goal;		/* statement to be verified (-1 for CERT_FORWARD) */
+	int root;		/* Pnode at which the search has started exploring towards
+					   the reachable sub-tree (-1 if none) */
+	int expl;		/* justifying constant or reachable sub-tree (-1 if none) */
+	int n_binds;	/* number of substituted variables */
+	int* binds;		/* pairs of substituted variable and substituted
+					   constant (in order of substitution) */
+} CertStep;
+
+/* record of a single list in a certificate */
+typedef struct cert_record {
+	int line;
+	int col;
+	char* strategy;	/* NULL, if verification has been postponed */
+	int first;		/* index of the first step */
+	int n_steps;
+} CertRecord;
+
+/* entry of the in-memory verification cache */
+typedef struct cache_entry {
+	uint64_t key;
+	char* text;		/* record in the format of a certificate (NULL, if the
+					   slot is free) */
+} CacheEntry;
+
+/* TRUE, if steps are recorded (for a certificate or the cache) */
+unsigned short int do_cert;
+/* TRUE, if lists are verified by replaying a certificate */
+unsigned short int do_replay;
+/* TRUE, if outcomes are looked up in and stored to the cache */
+unsigned short int do_cache;
+
+/* stream, to which new entries of the in-memory cache are exported (NULL if
+ * none) */
+FILE* cache_export;
+
+/* number of lists found and not found in the cache */
+unsigned long int cache_hits;
+unsigned long int cache_misses;
+
+unsigned short int cert_open(char* filename);
+unsigned short int cert_load(char* filename);
+unsigned short int cert_close();
+
+/* for recording certificates during verification */
+void cert_begin();
+void cert_step(CertKind kind, Pnode* goal, Pnode* root, Pnode* expl,
+		SUB* subd);
+void cert_reverse();
+void cert_finish(int line, int col, unsigned short int verified,
+		char* strategy);
+FILE* cert_redirect(FILE* file);
+void cert_append(char* text);
+
+/* for replaying certificates */
+unsigned short int cert_replay(Pnode* pn, Pnode* pexstart, int line, int col);
+
+/* for the verification cache */
+unsigned short int cache_open(char* dirname);
+char* cache_path();
+unsigned short int cache_lookup(Pnode* pn, Pnode* pexstart,
+		unsigned short int* verified);
+void cache_insert(uint64_t key, char* text);
+void cache_import(FILE* file);
+
+#endif /* CERT_H */
@@ -0,0 +1,650 @@
+/* [prove]: A proof verification system using bracketed expressions.
+ * Copyright (C) 2021  Gregor Feierabend
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "congr.h"
+#include "nogood.h"
+#include "debug.h"
+
+/* --- preprocessor directives ---------------------------------------------- */
+#define TRUE 1
+#define FALSE 0
+
+/* number of slots in the cache mapping perspectives to closures */
+#define CC_CTX_SLOTS 64
+
+/* Equalities, which are visible from a perspective (i.e. constant equalities
+ * in its prev_const chain), are known to hold. They are merged into a
+ * congruence closure, such that two statements may be compared by comparing
+ * the representatives of their equivalence classes. A closure only depends on
+ * the content of the visible equalities; it is built once and shared by all
+ * perspectives seeing the same equalities (while verifying the same
+ * statement). */
+static CC* closures[CC_BUCKETS];
+
+static Pnode* ctx_head[CC_CTX_SLOTS];
+static uint64_t ctx_bind[CC_CTX_SLOTS];
+static CC* ctx_cc[CC_CTX_SLOTS];
+
+/* --- fingerprints --------------------------------------------------------- */
+/**
+ * @brief Calculates the hash of a symbol.
+ */
+static uint64_t sym_fp(char* sym)
+{
+	uint64_t h;
+
+	h = 0xcbf29ce484222325ULL;
+	while (*sym != '\0') {
+		h ^= (unsigned char) *sym++;
+		h *= 0x100000001b3ULL;
+	}
+	return h;
+}
+
+/**
+ * @brief Calculates a fingerprint of a Pnode and its right neighbours, which
+ * does not depend on the memory layout, but only on what const_equal would
+ * compare.
+ *
+ * @param pnode top left Pnode of the sub-tree
+ *
+ * @return fingerprint of the sub-tree
+ */
+uint64_t cc_fp(Pnode* pnode)
+{
+	uint64_t h;
+
+	if (IS_ID(pnode)) {
+		return mix_fp(CC_ID, sym_fp(*(pnode->symbol)));
+	}
+
+	h = 0;
+	for (; pnode != NULL;
+			pnode = HAS_RIGHT(pnode) ? *(pnode->right) : NULL) {
+		h = mix_fp(h, HAS_SYMBOL(pnode) ? sym_fp(*(pnode->symbol)) : CC_NODE);
+		h = mix_fp(h, HAS_CHILD(pnode) ? cc_fp(*(pnode->child)) : CC_EMPTY);
+	}
+
+	return h;
+}
+
+/* --- union-find ----------------------------------------------------------- */
+/**
+ * @brief Returns the representative of the class of a term.
+ */
+static int cc_find(CC* cc, int t)
+{
+	while (cc->find[t] != t) {
+		cc->find[t] = cc->find[cc->find[t]];
+		t = cc->find[t];
+	}
+	return t;
+}
+
+/**
+ * @brief Replaces the children and right neighbours in a key by the
+ * representatives of their classes.
+ */
+static void cc_canon(CC* cc, CCTerm* key)
+{
+	if (key->child >= 0) {
+		key->child = cc_find(cc, key->child);
+	}
+	if (key->right >= 0) {
+		key->right = cc_find(cc, key->right);
+	}
+}
+
+static unsigned int cc_slot(CC* cc, CCTerm* key)
+{
+	uint64_t h;
+
+	h = mix_fp(key->kind, key->sym != NULL ? sym_fp(key->sym) : 0);
+	h = mix_fp(h, (uint64_t) key->child);
+	h = mix_fp(h, (uint64_t) key->right);
+
+	return (unsigned int) (h & (cc->size_sigs - 1));
+}
+
+static unsigned short int cc_same_key(CCTerm* k1, CCTerm* k2)
+{
+	if (k1->kind != k2->kind || k1->child != k2->child
+			|| k1->right != k2->right) {
+		return FALSE;
+	}
+	if (k1->sym == NULL || k2->sym == NULL) {
+		return (k1->sym == k2->sym);
+	}
+	return (k1->sym == k2->sym || strcmp(k1->sym, k2->sym) == 0);
+}
+
+/**
+ * @brief Looks up a canonical key in the signature table.
+ *
+ * @return term with the same signature or -1
+ */
+static int cc_lookup(CC* cc, CCTerm* key)
+{
+	unsigned int i;
+
+	for (i = cc_slot(cc, key); cc->sigs[i].term >= 0;
+			i = (i + 1) & (cc->size_sigs - 1)) {
+		if (cc_same_key(&(cc->sigs[i].key), key)) {
+			return cc->sigs[i].term;
+		}
+	}
+	return -1;
+}
+
+static void cc_insert_sig(CC* cc, CCTerm* key, int t);
+
+/**
+ * @brief Doubles the size of the signature table. Outdated signatures (of
+ * terms, whose children have been merged since) are dropped.
+ */
+static void cc_grow_sigs(CC* cc)
+{
+	CCTerm key;
+	int i;
+
+	free(cc->sigs);
+	cc->size_sigs *= 2;
+	cc->sigs = (CCSig*) malloc(sizeof(CCSig) * cc->size_sigs);
+	for (i = 0; i < cc->size_sigs; i++) {
+		cc->sigs[i].term = -1;
+	}
+	cc->n_sigs = 0;
+
+	for (i = 0; i < cc->n_terms; i++) {
+		key = cc->terms[i];
+		cc_canon(cc, &key);
+		if (cc_lookup(cc, &key) < 0) {
+			cc_insert_sig(cc, &key, i);
+		}
+	}
+}
+
+static void cc_insert_sig(CC* cc, CCTerm* key, int t)
+{
+	unsigned int i;
+
+	if (2 * (cc->n_sigs + 1) > cc->size_sigs) {
+		cc_grow_sigs(cc);
+	}
+
+	for (i = cc_slot(cc, key); cc->sigs[i].term >= 0;
+			i = (i + 1) & (cc->size_sigs - 1)) {};
+	cc->sigs[i].key = *key;
+	cc->sigs[i].term = t;
+	cc->n_sigs++;
+}
+
+/**
+ * @brief Registers, that term t uses class cls as child or right neighbour.
+ */
+static void cc_add_use(CC* cc, int cls, int t)
+{
+	int u;
+
+	if (cc->n_uses == cc->size_uses) {
+		cc->size_uses *= 2;
+		cc->use_term = (int*) realloc(cc->use_term,
+				sizeof(int) * cc->size_uses);
+		cc->use_next = (int*) realloc(cc->use_next,
+				sizeof(int) * cc->size_uses);
+	}
+
+	u = cc->n_uses++;
+	cc->use_term[u] = t;
+	cc->use_next[u] = -1;
+	if (cc->use_last[cls] < 0) {
+		cc->use_first[cls] = u;
+	} else {
+		cc->use_next[cc->use_last[cls]] = u;
+	}
+	cc->use_last[cls] = u;
+}
+
+/**
+ * @brief Returns the term for a key; terms congruent to an existing one are
+ * not created again.
+ *
+ * @param cc congruence closure
+ * @param key symbol, children and right neighbour of the term
+ *
+ * @return term
+ */
+static int cc_intern(CC* cc, CCTerm* key)
+{
+	int t;
+
+	cc_canon(cc, key);
+	if ((t = cc_lookup(cc, key)) >= 0) {
+		return t;
+	}
+
+	if (cc->n_terms == cc->size) {
+		cc->size *= 2;
+		cc->terms = (CCTerm*) realloc(cc->terms, sizeof(CCTerm) * cc->size);
+		cc->find = (int*) realloc(cc->find, sizeof(int) * cc->size);
+		cc->csize = (int*) realloc(cc->csize, sizeof(int) * cc->size);
+		cc->use_first = (int*) realloc(cc->use_first, sizeof(int) * cc->size);
+		cc->use_last = (int*) realloc(cc->use_last, sizeof(int) * cc->size);
+	}
+
+	t = cc->n_terms++;
+	cc->terms[t] = *key;
+	cc->find[t] = t;
+	cc->csize[t] = 1;
+	cc->use_first[t] = cc->use_last[t] = -1;
+
+	if (key->child >= 0) {
+		cc_add_use(cc, key->child, t);
+	}
+	if (key->right >= 0) {
+		cc_add_use(cc, key->right, t);
+	}
+	cc_insert_sig(cc, key, t);
+
+	return t;
+}
+
+/**
+ * @brief Merges the classes of two terms and all classes, which become
+ * congruent thereby.
+ *
+ * @param cc congruence closure
+ * @param t1 one term
+ * @param t2 another term
+ */
+static void cc_merge(CC* cc, int t1, int t2)
+{
+	int* pending;
+	int n_pending;
+	int size_pending;
+	int r1, r2, tmp;
+	int u, v;
+	CCTerm key;
+
+	size_pending = 16;
+	pending = (int*) malloc(sizeof(int) * size_pending);
+	pending[0] = t1;
+	pending[1] = t2;
+	n_pending = 2;
+
+	while (n_pending > 0) {
+		r2 = cc_find(cc, pending[--n_pending]);
+		r1 = cc_find(cc, pending[--n_pending]);
+		if (r1 == r2) {
+			continue;
+		}
+
+		/* the smaller class is merged into the larger one */
+		if (cc->csize[r1] > cc->csize[r2]) {
+			tmp = r1;
+			r1 = r2;
+			r2 = tmp;
+		}
+		cc->find[r1] = r2;
+		cc->csize[r2] += cc->csize[r1];
+
+		/* terms using the merged class get a new signature, which may
+		 * coincide with the signature of another term */
+		for (u = cc->use_first[r1]; u >= 0; u = cc->use_next[u]) {
+			key = cc->terms[cc->use_term[u]];
+			cc_canon(cc, &key);
+			if ((v = cc_lookup(cc, &key)) < 0) {
+				cc_insert_sig(cc, &key, cc->use_term[u]);
+			} else if (cc_find(cc, v) != cc_find(cc, cc->use_term[u])) {
+				if (n_pending + 2 > size_pending) {
+					size_pending *= 2;
+					pending = (int*) realloc(pending,
+							sizeof(int) * size_pending);
+				}
+				pending[n_pending++] = v;
+				pending[n_pending++] = cc->use_term[u];
+			}
+		}
+
+		if (cc->use_first[r1] >= 0) {
+			if (cc->use_last[r2] < 0) {
+				cc->use_first[r2] = cc->use_first[r1];
+			} else {
+				cc->use_next[cc->use_last[r2]] = cc->use_first[r1];
+			}
+			cc->use_last[r2] = cc->use_last[r1];
+		}
+	}
+
+	free(pending);
+}
+
+/* --- terms ---------------------------------------------------------------- */
+/**
+ * @brief Returns the term of a Pnode and its right neighbours.
+ */
+static int cc_term(CC* cc, Pnode* pnode)
+{
+	CCTerm key;
+
+	if (IS_ID(pnode)) {
+		key.sym = *(pnode->symbol);
+		key.child = key.right = -1;
+		key.kind = CC_ID;
+	} else {
+		key.sym = HAS_SYMBOL(pnode) ? *(pnode->symbol) : NULL;
+		key.child = HAS_CHILD(pnode) ? cc_term(cc, *(pnode->child)) : -1;
+		key.right = HAS_RIGHT(pnode) ? cc_term(cc, *(pnode->right)) : -1;
+		key.kind = CC_NODE;
+	}
+
+	return cc_intern(cc, &key);
+}
+
+/**
+ * @brief Returns the term of the content of a statement.
+ */
+static int cc_content(CC* cc, Pnode* pnode)
+{
+	CCTerm key;
+
+	if (HAS_CHILD(pnode)) {
+		return cc_term(cc, *(pnode->child));
+	}
+
+	key.sym = NULL;
+	key.child = key.right = -1;
+	key.kind = CC_EMPTY;
+	return cc_intern(cc, &key);
+}
+
+/**
+ * @brief Merges all sides of an equality.
+ *
+ * @param cc congruence closure
+ * @param peq statement holding the equality
+ */
+static void cc_assert(CC* cc, Pnode* peq)
+{
+	Pnode* pside;
+	int first;
+	int t;
+
+	DBG_EQUAL(fprintf(stderr, SHELL_CYAN "<=%d>" SHELL_RESET1, peq->num_c););
+
+	first = -1;
+	for (pside = *(peq->child); pside != NULL;
+			pside = HAS_RIGHT(pside) ? *(pside->right) : NULL) {
+		if (HAS_SYMBOL(pside)) { /* skip "=" */
+			continue;
+		}
+
+		t = cc_content(cc, pside);
+		if (cc->n_sides == cc->size_sides) {
+			cc->size_sides *= 2;
+			cc->sides = (int*) realloc(cc->sides,
+					sizeof(int) * cc->size_sides);
+		}
+		cc->sides[cc->n_sides++] = t;
+
+		if (first < 0) {
+			first = t;
+		} else {
+			cc_merge(cc, first, t);
+		}
+	}
+}
+
+/* --- closures ------------------------------------------------------------- */
+/**
+ * @brief Creates the congruence closure of all equalities in a prev_eq chain.
+ *
+ * @param head last equality in the chain
+ * @param fp fingerprint of the content of the equalities
+ *
+ * @return new congruence closure
+ */
+static CC* new_cc(Pnode* head, uint64_t fp)
+{
+	CC* cc;
+	Pnode* peq;
+	int i;
+
+	cc = (CC*) malloc(sizeof(CC));
+	cc->head = head;
+	cc->fp = fp;
+
+	cc->size = 64;
+	cc->n_terms = 0;
+	cc->terms = (CCTerm*) malloc(sizeof(CCTerm) * cc->size);
+	cc->find = (int*) malloc(sizeof(int) * cc->size);
+	cc->csize = (int*) malloc(sizeof(int) * cc->size);
+	cc->use_first = (int*) malloc(sizeof(int) * cc->size);
+	cc->use_last = (int*) malloc(sizeof(int) * cc->size);
+
+	cc->size_uses = 128;
+	cc->n_uses = 0;
+	cc->use_term = (int*) malloc(sizeof(int) * cc->size_uses);
+	cc->use_next = (int*) malloc(sizeof(int) * cc->size_uses);
+
+	cc->size_sigs = 128;
+	cc->n_sigs = 0;
+	cc->sigs = (CCSig*) malloc(sizeof(CCSig) * cc->size_sigs);
+	for (i = 0; i < cc->size_sigs; i++) {
+		cc->sigs[i].term = -1;
+	}
+
+	cc->size_sides = 8;
+	cc->n_sides = 0;
+	cc->sides = (int*) malloc(sizeof(int) * cc->size_sides);
+
+	for (i = 0; i < CC_MEMO; i++) {
+		cc->memo_node[i] = NULL;
+	}
+
+	for (peq = head; peq != NULL; peq = peq->prev_eq) {
+		cc_assert(cc, peq);
+	}
+
+	return cc;
+}
+
+static void free_cc(CC* cc)
+{
+	free(cc->terms);
+	free(cc->find);
+	free(cc->csize);
+	free(cc->use_first);
+	free(cc->use_last);
+	free(cc->use_term);
+	free(cc->use_next);
+	free(cc->sigs);
+	free(cc->sides);
+	free(cc);
+}
+
+/**
+ * @brief Returns the congruence closure of all equalities visible from a
+ * perspective.
+ *
+ * @param perspective Pnode from whose perspective verification is done
+ *
+ * @return congruence closure or NULL, if no equalities are visible
+ */
+CC* cc_context(Pnode* perspective)
+{
+	Pnode* head;
+	Pnode* peq;
+	CC* cc;
+	uint64_t fp;
+	unsigned int slot;
+	unsigned int bucket;
+
+	if (perspective == NULL || perspective->prev_eq == NULL) {
+		return NULL;
+	}
+	head = perspective->prev_eq;
+
+	/* the content of the equalities only changes with the substitutions */
+	slot = (unsigned int) (mix_fp(NODE_FP(head), bind_fp)
+			& (CC_CTX_SLOTS - 1));
+	if (ctx_head[slot] == head && ctx_bind[slot] == bind_fp) {
+		return ctx_cc[slot];
+	}
+
+	fp = 0;
+	for (peq = head; peq != NULL; peq = peq->prev_eq) {
+		fp = mix_fp(fp, cc_fp(*(peq->child)));
+	}
+
+	bucket = (unsigned int) (mix_fp(NODE_FP(head), fp) % CC_BUCKETS);
+	for (cc = closures[bucket]; cc != NULL; cc = cc->next) {
+		if (cc->head == head && cc->fp == fp) {
+			break;
+		}
+	}
+	if (cc == NULL) {
+		cc = new_cc(head, fp);
+		cc->next = closures[bucket];
+		closures[bucket] = cc;
+	}
+
+	ctx_head[slot] = head;
+	ctx_bind[slot] = bind_fp;
+	ctx_cc[slot] = cc;
+
+	return cc;
+}
+
+/**
+ * @brief Frees all congruence closures (which are only valid while the same
+ * statement is being verified).
+ */
+void clear_cc()
+{
+	CC* cc;
+	int i;
+
+	for (i = 0; i < CC_BUCKETS; i++) {
+		while (closures[i] != NULL) {
+			cc = closures[i];
+			closures[i] = cc->next;
+			free_cc(cc);
+		}
+	}
+	for (i = 0; i < CC_CTX_SLOTS; i++) {
+		ctx_head[i] = NULL;
+	}
+}
+
+/* --- comparison ----------------------------------------------------------- */
+/**
+ * @brief Returns the equivalence class of the content of a statement.
+ *
+ * @param cc congruence closure
+ * @param pnode statement
+ *
+ * @return representative of the class
+ */
+int cc_class(CC* cc, Pnode* pnode)
+{
+	unsigned int slot;
+
+	/* the content of a closed statement only changes with the substitutions */
+	if (!HAS_NFLAG_CLSD(pnode)) {
+		return cc_find(cc, cc_content(cc, pnode));
+	}
+
+	slot = (unsigned int) (mix_fp(NODE_FP(pnode), bind_fp)
+			& (CC_MEMO - 1));
+	if (cc->memo_node[slot] != pnode || cc->memo_bind[slot] != bind_fp) {
+		cc->memo_node[slot] = pnode;
+		cc->memo_bind[slot] = bind_fp;
+		cc->memo_term[slot] = cc_content(cc, pnode);
+	}
+
+	return cc_find(cc, cc->memo_term[slot]);
+}
+
+/**
+ * @brief Checks, whether a class contains a side of a visible equality.
+ *
+ * @param cc congruence closure
+ * @param cls representative of the class
+ *
+ * @return TRUE, if the class contains a side of an equality
+ */
+unsigned short int cc_is_side(CC* cc, int cls)
+{
+	int i;
+
+	for (i = 0; i < cc->n_sides; i++) {
+		if (cc_find(cc, cc->sides[i]) == cls) {
+			return TRUE;
+		}
+	}
+	return FALSE;
+}
+
+/**
+ * @brief Checks, whether all sides of an equality are congruent, i.e. whether
+ * the equality follows from the visible equalities.
+ *
+ * @param cc congruence closure
+ * @param peq statement holding the equality
+ *
+ * @return TRUE, if all sides are in the same class
+ */
+unsigned short int cc_sides_equal(CC* cc, Pnode* peq)
+{
+	Pnode* pside;
+	int cls;
+
+	cls = -1;
+	for (pside = *(peq->child); pside != NULL;
+			pside = HAS_RIGHT(pside) ? *(pside->right) : NULL) {
+		if (HAS_SYMBOL(pside)) { /* skip "=" */
+			continue;
+		}
+		if (cls < 0) {
+			cls = cc_class(cc, pside);
+		} else if (cc_class(cc, pside) != cls) {
+			return FALSE;
+		}
+	}
+	return TRUE;
+}
+
+/**
+ * @brief Compares two statements modulo the visible equalities.
+ *
+ * @param cc congruence closure (may be NULL)
+ * @param p1 one statement
+ * @param p2 another statement
+ *
+ * @return TRUE, if the contents of the statements are congruent
+ */
+unsigned short int cc_equal(CC* cc, Pnode* p1, Pnode* p2)
+{
+	if (cc == NULL) {
+		return FALSE;
+	}
+	return (cc_class(cc, p1) == cc_class(cc, p2));
+}
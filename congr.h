@@ -0,0 +1,97 @@
+/* [prove]: A proof verification system using bracketed expressions.
+ * Copyright (C) 2021  Gregor Feierabend
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef CONGR_H
+#define CONGR_H
+
+#include <stdint.h>
+#include "pgraph.h"
+
+/* number of hash buckets for congruence closures */
+#define CC_BUCKETS 64
+/* number of slots in the class cache of a single congruence closure (power of
+ * two) */
+#define CC_MEMO 1024
+
+/* A term represents a Pnode together with its right neighbours, exactly as
+ * it is compared by const_equal. Terms are hash-consed, i.e. two terms with
+ * the same symbol, whose children and right neighbours are in the same
+ * equivalence classes, are the same term. */
+typedef struct cc_term {
+	char* sym;	/* symbol (NULL for internal Pnodes) */
+	int child;	/* term of the child (-1 if none) */
+	int right;	/* term of the right neighbour (-1 if none) */
+	int kind;	/* CC_NODE, CC_ID or CC_EMPTY */
+} CCTerm;
+
+typedef enum {
+	CC_NODE = 0,
+	CC_ID = 1,		/* identifier (compared by its symbol only) */
+	CC_EMPTY = 2,	/* content of an empty statement */
+} CCKind;
+
+/* signature of a term with respect to the current equivalence classes */
+typedef struct cc_sig {
+	CCTerm key;
+	int term;	/* -1 if the slot is free */
+} CCSig;
+
+/* congruence closure over the equalities visible from a certain perspective */
+typedef struct congruence {
+	Pnode* head;		/* last equality visible from the perspective */
+	uint64_t fp;		/* fingerprint of the content of all visible
+						   equalities */
+
+	CCTerm* terms;
+	int* find;			/* union-find forest over the terms */
+	int* csize;			/* size of the class (valid for representatives) */
+	int* use_first;		/* terms using a class as child or right neighbour */
+	int* use_last;
+	int n_terms;
+	int size;
+
+	int* use_term;		/* linked list entries of the use lists */
+	int* use_next;
+	int n_uses;
+	int size_uses;
+
+	CCSig* sigs;		/* open addressing table of signatures */
+	int n_sigs;
+	int size_sigs;
+
+	int* sides;			/* terms of the sides of the visible equalities */
+	int n_sides;
+	int size_sides;
+
+	Pnode* memo_node[CC_MEMO];	/* class cache for statements */
+	uint64_t memo_bind[CC_MEMO];
+	int memo_term[CC_MEMO];
+
+	struct congruence* next;
+} CC;
+
+uint64_t cc_fp(Pnode* pnode);
+
+CC* cc_context(Pnode* perspective);
+void clear_cc();
+
+int cc_class(CC* cc, Pnode* pnode);
+unsigned short int cc_is_side(CC* cc, int cls);
+unsigned short int cc_sides_equal(CC* cc, Pnode* peq);
+unsigned short int cc_equal(CC* cc, Pnode* p1, Pnode* p2);
+
+#endif /* CONGR_H */
@@ -21,6 +21,8 @@
 #define DTIKZ
 #include "tikz.h"
 
+#include "strategy.h"
+
 #define MD
 #define DEBUG
 #include "error.h"
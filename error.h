@@ -37,6 +37,47 @@
 #define HELP \
 		"\n" MDS "GENERAL options:" MDS "\n\n" MDN\
 	MDC "--help" MDC "\tdisplay this message\n" MDN\
+	MDC "--strategies=<list>" MDC "\n\t\tcomma-separated verification "\
+		"strategies in the order they are tried, each optionally followed by "\
+		MDC ":<budget>" MDC "\n\t\t(available: facts, idonly, full, forward, "\
+		"cases; default: " MDC ST_DEFAULT MDC ")\n" MDN\
+	MDC "--budget=<list>" MDC "\n\t\tcomma-separated limits of the effort "\
+		"spent on every list, each of the form " MDC "<resource>:<limit>" MDC\
+		"; lists exceeding a limit are reported as unknown\n\t\t(resources: "\
+		"comparisons, substitutions, time in ms, memory in bytes; default: "\
+		"unlimited)\n" MDN\
+	MDC "--stats" MDC "  \tprint statistics of the verification "\
+		"strategies and performance counters of every verified "\
+		"statement\n" MDN\
+	MDC "--profile=json" MDC "\n\t\tprint one JSON record per verified statement "\
+		"(position, strategy, time and counters) to stdout\n" MDN\
+	MDC "--hwcounters" MDC "\tprint hardware performance counters of parsing "\
+		"and verification (if available)\n" MDN\
+	MDC "--cert=<file>" MDC "\twrite a certificate of the justifications of "\
+		"every verified statement to a file\n" MDN\
+	MDC "--replay=<file>" MDC "\tverify by checking the justifications of a "\
+		"certificate instead of searching\n" MDN\
+	MDC "--serve[=<socket>]" MDC "\tverify files sent as line-delimited JSON "\
+		"on stdin (or a Unix socket) incrementally, keeping outcomes in "\
+		"memory\n" MDN\
+	MDC "--cache=<dir>" MDC "\tstore the outcome of every list in a directory "\
+		"and check stored outcomes of unchanged lists instead of "\
+		"searching\n" MDN\
+	MDC "--compile=<image>" MDC "\twrite the graph of a verified file to a "\
+		"precompiled image (to be used as library)\n" MDN\
+	MDC "--library=<image>" MDC "\tload a precompiled image and continue "\
+		"parsing the file after its last statement\n" MDN\
+	MDC "--jobs[=<n>]" MDC "\tverify the statements at the top level in n "\
+		"worker processes (default: number of processors)\n" MDN\
+	MDC "--pipeline[=<n>]" MDC "\tverify the statements at the top level in "\
+		"child processes, while parsing continues (at most n at a time, "\
+		"default: number of processors)\n" MDN\
+	MDC "--coordinate=<address>" MDC "\n\t\tdistribute the given files among "\
+		"the workers connecting to a Unix socket or <host>:<port>\n" MDN\
+	MDC "--shards=<n>" MDC "\tsplit every file into n shards of statements at "\
+		"the top level (with " MDC "--coordinate" MDC ", default: 1)\n" MDN\
+	MDC "--worker=<address>" MDC "\tverify the shards sent by a "\
+		"coordinator\n" MDN\
 		"\n" MDS "DEBUGGING options:" MDS "\n\n" MDN\
 	MDC "--noveri" MDC "  \tdo not perform any verification "\
 				"(useful, when creating TIKZ graphs)\n" MDN\
@@ -53,6 +94,13 @@
 		"success\n" MDN\
 	MDC "--dfinish" MDC "  \tfinish execution, even if verification "\
 		"fails\n" MDN\
+	MDC "--nonogoods" MDC "\tdo not remember sub-goals, which have failed "\
+		"(to compare the search without them)\n" MDN\
+	MDC "--notraces" MDC "\tdo not replay the movements of explorers, which "\
+		"have been recorded (to compare the search without them)\n" MDN\
+	MDC "--dsteps=<n>" MDC "\tsuspend and resume every search after n "\
+		"units, and abort it once and start it again (to compare the "\
+		"uninterrupted search)\n" MDN\
 	MDC "--dall" MDC "     \tactivate all debugging options\n" MDN
 
 #else
@@ -63,9 +111,51 @@
 #define HELP \
 	"\nGENERAL options:\n\n"\
 	"--help\tdisplay this message\n"\
+	"--strategies=<list>\n\t\tcomma-separated verification strategies in "\
+		"the order they are tried, each optionally followed by :<budget>\n"\
+		"\t\t(available: facts, idonly, full, forward, cases; default: "\
+		ST_DEFAULT ")\n"\
+	"--budget=<list>\n\t\tcomma-separated limits of the effort spent on "\
+		"every list, each of the form <resource>:<limit>; lists exceeding a "\
+		"limit are reported as unknown\n\t\t(resources: comparisons, "\
+		"substitutions, time in ms, memory in bytes; default: unlimited)\n"\
+	"--stats  \tprint statistics of the verification strategies and "\
+		"performance counters of every verified statement\n"\
+	"--profile=json\n\t\tprint one JSON record per verified statement "\
+		"(position, strategy, time and counters) to stdout\n"\
+	"--hwcounters\tprint hardware performance counters of parsing and "\
+		"verification (if available)\n"\
+	"--cert=<file>\twrite a certificate of the justifications of every "\
+		"verified statement to a file\n"\
+	"--replay=<file>\tverify by checking the justifications of a "\
+		"certificate instead of searching\n"\
+	"--serve[=<socket>]\tverify files sent as line-delimited JSON on stdin "\
+		"(or a Unix socket) incrementally, keeping outcomes in memory\n"\
+	"--cache=<dir>\tstore the outcome of every list in a directory and "\
+		"check stored outcomes of unchanged lists instead of searching\n"\
+	"--compile=<image>\twrite the graph of a verified file to a "\
+		"precompiled image (to be used as library)\n"\
+	"--library=<image>\tload a precompiled image and continue parsing the "\
+		"file after its last statement\n"\
+	"--jobs[=<n>]\tverify the statements at the top level in n worker "\
+		"processes (default: number of processors)\n"\
+	"--pipeline[=<n>]\tverify the statements at the top level in child "\
+		"processes, while parsing continues (at most n at a time, default: "\
+		"number of processors)\n"\
+	"--coordinate=<address>\n\t\tdistribute the given files among the "\
+		"workers connecting to a Unix socket or <host>:<port>\n"\
+	"--shards=<n>\tsplit every file into n shards of statements at the top "\
+		"level (with --coordinate, default: 1)\n"\
+	"--worker=<address>\tverify the shards sent by a coordinator\n"\
 	"\nDEBUGGING options:\n\n"\
 	"--dcomplete\tdo not break verification loop after first success\n"\
 	"--dfinish  \tfinish execution, even if verification fails\n"\
+	"--nonogoods\tdo not remember sub-goals, which have failed (to compare "\
+		"the search without them)\n"\
+	"--notraces\tdo not replay the movements of explorers, which have been "\
+		"recorded (to compare the search without them)\n"\
+	"--dsteps=<n>\tsuspend and resume every search after n units, and abort "\
+		"it once and start it again (to compare the uninterrupted search)\n"\
 	"\nFor more debugging options, compile with full debugging support.\n"
 
 #endif
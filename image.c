@@ -0,0 +1,660 @@
+/* [prove]: A proof verification system using bracketed expressions.
+ * Copyright (C) 2021  Gregor Feierabend
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "image.h"
+#include "parser.h"
+#include "pscanner.h"
+
+/* --- preprocessor directives ---------------------------------------------- */
+#define TRUE 1
+#define FALSE 0
+
+/* initial number of slots of the table of visited objects (power of two) */
+#define IMG_SLOTS 1024
+
+/* alignment of the sections of an image */
+#define IMG_ALIGN(n) (((n) + 7) & ~((uint64_t) 7))
+
+/* parameters of the FNV-1a hash of the image (see img_hash) */
+#define FNV_OFFSET 0xcbf29ce484222325ULL
+#define FNV_PRIME 0x100000001b3ULL
+
+/* number of words read at once, when computing the checksum of a written
+ * image */
+#define IMG_BUF 4096
+
+/* all flags, which can be set in a Pnode and in a VTree respectively */
+#define IMG_NFLAGS ((NFLAG_CLSD << 1) - 1)
+#define IMG_VARFLAGS ((VARFLAG_FRST << 1) - 1)
+
+/* Is the Pnode q (if any) numbered before the Pnode p? */
+#define IMG_BEFORE(q, p) ((q) == NULL || (q)->num < (p)->num)
+
+/* kinds of objects in an image (i.e. sections) */
+typedef enum {
+	IMG_PNODE = 0,
+	IMG_VTREE = 1,
+	IMG_PCELL = 2,	/* Pnode* */
+	IMG_SCELL = 3,	/* char* */
+	IMG_STRING = 4,
+	IMG_KINDS = 5,
+} ImgKind;
+
+/* visited object */
+typedef struct img_object {
+	void* ptr;		/* NULL, if the slot is free */
+	ImgKind kind;
+	uint64_t rel;	/* offset within its section */
+} ImgObject;
+
+/* --- global variables ----------------------------------------------------- */
+
+/* table of visited objects */
+static ImgObject* objects = NULL;
+static uint64_t n_objects = 0;
+static uint64_t size_objects = 0;
+
+/* objects of every kind in the order of their offsets */
+static void** order[IMG_KINDS];
+static uint64_t n_order[IMG_KINDS];
+static uint64_t size_order[IMG_KINDS];
+static uint64_t len_strings;
+
+/* beginning of the sections in the image */
+static uint64_t section[IMG_KINDS];
+
+/* loaded image */
+static char* image = NULL;
+static uint64_t image_size = 0;
+static unsigned short int image_bad;
+
+/* --- checksum ------------------------------------------------------------- */
+/**
+ * @brief Continues the FNV-1a hash of an image with some of its words (every
+ * step is a bijection of the hash, hence any single changed word is detected).
+ *
+ * @param hash hash of the preceding words
+ * @param words words to be hashed
+ * @param n number of words
+ *
+ * @return hash including the words
+ */
+static uint64_t img_hash(uint64_t hash, uint64_t* words, uint64_t n)
+{
+	uint64_t i;
+
+	for (i = 0; i < n; i++) {
+		hash = (hash ^ words[i]) * FNV_PRIME;
+	}
+	return hash;
+}
+
+/* --- writing -------------------------------------------------------------- */
+/**
+ * @brief Finds the slot of an object in the table of visited objects.
+ */
+static uint64_t obj_slot(void* ptr)
+{
+	uint64_t i;
+
+	i = (((uintptr_t) ptr) >> 3) * 0x9e3779b97f4a7c15ULL;
+	i = (i >> 17) & (size_objects - 1);
+	while (objects[i].ptr != NULL && objects[i].ptr != ptr) {
+		i = (i + 1) & (size_objects - 1);
+	}
+	return i;
+}
+
+/**
+ * @brief Marks an object as visited and assigns its offset within its section.
+ *
+ * @param ptr object (may be NULL)
+ * @param kind kind of the object
+ *
+ * @return TRUE, if the object has not been visited before
+ */
+static unsigned short int visit(void* ptr, ImgKind kind)
+{
+	ImgObject* old;
+	uint64_t old_size;
+	uint64_t i;
+
+	if (ptr == NULL) {
+		return FALSE;
+	}
+
+	if (2 * (n_objects + 1) > size_objects) {
+		old = objects;
+		old_size = size_objects;
+		size_objects = size_objects == 0 ? IMG_SLOTS : 2 * size_objects;
+		objects = (ImgObject*) calloc(size_objects, sizeof(ImgObject));
+		for (i = 0; i < old_size; i++) {
+			if (old[i].ptr != NULL) {
+				objects[obj_slot(old[i].ptr)] = old[i];
+			}
+		}
+		free(old);
+	}
+
+	i = obj_slot(ptr);
+	if (objects[i].ptr != NULL) {
+		return FALSE;
+	}
+	n_objects++;
+	objects[i].ptr = ptr;
+	objects[i].kind = kind;
+
+	if (n_order[kind] == size_order[kind]) {
+		size_order[kind] = size_order[kind] == 0 ? IMG_SLOTS
+			: 2 * size_order[kind];
+		order[kind] = (void**) realloc(order[kind],
+				sizeof(void*) * size_order[kind]);
+	}
+	order[kind][n_order[kind]] = ptr;
+
+	switch (kind) {
+		case IMG_PNODE:
+			objects[i].rel = n_order[kind] * sizeof(Pnode);
+			break;
+		case IMG_VTREE:
+			objects[i].rel = n_order[kind] * sizeof(VTree);
+			break;
+		case IMG_STRING:
+			objects[i].rel = len_strings;
+			len_strings += IMG_ALIGN(strlen((char*) ptr) + 1);
+			break;
+		default:
+			objects[i].rel = n_order[kind] * sizeof(void*);
+	}
+	n_order[kind]++;
+
+	return TRUE;
+}
+
+/**
+ * @brief Visits all objects reachable from a Pnode (the objects to be visited
+ * next are taken from the order of their kind, hence no recursion is needed).
+ *
+ * @param last Pnode to start with
+ */
+static void visit_all(Pnode* last)
+{
+	uint64_t done[IMG_KINDS];
+	unsigned short int progress;
+	Pnode* p;
+	VTree* v;
+	int k;
+
+	memset(done, 0, sizeof(done));
+	visit(last, IMG_PNODE);
+
+	do {
+		progress = FALSE;
+		for (k = 0; k < IMG_KINDS; k++) {
+			while (done[k] < n_order[k]) {
+				progress = TRUE;
+				switch (k) {
+					case IMG_PNODE:
+						p = (Pnode*) order[k][done[k]];
+						visit(p->parent, IMG_PNODE);
+						visit(p->left, IMG_PNODE);
+						visit(p->prev_const, IMG_PNODE);
+						visit(p->prev_id, IMG_PNODE);
+						visit(p->prev_eq, IMG_PNODE);
+						visit(p->child, IMG_PCELL);
+						visit(p->right, IMG_PCELL);
+						visit(p->symbol, IMG_SCELL);
+						visit(p->vtree, IMG_VTREE);
+						break;
+					case IMG_VTREE:
+						v = (VTree*) order[k][done[k]];
+						visit(v->pnode, IMG_PNODE);
+						visit(v->left, IMG_VTREE);
+						visit(v->right, IMG_VTREE);
+						visit(v->parent, IMG_VTREE);
+						break;
+					case IMG_PCELL:
+						visit(*((Pnode**) order[k][done[k]]), IMG_PNODE);
+						break;
+					case IMG_SCELL:
+						visit(*((char**) order[k][done[k]]), IMG_STRING);
+						break;
+				}
+				done[k]++;
+			}
+		}
+	} while (progress);
+}
+
+/**
+ * @brief Encodes a pointer as offset within the image.
+ */
+static void* enc(void* ptr)
+{
+	ImgObject* o;
+
+	if (ptr == NULL) {
+		return NULL;
+	}
+	o = &(objects[obj_slot(ptr)]);
+	return (void*) (uintptr_t) (section[o->kind] + o->rel);
+}
+
+/**
+ * @brief Writes a graph of Pnodes (after it has been parsed and verified) to
+ * an image, which can be loaded as prefix of another file (see image_load).
+ *
+ * @param filename name of the image file
+ * @param last last Pnode at the top level
+ *
+ * @return FALSE, if the file cannot be written
+ */
+unsigned short int image_write(char* filename, Pnode* last)
+{
+	FILE* file;
+	ImageHeader h;
+	Pnode p;
+	VTree v;
+	char* s;
+	char pad[8];
+	uint64_t buf[IMG_BUF];
+	uint64_t checksum;
+	uint64_t i;
+	size_t n;
+	int k;
+
+	visit_all(last);
+
+	memset(&h, 0, sizeof(ImageHeader));
+	memcpy(h.magic, IMAGE_MAGIC, sizeof(h.magic));
+	h.version = IMAGE_VERSION;
+	h.ptr_size = sizeof(void*);
+	h.pnode_size = sizeof(Pnode);
+	h.vtree_size = sizeof(VTree);
+
+	h.off_pnodes = IMG_ALIGN(sizeof(ImageHeader));
+	h.n_pnodes = n_order[IMG_PNODE];
+	h.off_vtrees = IMG_ALIGN(h.off_pnodes + h.n_pnodes * sizeof(Pnode));
+	h.n_vtrees = n_order[IMG_VTREE];
+	h.off_pcells = IMG_ALIGN(h.off_vtrees + h.n_vtrees * sizeof(VTree));
+	h.n_pcells = n_order[IMG_PCELL];
+	h.off_scells = h.off_pcells + h.n_pcells * sizeof(void*);
+	h.n_scells = n_order[IMG_SCELL];
+	h.off_strings = h.off_scells + h.n_scells * sizeof(void*);
+	h.len_strings = len_strings;
+	h.size = h.off_strings + h.len_strings;
+
+	section[IMG_PNODE] = h.off_pnodes;
+	section[IMG_VTREE] = h.off_vtrees;
+	section[IMG_PCELL] = h.off_pcells;
+	section[IMG_SCELL] = h.off_scells;
+	section[IMG_STRING] = h.off_strings;
+
+	h.last = (uint64_t) (uintptr_t) enc(last);
+	h.node_count = get_node_count();
+	h.fp = scan_fp;
+
+	if ((file = fopen(filename, "w+b")) == NULL) {
+		return FALSE;
+	}
+	memset(pad, 0, sizeof(pad));
+
+	fwrite(&h, sizeof(ImageHeader), 1, file);
+	fwrite(pad, 1, h.off_pnodes - sizeof(ImageHeader), file);
+
+	for (i = 0; i < h.n_pnodes; i++) {
+		p = *((Pnode*) order[IMG_PNODE][i]);
+		p.parent = enc(p.parent);
+		p.left = enc(p.left);
+		p.prev_const = enc(p.prev_const);
+		p.prev_id = enc(p.prev_id);
+		p.prev_eq = enc(p.prev_eq);
+		p.child = enc(p.child);
+		p.right = enc(p.right);
+		p.symbol = enc(p.symbol);
+		p.vtree = enc(p.vtree);
+		fwrite(&p, sizeof(Pnode), 1, file);
+	}
+	fwrite(pad, 1, h.off_vtrees - (h.off_pnodes + h.n_pnodes * sizeof(Pnode)),
+			file);
+
+	for (i = 0; i < h.n_vtrees; i++) {
+		v = *((VTree*) order[IMG_VTREE][i]);
+		v.pnode = enc(v.pnode);
+		v.left = enc(v.left);
+		v.right = enc(v.right);
+		v.parent = enc(v.parent);
+		fwrite(&v, sizeof(VTree), 1, file);
+	}
+	fwrite(pad, 1, h.off_pcells - (h.off_vtrees + h.n_vtrees * sizeof(VTree)),
+			file);
+
+	for (i = 0; i < h.n_pcells; i++) {
+		s = enc(*((Pnode**) order[IMG_PCELL][i]));
+		fwrite(&s, sizeof(void*), 1, file);
+	}
+	for (i = 0; i < h.n_scells; i++) {
+		s = enc(*((char**) order[IMG_SCELL][i]));
+		fwrite(&s, sizeof(void*), 1, file);
+	}
+	for (i = 0; i < n_order[IMG_STRING]; i++) {
+		s = (char*) order[IMG_STRING][i];
+		fwrite(s, 1, strlen(s) + 1, file);
+		fwrite(pad, 1, IMG_ALIGN(strlen(s) + 1) - (strlen(s) + 1), file);
+	}
+
+	/* the checksum is computed over the written image (the size of which is a
+	 * multiple of 8, as all sections are aligned) and replaces the 0 in its
+	 * header */
+	checksum = FNV_OFFSET;
+	fflush(file);
+	rewind(file);
+	while ((n = fread(buf, sizeof(uint64_t), IMG_BUF, file)) > 0) {
+		checksum = img_hash(checksum, buf, n);
+	}
+	fseek(file, offsetof(ImageHeader, checksum), SEEK_SET);
+	fwrite(&checksum, sizeof(uint64_t), 1, file);
+
+	free(objects);
+	objects = NULL;
+	n_objects = size_objects = 0;
+	for (k = 0; k < IMG_KINDS; k++) {
+		free(order[k]);
+		order[k] = NULL;
+		n_order[k] = size_order[k] = 0;
+	}
+	len_strings = 0;
+
+	return (fclose(file) == 0);
+}
+
+/* --- loading -------------------------------------------------------------- */
+/**
+ * @brief Turns an offset within the image into a pointer.
+ *
+ * @param off offset (0 for NULL)
+ * @param lo beginning of the section, the offset has to refer to
+ * @param hi end of the section
+ * @param elem size of the elements of the section (the offset has to refer
+ * to the beginning of an element)
+ *
+ * @return pointer (NULL, if the offset is invalid)
+ */
+static void* reloc(void* off, uint64_t lo, uint64_t hi, uint64_t elem)
+{
+	uint64_t o;
+
+	o = (uint64_t) (uintptr_t) off;
+	if (o == 0) {
+		return NULL;
+	}
+	if (o < lo || o >= hi || (o - lo) % elem != 0) {
+		image_bad = TRUE;
+		return NULL;
+	}
+	return image + o;
+}
+
+/**
+ * @brief Checks the fields of the relocated graph, which the search relies on
+ * without checking them: the flags have to be known ones (and new constants
+ * have to contain an id), the symbols have to fit into MAX_ID_LENGTH and the
+ * Pnodes have to be numbered like in a parsed graph (links to the parent, to
+ * the left and to previous constants lead to lower numbers, links to the
+ * child and to the right to higher ones), such that every walk through the
+ * Pnodes terminates. Every VTree has to be the subtree of at most one other
+ * VTree and must not be its own ancestor.
+ *
+ * @param h header of the image
+ *
+ * @return FALSE, if the graph cannot have been written by image_write
+ */
+static unsigned short int check_graph(ImageHeader* h)
+{
+	Pnode* pnodes;
+	VTree* vtrees;
+	Pnode* p;
+	VTree* v;
+	uint64_t* up;
+	uint64_t* seen;
+	uint64_t i;
+	uint64_t j;
+	unsigned short int valid;
+
+	pnodes = (Pnode*) (image + h->off_pnodes);
+	for (i = 0; i < h->n_pnodes; i++) {
+		p = pnodes + i;
+		if ((p->flags & ~IMG_NFLAGS) != 0 || p->num != p->num_c
+				|| p->num < 0 || p->num >= h->node_count
+				|| !IMG_BEFORE(p->parent, p) || !IMG_BEFORE(p->left, p)
+				|| !IMG_BEFORE(p->prev_const, p) || !IMG_BEFORE(p->prev_id, p)
+				|| !IMG_BEFORE(p->prev_eq, p)
+				|| (HAS_CHILD(p) && ((*(p->child))->num <= p->num
+						|| (*(p->child))->parent != p
+						|| (*(p->child))->left != NULL))
+				|| (HAS_RIGHT(p) && ((*(p->right))->num <= p->num
+						|| (*(p->right))->left != p))
+				|| (HAS_NFLAG_NEWC(p) && (!HAS_CHILD(p)
+						|| !HAS_SYMBOL((*(p->child)))))
+				|| (HAS_SYMBOL(p) && memchr(*(p->symbol), '\0',
+						MAX_ID_LENGTH) == NULL)) {
+			return FALSE;
+		}
+	}
+
+	/* up[i] is the VTree (+ 1), of which the i-th VTree is a subtree, seen[i]
+	 * the VTree (+ 1), from which the i-th VTree has been reached first */
+	vtrees = (VTree*) (image + h->off_vtrees);
+	up = (uint64_t*) calloc(h->n_vtrees + 1, sizeof(uint64_t));
+	seen = (uint64_t*) calloc(h->n_vtrees + 1, sizeof(uint64_t));
+	valid = TRUE;
+	for (i = 0; valid && i < h->n_vtrees; i++) {
+		v = vtrees + i;
+		if ((v->flags & ~IMG_VARFLAGS) != 0
+				|| (v->pnode == NULL) == (v->left == NULL)
+				|| (v->pnode != NULL && (!HAS_SYMBOL(v->pnode)
+						|| v->pnode->parent == NULL
+						|| !HAS_NFLAG_NEWC(v->pnode->parent)))
+				|| (v->parent != NULL && v->parent->right != v)
+				|| (v->right != NULL && (v->right->parent != v
+						|| !HAS_VARFLAG_RGHT(v->right->flags)))
+				|| (v->left != NULL && !HAS_VARFLAG_LEFT(v->left->flags))
+				|| (v->left != NULL && up[v->left - vtrees] != 0)
+				|| (v->right != NULL && up[v->right - vtrees] != 0)) {
+			valid = FALSE;
+		} else {
+			if (v->left != NULL) {
+				up[v->left - vtrees] = i + 1;
+			}
+			if (v->right != NULL) {
+				up[v->right - vtrees] = i + 1;
+			}
+		}
+	}
+	/* walking up from every VTree ends at a root or at a VTree, which has
+	 * already been walked up from (hence every VTree is seen once) */
+	for (i = 0; valid && i < h->n_vtrees; i++) {
+		for (j = i + 1; j != 0 && seen[j - 1] == 0; j = up[j - 1]) {
+			seen[j - 1] = i + 1;
+		}
+		if (j != 0 && seen[j - 1] == i + 1) {
+			valid = FALSE;
+		}
+	}
+	free(up);
+	free(seen);
+
+	return valid;
+}
+
+/**
+ * @brief Loads an image as prefix of the file to be parsed: the image is
+ * mapped into memory (copy-on-write, as substitution modifies the graph) and
+ * its offsets are turned into pointers, so that loading costs a single sweep
+ * over its pages instead of parsing and verifying the library again. Before,
+ * its checksum is verified, and the relocated graph is checked (see
+ * check_graph), so that a corrupted image is rejected instead of being
+ * searched.
+ *
+ * @param filename name of the image file
+ *
+ * @return FALSE, if the file is not a valid image for this binary
+ */
+unsigned short int image_load(char* filename)
+{
+	ImageHeader* h;
+	Pnode* p;
+	VTree* v;
+	void** c;
+	uint64_t pn_end;
+	uint64_t vt_end;
+	uint64_t pc_end;
+	uint64_t sc_end;
+	uint64_t checksum;
+	uint64_t i;
+	struct stat st;
+	int fd;
+
+	if ((fd = open(filename, O_RDONLY)) == -1) {
+		fprintf(stderr, "error opening '%s'\n", filename);
+		return FALSE;
+	}
+	if (fstat(fd, &st) == -1 || (uint64_t) st.st_size < sizeof(ImageHeader)
+			|| (image = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE,
+					MAP_PRIVATE, fd, 0)) == MAP_FAILED) {
+		fprintf(stderr, "'%s' is not a valid image\n", filename);
+		image = NULL;
+		close(fd);
+		return FALSE;
+	}
+	close(fd);
+	image_size = st.st_size;
+
+	/* the numbers of elements are bounded first, such that the ends of the
+	 * sections cannot overflow */
+	h = (ImageHeader*) image;
+	if (memcmp(h->magic, IMAGE_MAGIC, sizeof(h->magic)) != 0
+			|| h->version != IMAGE_VERSION || h->ptr_size != sizeof(void*)
+			|| h->pnode_size != sizeof(Pnode)
+			|| h->vtree_size != sizeof(VTree) || h->size != image_size
+			|| image_size % sizeof(uint64_t) != 0
+			|| h->n_pnodes > image_size / sizeof(Pnode)
+			|| h->n_vtrees > image_size / sizeof(VTree)
+			|| h->n_pcells > image_size / sizeof(void*)
+			|| h->n_scells > image_size / sizeof(void*)
+			|| h->off_pnodes > image_size || h->off_vtrees > image_size
+			|| h->off_pcells > image_size || h->off_scells > image_size
+			|| h->off_strings > image_size || h->len_strings > image_size
+			|| h->off_pnodes % sizeof(uint64_t) != 0
+			|| h->off_vtrees % sizeof(uint64_t) != 0
+			|| h->off_pcells % sizeof(uint64_t) != 0
+			|| h->off_scells % sizeof(uint64_t) != 0
+			|| h->off_strings % sizeof(uint64_t) != 0
+			|| h->node_count < 0 || h->node_count > INT_MAX) {
+		fprintf(stderr, "'%s' is not a valid image of version %d for this "
+				"binary\n", filename, IMAGE_VERSION);
+		image_close();
+		return FALSE;
+	}
+
+	pn_end = h->off_pnodes + h->n_pnodes * sizeof(Pnode);
+	vt_end = h->off_vtrees + h->n_vtrees * sizeof(VTree);
+	pc_end = h->off_pcells + h->n_pcells * sizeof(void*);
+	sc_end = h->off_scells + h->n_scells * sizeof(void*);
+	checksum = h->checksum;
+	h->checksum = 0;
+	if (img_hash(FNV_OFFSET, (uint64_t*) image,
+				image_size / sizeof(uint64_t)) != checksum
+			|| h->off_pnodes < sizeof(ImageHeader) || pn_end > h->off_vtrees
+			|| vt_end > h->off_pcells || pc_end > h->off_scells
+			|| sc_end > h->off_strings
+			|| h->off_strings + h->len_strings > image_size
+			|| (h->len_strings > 0 && image[image_size - 1] != '\0')) {
+		fprintf(stderr, "'%s' is not a valid image (corrupted)\n", filename);
+		image_close();
+		return FALSE;
+	}
+
+	/* strings begin at multiples of 8 within their section (see IMG_ALIGN) */
+	image_bad = FALSE;
+	for (i = 0; i < h->n_pnodes; i++) {
+		p = (Pnode*) (image + h->off_pnodes) + i;
+		p->parent = reloc(p->parent, h->off_pnodes, pn_end, sizeof(Pnode));
+		p->left = reloc(p->left, h->off_pnodes, pn_end, sizeof(Pnode));
+		p->prev_const = reloc(p->prev_const, h->off_pnodes, pn_end,
+				sizeof(Pnode));
+		p->prev_id = reloc(p->prev_id, h->off_pnodes, pn_end, sizeof(Pnode));
+		p->prev_eq = reloc(p->prev_eq, h->off_pnodes, pn_end, sizeof(Pnode));
+		p->child = reloc(p->child, h->off_pcells, pc_end, sizeof(void*));
+		p->right = reloc(p->right, h->off_pcells, pc_end, sizeof(void*));
+		p->symbol = reloc(p->symbol, h->off_scells, sc_end, sizeof(void*));
+		p->vtree = reloc(p->vtree, h->off_vtrees, vt_end, sizeof(VTree));
+	}
+	for (i = 0; i < h->n_vtrees; i++) {
+		v = (VTree*) (image + h->off_vtrees) + i;
+		v->pnode = reloc(v->pnode, h->off_pnodes, pn_end, sizeof(Pnode));
+		v->left = reloc(v->left, h->off_vtrees, vt_end, sizeof(VTree));
+		v->right = reloc(v->right, h->off_vtrees, vt_end, sizeof(VTree));
+		v->parent = reloc(v->parent, h->off_vtrees, vt_end, sizeof(VTree));
+	}
+	for (i = 0; i < h->n_pcells; i++) {
+		c = (void**) (image + h->off_pcells) + i;
+		*c = reloc(*c, h->off_pnodes, pn_end, sizeof(Pnode));
+	}
+	for (i = 0; i < h->n_scells; i++) {
+		c = (void**) (image + h->off_scells) + i;
+		*c = reloc(*c, h->off_strings, image_size, sizeof(uint64_t));
+	}
+
+	prefix_last = reloc((void*) (uintptr_t) h->last, h->off_pnodes, pn_end,
+			sizeof(Pnode));
+	if (image_bad || prefix_last == NULL || !check_graph(h)) {
+		fprintf(stderr, "'%s' is not a valid image\n", filename);
+		prefix_last = NULL;
+		image_close();
+		return FALSE;
+	}
+	prefix_fp = h->fp;
+	prefix_count = h->node_count;
+
+	/* the graph must not be freed by free_graph */
+	set_foreign(image, image + image_size);
+	return TRUE;
+}
+
+/**
+ * @brief Unmaps a loaded image (after the graph has been freed).
+ */
+void image_close()
+{
+	if (image != NULL) {
+		munmap(image, image_size);
+		image = NULL;
+		prefix_last = NULL;
+		set_foreign(NULL, NULL);
+	}
+}
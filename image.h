@@ -0,0 +1,63 @@
+/* [prove]: A proof verification system using bracketed expressions.
+ * Copyright (C) 2021  Gregor Feierabend
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef IMAGE_H
+#define IMAGE_H
+
+#include <stdint.h>
+#include "pgraph.h"
+
+/* first bytes of an image (followed by the version of the format) */
+#define IMAGE_MAGIC "prvimage"
+#define IMAGE_VERSION 2
+
+/* Header of a precompiled graph. All pointers in the image are stored as
+ * offsets from the beginning of the image (0 for NULL). The layout of the
+ * structures is the one of the compiling binary, hence the sizes are checked
+ * when loading. The checksum is computed over the whole image, with the
+ * checksum itself set to 0. */
+typedef struct image_header {
+	char magic[8];
+	uint32_t version;
+	uint32_t ptr_size;		/* sizeof(void*) */
+	uint32_t pnode_size;	/* sizeof(Pnode) */
+	uint32_t vtree_size;	/* sizeof(VTree) */
+	uint64_t size;			/* size of the image in bytes */
+
+	uint64_t n_pnodes;		/* sections of the image */
+	uint64_t off_pnodes;
+	uint64_t n_vtrees;
+	uint64_t off_vtrees;
+	uint64_t n_pcells;		/* Pnode* (referred to by child and right) */
+	uint64_t off_pcells;
+	uint64_t n_scells;		/* char* (referred to by symbol) */
+	uint64_t off_scells;
+	uint64_t off_strings;
+	uint64_t len_strings;
+
+	uint64_t last;			/* last Pnode at the top level */
+	int64_t node_count;		/* number of Pnodes created so far */
+	uint64_t fp;			/* fingerprint of the scanned tokens */
+	uint64_t checksum;		/* FNV-1a hash of the 64-bit words of the image */
+} ImageHeader;
+
+unsigned short int image_write(char* filename, Pnode* last);
+unsigned short int image_load(char* filename);
+void image_close();
+
+#endif /* IMAGE_H */
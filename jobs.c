@@ -0,0 +1,671 @@
+/* [prove]: A proof verification system using bracketed expressions.
+ * Copyright (C) 2021  Gregor Feierabend
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include "jobs.h"
+#include "parser.h"
+#include "pgraph.h"
+#include "cert.h"
+#include "module.h"
+#include "debug.h"
+
+/* --- preprocessor directives ---------------------------------------------- */
+#define TRUE 1
+#define FALSE 0
+
+/* --- global variables ----------------------------------------------------- */
+
+/* number of this worker (-1 in the coordinator) */
+static int job_id = -1;
+
+/* coordinator: processes of the workers (0 after they have terminated) and
+ * the streams of their results */
+static pid_t* workers = NULL;
+static FILE** results = NULL;
+
+/* worker of a coordinator: shard to be verified (see job_worker) */
+static int shard_id = -1;
+static int shard_n = 0;
+static int shard_fd = -1;
+
+/* pipeline: child processes, which verify the lists of the statements parsed
+ * before, oldest first (a ring buffer of n_pipeline jobs) */
+static Job* queue = NULL;
+static int queue_first = 0;
+static int queue_len = 0;
+static int queue_unit = 0;		/* last statement, for which a job has been
+								   started */
+static FILE* source = NULL;		/* file parsed by the pipeline */
+static unsigned short int syncing = FALSE;
+
+/* worker: stream to the coordinator and counters before the current list */
+static FILE* out = NULL;
+static Strategy stats_before[ST_MAX];
+static unsigned long int hits_before;
+static unsigned long int misses_before;
+
+/* worker: record of the current list for the certificate (if any) */
+static unsigned short int certify = FALSE;
+static FILE* cert_stream = NULL;
+static char* cert_text = NULL;
+static size_t cert_len = 0;
+
+/* --- workers -------------------------------------------------------------- */
+/**
+ * @brief Sets up a worker process after it has been forked. The output of the
+ * worker has to be redirected to a regular file by the caller.
+ *
+ * @param id number of the worker
+ * @param fd file descriptor of the stream to the coordinator
+ */
+static void become_worker(int id, int fd)
+{
+	job_id = id;
+	out = fdopen(fd, "w");
+
+	/* the output of every list is sent to the coordinator together with its
+	 * result (see job_report), the profile is printed by the coordinator */
+	if ((fd = open("/dev/null", O_WRONLY)) != -1) {
+		dup2(fd, STDOUT_FILENO);
+		close(fd);
+	}
+
+	/* only the coordinator draws the graph and writes the certificate */
+	dbgops &= ~DBG_TIKZ;
+	certify = (cert_redirect(NULL) != NULL);
+}
+
+/**
+ * @brief Makes the calling process verify a shard of the file parsed next,
+ * i.e. every n-th statement at the top level starting with the id-th, and send
+ * the results to another process (see shard.c). Imported modules are verified
+ * as a whole. The output is written to stderr, which has to be a regular file;
+ * the output following the last list remains there.
+ *
+ * @param id number of the shard
+ * @param n number of shards
+ * @param fd file descriptor, to which the records are written
+ */
+void job_worker(int id, int n, int fd)
+{
+	shard_id = id;
+	shard_n = n;
+	shard_fd = fd;
+}
+
+/**
+ * @brief Makes a forked process read the rest of the source file with a file
+ * descriptor of its own (the buffered part of the file is shared).
+ *
+ * @param file [prove] source file (a regular file named by parse_source)
+ * @param pos position of the parent in the source file
+ */
+static void reopen_source(FILE* file, off_t pos)
+{
+	int src;
+
+	if ((src = open(parse_source, O_RDONLY)) == -1
+			|| lseek(src, pos, SEEK_SET) == -1
+			|| dup2(src, fileno(file)) == -1) {
+		fprintf(stderr, "error opening '%s'\n", parse_source);
+		_exit(EXIT_FAILURE);
+	}
+	close(src);
+}
+
+/**
+ * @brief Terminates the workers and jobs, which are still running (e.g. after
+ * verification has failed).
+ */
+static void stop_workers()
+{
+	int w;
+
+	for (w = 0; workers != NULL && w < n_jobs; w++) {
+		if (workers[w] > 0) {
+			kill(workers[w], SIGTERM);
+			waitpid(workers[w], NULL, 0);
+			workers[w] = 0;
+		}
+	}
+	for (w = 0; queue != NULL && w < n_pipeline; w++) {
+		if (queue[w].pid > 0) {
+			kill(queue[w].pid, SIGTERM);
+			waitpid(queue[w].pid, NULL, 0);
+			queue[w].pid = 0;
+		}
+	}
+}
+
+/**
+ * @brief Forks the worker processes, which share the graph parsed so far (and
+ * any loaded library) copy-on-write. Every worker parses the rest of the file
+ * on its own and verifies every n_jobs-th statement at the top level, the
+ * coordinator (i.e. the calling process) collects their results in order (see
+ * job_remote). In a pipeline, the jobs are forked later, one per statement.
+ *
+ * @param file [prove] source file (a regular file named by parse_source)
+ */
+void jobs_start(FILE* file)
+{
+	FILE* captured;
+	off_t pos;
+	pid_t pid;
+	int fds[2];
+	int id;
+	int w;
+
+	/* the shard starts after the imported modules (see job_worker) */
+	if (shard_fd != -1 && !compiling_module) {
+		n_jobs = shard_n;
+		become_worker(shard_id, shard_fd);
+		return;
+	}
+	if ((n_jobs <= 1 && n_pipeline <= 0) || job_id >= 0) {
+		return;
+	}
+
+	pos = lseek(fileno(file), 0, SEEK_CUR);
+	if (parse_source == NULL || pos == -1) {
+		fprintf(stderr, "'%s' requires a regular file\n",
+				n_pipeline > 0 ? "--pipeline" : "--jobs");
+		exit(EXIT_FAILURE);
+	}
+
+	if (n_pipeline > 0) {
+		source = file;
+		queue = (Job*) calloc(n_pipeline, sizeof(Job));
+		queue_first = queue_len = 0;
+		queue_unit = job_unit;
+		atexit(stop_workers);
+		return;
+	}
+
+	/* buffered output would be written by all processes otherwise */
+	fflush(NULL);
+	workers = (pid_t*) calloc(n_jobs, sizeof(pid_t));
+	results = (FILE**) calloc(n_jobs, sizeof(FILE*));
+	for (w = 0; w < n_jobs; w++) {
+		if (pipe(fds) == -1 || (pid = fork()) == -1) {
+			fprintf(stderr, "error creating a child process\n");
+			exit(EXIT_FAILURE);
+		}
+		if (pid == 0) {
+			close(fds[0]);
+			for (id = 0; id < w; id++) {
+				fclose(results[id]);
+			}
+			free(results);
+			free(workers);
+			results = NULL;
+			workers = NULL;
+			reopen_source(file, pos);
+			if ((captured = tmpfile()) != NULL) {
+				dup2(fileno(captured), STDERR_FILENO);
+			}
+			become_worker(w, fds[1]);
+			return;
+		}
+		close(fds[1]);
+		workers[w] = pid;
+		results[w] = fdopen(fds[0], "r");
+	}
+
+	atexit(stop_workers);
+}
+
+/**
+ * @brief Reads a number of characters from the stream of a worker.
+ *
+ * @param in stream of the worker
+ * @param len number of characters
+ *
+ * @return characters (terminated by '\0') or NULL, if the stream has ended
+ */
+static char* read_text(FILE* in, size_t len)
+{
+	char* text;
+
+	text = (char*) malloc(len + 1);
+	if (fread(text, 1, len, in) != len) {
+		free(text);
+		return NULL;
+	}
+	text[len] = '\0';
+	return text;
+}
+
+/**
+ * @brief Collects the result of a list from the worker, which has verified it.
+ * Its output and records are added as if the list had been verified by the
+ * coordinator, so that the output does not depend on the number of workers.
+ *
+ * @param line line of the list in the source file
+ * @param col column of the list in the source file
+ * @param verified set to TRUE, if verification was successful
+ */
+static void collect(int line, int col, unsigned short int* verified)
+{
+	JobRecord r;
+	FILE* in;
+	char* output;
+	char* text;
+	int w;
+
+	w = job_unit % n_jobs;
+	in = results[w];
+	output = text = NULL;
+	if (fread(&r, sizeof(JobRecord), 1, in) != 1
+			|| (output = read_text(in, r.len_output)) == NULL
+			|| (text = read_text(in, r.len_cert)) == NULL) {
+		fprintf(stderr, SHELL_RED "verification aborted on line %d, column %d "
+				"(worker %d has terminated)" SHELL_RESET1 "\n", line, col, w);
+		exit(EXIT_FAILURE);
+	}
+	if (r.perf.line != line || r.perf.col != col) {
+		fprintf(stderr, SHELL_RED "worker %d has verified line %d, column %d "
+				"instead of line %d, column %d" SHELL_RESET1 "\n", w,
+				r.perf.line, r.perf.col, line, col);
+		exit(EXIT_FAILURE);
+	}
+
+	job_add(&r, output, text);
+	free(output);
+	free(text);
+
+	*verified = r.perf.verified;
+	budget_exhausted = r.perf.exhausted;
+	if (*verified) {
+		SET_GFLAG_VRFD
+	}
+}
+
+/**
+ * @brief Prepares a record received from another process to be added to the
+ * profile (the name of the strategy is replaced by the name of the strategy in
+ * this process).
+ *
+ * @param r record
+ */
+void job_resolve(JobRecord* r)
+{
+	r->strategy[JOB_STRATEGY - 1] = '\0';
+	r->perf.strategy = r->strategy[0] != '\0' ? strategy_name(r->strategy)
+		: NULL;
+}
+
+/**
+ * @brief Adds the result of a list verified by another process as if it had
+ * been verified by the calling process, i.e. prints its output and adds its
+ * records to the certificate, the profile and the statistics.
+ *
+ * @param r record of the list
+ * @param output output of the list
+ * @param text certificate record of the list (terminated by '\0')
+ */
+void job_add(JobRecord* r, char* output, char* text)
+{
+	job_resolve(r);
+	fwrite(output, 1, r->len_output, stderr);
+	cert_append(text);
+
+	perf_add(&(r->perf));
+	add_strategy_stats(r->stats);
+	cache_hits += r->cache_hits;
+	cache_misses += r->cache_misses;
+}
+
+/**
+ * @brief Prints the messages of the parser for a list verified by another
+ * process, which has not been verified (see parse_statement). Lists, whose
+ * outcome is unknown, are counted in n_unknown.
+ *
+ * @param r record of the list
+ *
+ * @return FALSE, if verification has failed at the top level of the file
+ */
+unsigned short int job_check(JobRecord* r)
+{
+	if (r->perf.verified) {
+		return TRUE;
+	}
+	if (r->perf.exhausted) {
+		fprintf(stderr, SHELL_BROWN "verification on line %d, column %d "
+				"unknown (budget exhausted)" SHELL_RESET1 "\n", r->perf.line,
+				r->perf.col);
+		n_unknown++;
+		return TRUE;
+	}
+	if (!r->perf.toplevel) {
+		fprintf(stderr, SHELL_BROWN "<verification postponed to parent level>"
+				SHELL_RESET1 "\n");
+		return TRUE;
+	}
+	fprintf(stderr, SHELL_RED "verification failed on line %d, column %d"
+			SHELL_RESET1 "\n", r->perf.line, r->perf.col);
+	return FALSE;
+}
+
+/* --- pipeline ------------------------------------------------------------- */
+/**
+ * @brief Collects the results of the oldest job of the pipeline and waits for
+ * it to terminate. Verification is aborted, as soon as a statement has not
+ * been verified (unless "--dfinish" is given).
+ */
+static void collect_job()
+{
+	JobRecord r;
+	Job* j;
+	char* output;
+	char* text;
+	unsigned short int failed;
+	int wstatus;
+	int status;
+	int c;
+
+	j = &(queue[queue_first]);
+	queue_first = (queue_first + 1) % n_pipeline;
+	queue_len--;
+
+	failed = FALSE;
+	while (fread(&r, sizeof(JobRecord), 1, j->results) == 1
+			&& (output = read_text(j->results, r.len_output)) != NULL) {
+		if ((text = read_text(j->results, r.len_cert)) == NULL) {
+			free(output);
+			break;
+		}
+		job_add(&r, output, text);
+		free(output);
+		free(text);
+		if (!job_check(&r)) {
+			failed = TRUE;
+			if (!DBG_FINISH_IS_SET) {
+				exit(EXIT_FAILURE);
+			}
+			success = EXIT_FAILURE;
+		}
+	}
+	fclose(j->results);
+
+	status = -1;
+	if (waitpid(j->pid, &wstatus, 0) != -1 && WIFEXITED(wstatus)) {
+		status = WEXITSTATUS(wstatus);
+	}
+	j->pid = 0;
+	if (status == -1) {
+		fprintf(stderr, SHELL_RED "verification aborted (a process of the "
+				"pipeline has terminated abnormally)" SHELL_RESET1 "\n");
+		exit(EXIT_FAILURE);
+	}
+
+	/* errors outside of lists (e.g. syntax errors) are also found by the
+	 * parser, which reports them itself (see job_sync) */
+	if (status != EXIT_SUCCESS && !failed && !syncing) {
+		fflush(j->output);
+		rewind(j->output);
+		while ((c = getc(j->output)) != EOF) {
+			putc(c, stderr);
+		}
+		exit(status);
+	}
+	fclose(j->output);
+}
+
+/**
+ * @brief Forks a job, which verifies the lists of the current statement at the
+ * top level, while the calling process continues parsing. If the pipeline is
+ * full, the results of the oldest job are collected first.
+ *
+ * @return TRUE in the job, FALSE in the calling process
+ */
+static unsigned short int start_job()
+{
+	FILE* captured;
+	Job* j;
+	off_t pos;
+	pid_t pid;
+	int fds[2];
+	int i;
+
+	if (queue_len == n_pipeline) {
+		collect_job();
+	}
+
+	pos = lseek(fileno(source), 0, SEEK_CUR);
+	fflush(NULL);
+	if ((captured = tmpfile()) == NULL || pipe(fds) == -1
+			|| (pid = fork()) == -1) {
+		fprintf(stderr, "error creating a child process\n");
+		exit(EXIT_FAILURE);
+	}
+
+	if (pid == 0) {
+		close(fds[0]);
+		for (i = 0; i < queue_len; i++) {
+			j = &(queue[(queue_first + i) % n_pipeline]);
+			fclose(j->results);
+			fclose(j->output);
+		}
+		free(queue);
+		queue = NULL;
+		queue_len = 0;
+
+		/* the exit status only refers to the statement of the job */
+		success = EXIT_SUCCESS;
+		reopen_source(source, pos);
+		dup2(fileno(captured), STDERR_FILENO);
+		become_worker(job_unit, fds[1]);
+		return TRUE;
+	}
+
+	close(fds[1]);
+	j = &(queue[(queue_first + queue_len++) % n_pipeline]);
+	j->pid = pid;
+	j->results = fdopen(fds[0], "r");
+	j->output = captured;
+	queue_unit = job_unit;
+	return FALSE;
+}
+
+/**
+ * @brief Continues with the next statement at the top level (a job of the
+ * pipeline terminates after its statement).
+ */
+void job_next()
+{
+	job_unit++;
+	if (n_pipeline > 0 && job_id >= 0) {
+		fflush(NULL);
+		_exit(success);
+	}
+}
+
+/**
+ * @brief Collects the results of all jobs of the pipeline, e.g. before the
+ * parser reports an error, so that the output is in order.
+ */
+void job_sync()
+{
+	if (queue == NULL) {
+		return;
+	}
+	syncing = TRUE;
+	while (queue_len > 0) {
+		collect_job();
+	}
+	syncing = FALSE;
+}
+
+/* --- verification --------------------------------------------------------- */
+/**
+ * @brief Decides, whether a list is verified by another process. In the
+ * coordinator, the result of the worker is collected, workers treat the lists
+ * of other workers as verified. In a pipeline, the first list of every
+ * statement starts a job, which verifies all lists of the statement, while the
+ * calling process treats them as verified.
+ *
+ * @param line line of the list in the source file
+ * @param col column of the list in the source file
+ * @param verified set to TRUE, if verification was successful
+ *
+ * @return FALSE, if the list has to be verified by the calling process (its
+ * result has to be reported by job_report)
+ */
+unsigned short int job_remote(int line, int col, unsigned short int* verified)
+{
+	if (job_id < 0 && workers == NULL && queue == NULL) {
+		return FALSE;
+	}
+
+	if (job_id < 0 && workers != NULL) {
+		collect(line, col, verified);
+		return TRUE;
+	}
+
+	if ((job_id < 0 && (queue_unit == job_unit || !start_job()))
+			|| (n_pipeline <= 0 && job_unit % n_jobs != job_id)) {
+		SET_GFLAG_VRFD
+		*verified = TRUE;
+		return TRUE;
+	}
+
+	/* the output of the list is captured from now on */
+	fflush(stderr);
+	if (ftruncate(STDERR_FILENO, 0) == 0) {
+		lseek(STDERR_FILENO, 0, SEEK_SET);
+	}
+	memset(stats_before, 0, sizeof(stats_before));
+	get_strategy_stats(stats_before);
+	hits_before = cache_hits;
+	misses_before = cache_misses;
+	if (certify && (cert_stream = open_memstream(&cert_text, &cert_len))
+			!= NULL) {
+		cert_redirect(cert_stream);
+	}
+	return FALSE;
+}
+
+/**
+ * @brief Sends the result of a list, which has been verified by a worker, to
+ * the coordinator (after its record has been added to the profile and to the
+ * certificate).
+ */
+void job_report()
+{
+	JobRecord r;
+	Strategy after[ST_MAX];
+	char* output;
+	off_t len;
+	ssize_t n;
+	int i;
+
+	if (job_id < 0) {
+		return;
+	}
+
+	memset(&r, 0, sizeof(JobRecord));
+	r.perf = *perf_last();
+	if (r.perf.strategy != NULL) {
+		strncpy(r.strategy, r.perf.strategy, JOB_STRATEGY - 1);
+	}
+	memset(after, 0, sizeof(after));
+	get_strategy_stats(after);
+	for (i = 0; i < ST_MAX; i++) {
+		r.stats[i].tried = after[i].tried - stats_before[i].tried;
+		r.stats[i].solved = after[i].solved - stats_before[i].solved;
+		r.stats[i].exhausted = after[i].exhausted - stats_before[i].exhausted;
+		r.stats[i].effort = after[i].effort - stats_before[i].effort;
+	}
+	r.cache_hits = cache_hits - hits_before;
+	r.cache_misses = cache_misses - misses_before;
+
+	fflush(stderr);
+	len = lseek(STDERR_FILENO, 0, SEEK_END);
+	output = (char*) malloc(len > 0 ? len : 1);
+	n = len > 0 ? pread(STDERR_FILENO, output, len, 0) : 0;
+	r.len_output = n > 0 ? n : 0;
+
+	if (cert_stream != NULL) {
+		cert_redirect(NULL);
+		fclose(cert_stream);
+		cert_stream = NULL;
+		r.len_cert = cert_len;
+	}
+
+	fwrite(&r, sizeof(JobRecord), 1, out);
+	fwrite(output, 1, r.len_output, out);
+	fwrite(cert_text, 1, r.len_cert, out);
+	fflush(out);
+
+	/* output following the list is not part of its record */
+	if (ftruncate(STDERR_FILENO, 0) == 0) {
+		lseek(STDERR_FILENO, 0, SEEK_SET);
+	}
+
+	free(output);
+	free(cert_text);
+	cert_text = NULL;
+}
+
+/**
+ * @brief Finishes parallel verification after the file has been parsed:
+ * workers terminate, the coordinator waits for them.
+ */
+void jobs_finish()
+{
+	int wstatus;
+	int w;
+
+	if (job_id >= 0) {
+		fflush(NULL);
+		_exit(success);
+	}
+	if (queue != NULL) {
+		while (queue_len > 0) {
+			collect_job();
+		}
+		free(queue);
+		queue = NULL;
+		source = NULL;
+		return;
+	}
+	if (workers == NULL) {
+		return;
+	}
+
+	for (w = 0; w < n_jobs; w++) {
+		fclose(results[w]);
+		waitpid(workers[w], &wstatus, 0);
+		workers[w] = 0;
+		if (!WIFEXITED(wstatus)) {
+			fprintf(stderr, SHELL_RED "worker %d has terminated abnormally"
+					SHELL_RESET1 "\n", w);
+			success = EXIT_FAILURE;
+		}
+	}
+	free(workers);
+	free(results);
+	workers = NULL;
+	results = NULL;
+}
@@ -0,0 +1,77 @@
+/* [prove]: A proof verification system using bracketed expressions.
+ * Copyright (C) 2021  Gregor Feierabend
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef JOBS_H
+#define JOBS_H
+
+#include <stdio.h>
+#include <sys/types.h>
+#include "perf.h"
+#include "strategy.h"
+
+/* maximal length of the name of a strategy in a JobRecord */
+#define JOB_STRATEGY 32
+
+/* outcome of a list verified by a worker (followed by len_output characters
+ * of its output and len_cert characters of its certificate record) */
+typedef struct job_record {
+	PerfRecord perf;		/* counters and outcome of the list (line 0 marks the
+							   end of a shard, see shard.c) */
+	char strategy[JOB_STRATEGY];	/* name of the strategy, which has verified
+									   the list (pointers are only valid in the
+									   worker) */
+	Strategy stats[ST_MAX];	/* increase of the counters of the strategies */
+	unsigned long int cache_hits;
+	unsigned long int cache_misses;
+	int status;				/* end of a shard: exit status of the worker (-1,
+							   if it has terminated abnormally) */
+	size_t len_output;
+	size_t len_cert;
+} JobRecord;
+
+/* child process of the pipeline, which verifies the lists of a statement at
+ * the top level (see job_remote) */
+typedef struct job {
+	pid_t pid;
+	FILE* results;		/* stream of its JobRecords */
+	FILE* output;		/* its output following the last list */
+} Job;
+
+/* number of worker processes (0 or 1 to verify sequentially) */
+int n_jobs;
+
+/* maximal number of statements verified, while parsing continues (0 to
+ * verify sequentially) */
+int n_pipeline;
+
+/* number of the current statement at the top level of the file (statements
+ * are assigned to the workers in turn) */
+int job_unit;
+
+void jobs_start(FILE* file);
+void job_worker(int id, int n, int fd);
+void job_resolve(JobRecord* r);
+void job_add(JobRecord* r, char* output, char* text);
+unsigned short int job_check(JobRecord* r);
+void job_next();
+void job_sync();
+unsigned short int job_remote(int line, int col, unsigned short int* verified);
+void job_report();
+void jobs_finish();
+
+#endif /* JOBS_H */
@@ -0,0 +1,455 @@
+/* [prove]: A proof verification system using bracketed expressions.
+ * Copyright (C) 2021  Gregor Feierabend
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "parser.h"
+#include "pgraph.h"
+#include "verify.h"
+#include "nogood.h"
+
+/* --- preprocessor directives ---------------------------------------------- */
+#define TRUE 1
+#define FALSE 0
+
+/* maximal number of sizes per benchmark */
+#define MB_SIZES 8
+/* minimal duration of a single repetition in nanoseconds */
+#define MB_MIN_NS 1000000ULL
+
+/* --- type definitions ----------------------------------------------------- */
+/* A micro-benchmark writes a [prove] source of a certain size, picks the
+ * Pnodes it operates on from the resulting graph and then repeatedly runs the
+ * kernel. */
+typedef struct microbench {
+	char* name;
+	int sizes[MB_SIZES];			/* sizes to be run (0-terminated) */
+	void (*source)(FILE* f, int size);
+	void (*setup)(Pnode* first);	/* first: first top-level statement */
+	unsigned long (*run)(void);		/* returns the number of operations */
+} Microbench;
+
+/* --- function prototypes -------------------------------------------------- */
+void src_const_equal(FILE* f, int size);
+void setup_const_equal(Pnode* first);
+unsigned long run_const_equal(void);
+void src_check_asmp(FILE* f, int size);
+void setup_check_asmp(Pnode* first);
+unsigned long run_check_asmp(void);
+void src_next_sub(FILE* f, int size);
+void setup_next_sub(Pnode* first);
+unsigned long run_next_sub(void);
+void src_next_backwards(FILE* f, int size);
+void setup_next_backwards(Pnode* first);
+unsigned long run_next_backwards(void);
+void src_move_and_sum_up(FILE* f, int size);
+void setup_move_and_sum_up(Pnode* first);
+unsigned long run_move_and_sum_up(void);
+
+/* --- global variables ----------------------------------------------------- */
+static Microbench benchmarks[] = {
+	{"const_equal", {2, 4, 8, 12, 0}, src_const_equal, setup_const_equal,
+		run_const_equal},
+	{"check_asmp", {16, 256, 4096, 0}, src_check_asmp, setup_check_asmp,
+		run_check_asmp},
+	{"init_sub/next_sub", {4, 16, 64, 0}, src_next_sub, setup_next_sub,
+		run_next_sub},
+	{"next_backwards", {4, 16, 64, 0}, src_next_backwards,
+		setup_next_backwards, run_next_backwards},
+	{"move_and_sum_up", {4, 16, 64, 256, 0}, src_move_and_sum_up,
+		setup_move_and_sum_up, run_move_and_sum_up},
+};
+#define N_BENCHMARKS (sizeof(benchmarks) / sizeof(Microbench))
+
+/* Pnodes the kernels operate on */
+static Pnode* mb_p1;
+static Pnode* mb_p2;
+
+/* --- helpers -------------------------------------------------------------- */
+/**
+ * @brief Returns the n-th top-level statement.
+ *
+ * @param first first top-level statement
+ * @param n number of the statement (negative numbers count from the end)
+ *
+ * @return Pnode of the statement
+ */
+Pnode* statement(Pnode* first, int n)
+{
+	Pnode* pnode;
+
+	pnode = first;
+	if (n < 0) {
+		move_rightmost(&pnode);
+		for (n++; n < 0 && move_left(&pnode); n++);
+	} else {
+		for (; n > 0 && move_right(&pnode); n--);
+	}
+	return pnode;
+}
+
+/**
+ * @brief Writes a binary tree of formulas of a given depth.
+ *
+ * @param f file to be written to
+ * @param depth depth of the tree
+ */
+void write_term(FILE* f, int depth)
+{
+	if (depth == 0) {
+		fprintf(f, "[x]");
+	} else {
+		fprintf(f, "[");
+		write_term(f, depth - 1);
+		fprintf(f, "f");
+		write_term(f, depth - 1);
+		fprintf(f, "]");
+	}
+}
+
+/**
+ * @brief Returns the current time of the monotonic clock in nanoseconds.
+ */
+unsigned long long now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (unsigned long long) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/* --- const_equal ---------------------------------------------------------- */
+/* comparison of two equal formulas with 2^size leaves */
+void src_const_equal(FILE* f, int size)
+{
+	fprintf(f, "[x]\n");
+	write_term(f, size);
+	fprintf(f, "\n");
+	write_term(f, size);
+	fprintf(f, "\n");
+}
+
+void setup_const_equal(Pnode* first)
+{
+	mb_p1 = *(statement(first, 1)->child);
+	mb_p2 = *(statement(first, 2)->child);
+}
+
+unsigned long run_const_equal(void)
+{
+	if (!const_equal(mb_p1, mb_p2)) {
+		fprintf(stderr, "const_equal: unexpected result\n");
+		exit(EXIT_FAILURE);
+	}
+	return 1;
+}
+
+/* --- check_asmp ----------------------------------------------------------- */
+/* lookup of an assumption, which is the size-th visible constant */
+void src_check_asmp(FILE* f, int size)
+{
+	int i;
+
+	fprintf(f, "[x]\n");
+	for (i = 1; i <= size; i++) {
+		fprintf(f, "[[x]:c%d]\n", i);
+	}
+	fprintf(f, "[[x]:c1]\n");
+}
+
+void setup_check_asmp(Pnode* first)
+{
+	mb_p1 = statement(first, -1);
+}
+
+unsigned long run_check_asmp(void)
+{
+	Pnode* pexplorer;
+
+	pexplorer = mb_p1;
+	if (!check_asmp(mb_p1, &pexplorer, FALSE)) {
+		fprintf(stderr, "check_asmp: unexpected result\n");
+		exit(EXIT_FAILURE);
+	}
+	return 1;
+}
+
+/* --- init_sub/next_sub ---------------------------------------------------- */
+/* enumeration of all substitutions of two variables by size known ids */
+void src_next_sub(FILE* f, int size)
+{
+	int i;
+
+	for (i = 1; i <= size; i++) {
+		fprintf(f, "[p%d]\n", i);
+	}
+	fprintf(f, "[ [x] [y] => [[x][y]r] ]\n[[]end]\n");
+}
+
+void setup_next_sub(Pnode* first)
+{
+	mb_p1 = statement(first, -1);
+	mb_p2 = statement(first, -2);
+}
+
+unsigned long run_next_sub(void)
+{
+	VFlags vflags;
+	SUB* subd;
+	unsigned long ops;
+
+	vflags = VFLAG_NONE;
+	subd = NULL;
+	ops = 0;
+
+	if (init_sub(mb_p1, mb_p2->vtree, &vflags, &subd, FALSE, FALSE, 0)) {
+		for (ops = 1; next_sub(mb_p1, subd, FALSE, FALSE, 0); ops++);
+	}
+	finish_sub(&vflags, &subd);
+
+	return ops;
+}
+
+/* --- next_backwards ------------------------------------------------------- */
+/* exploration of everything reachable from the end of an incidence-style file
+ * with size points (the nogood store is warm after the first run) */
+void src_next_backwards(FILE* f, int size)
+{
+	int i;
+
+	fprintf(f, "[pln] [[pln]:plane]\n"
+			"[ [x] [[x]:point] => [[x]in[pln]] ]\n");
+	for (i = 1; i <= size; i++) {
+		fprintf(f, "[p%d] [[p%d]:point]\n", i, i);
+	}
+	fprintf(f, "[[p1]in[pln]]\n");
+}
+
+void setup_next_backwards(Pnode* first)
+{
+	mb_p1 = statement(first, -1);
+}
+
+unsigned long run_next_backwards(void)
+{
+	Eqwrapper* eqwrapper;
+	Pnode* pexplorer;
+	BC* checkpoint;
+	SUB* subd;
+	VFlags vflags;
+	unsigned long ops;
+
+	eqwrapper = (Eqwrapper*) malloc(sizeof(Eqwrapper));
+	eqwrapper->pwrapper = eqwrapper->pendwrap = NULL;
+	pexplorer = mb_p1;
+	checkpoint = NULL;
+	subd = NULL;
+	vflags = VFLAG_NONE;
+
+	for (ops = 0; next_backwards(mb_p1, mb_p1, &pexplorer, &eqwrapper,
+				&checkpoint, &vflags, &subd, FALSE, FALSE, 0, TRUE, TRUE);
+			ops++);
+
+	free(eqwrapper);
+	return ops;
+}
+
+/* --- move_and_sum_up ------------------------------------------------------ */
+/* summing up a level of a statement quantifying over size ids */
+void src_move_and_sum_up(FILE* f, int size)
+{
+	int i;
+
+	fprintf(f, "[ ");
+	for (i = 1; i <= size; i++) {
+		fprintf(f, "[a%d] [[a%d]:p] ", i, i);
+	}
+	fprintf(f, "=> [[a1]:p] ]\n");
+}
+
+void setup_move_and_sum_up(Pnode* first)
+{
+	mb_p1 = *(first->child);
+	move_rightmost(&mb_p1);
+	mb_p2 = first;
+}
+
+unsigned long run_move_and_sum_up(void)
+{
+	Pnode* pnode;
+	VTree* vtree;
+	VTree* next;
+
+	pnode = mb_p1;
+	move_and_sum_up(&pnode);
+
+	/* free the VTree nodes created for this level (the VTree of the
+	 * rightmost Pnode is not new) */
+	for (vtree = mb_p2->vtree; vtree != mb_p1->vtree; vtree = next) {
+		next = vtree->right;
+		free(vtree);
+	}
+	mb_p2->vtree = NULL;
+
+	return 1;
+}
+
+/* --- driver --------------------------------------------------------------- */
+/**
+ * @brief Runs a benchmark for a single size and prints the results.
+ *
+ * @param mb benchmark to be run
+ * @param size size of the graph
+ * @param warmup number of warmup runs
+ * @param reps number of timed repetitions
+ */
+void run_benchmark(Microbench* mb, int size, int warmup, int reps)
+{
+	FILE* f;
+	Pnode* first;
+	unsigned long long start;
+	unsigned long long elapsed;
+	unsigned long long iters;
+	unsigned long long ops;
+	unsigned long long i;
+	double ns;
+	double best;
+	double total;
+	int r;
+
+	f = tmpfile();
+	if (f == NULL) {
+		perror("tmpfile");
+		exit(EXIT_FAILURE);
+	}
+	mb->source(f, size);
+	rewind(f);
+
+	first = parse_file(f);
+	while (move_up(&first));
+	while (move_left(&first));
+	mb->setup(first);
+
+	/* warmup, calibrating the number of runs per repetition */
+	for (r = 0; r < warmup; r++) {
+		mb->run();
+	}
+	iters = 1;
+	do {
+		start = now_ns();
+		for (i = 0; i < iters; i++) {
+			mb->run();
+		}
+		elapsed = now_ns() - start;
+		if (elapsed < MB_MIN_NS) {
+			iters *= 2;
+		}
+	} while (elapsed < MB_MIN_NS);
+
+	best = 0;
+	total = 0;
+	for (r = 0; r < reps; r++) {
+		ops = 0;
+		start = now_ns();
+		for (i = 0; i < iters; i++) {
+			ops += mb->run();
+		}
+		elapsed = now_ns() - start;
+
+		ns = (ops > 0) ? (double) elapsed / ops : 0;
+		if (r == 0 || ns < best) {
+			best = ns;
+		}
+		total += ns;
+	}
+
+	printf("%-20s %8d %12llu %12.1f %12.1f\n", mb->name, size, ops / iters,
+			best, total / reps);
+
+	fclose(f);
+}
+
+/**
+ * @brief main function of the micro-benchmarks for the verifier kernels
+ *
+ * @param argc number of command line arguments
+ * @param argv command line arguments
+ *
+ * @return 0 or error code
+ */
+int main(int argc, char *argv[])
+{
+	int warmup;
+	int reps;
+	int i;
+	int j;
+	unsigned int b;
+	unsigned short int all;
+
+	warmup = 10;
+	reps = 10;
+	all = TRUE;
+
+	for (i = 1; i < argc; i++) {
+		if (strncmp(argv[i], "--warmup=", 9) == 0) {
+			warmup = atoi(argv[i] + 9);
+		} else if (strncmp(argv[i], "--reps=", 7) == 0) {
+			reps = atoi(argv[i] + 7);
+		} else if (strcmp(argv[i], "--help") == 0 || argv[i][0] == '-'
+				|| reps < 1) {
+			printf("Usage: %s [--warmup=<runs>] [--reps=<repetitions>] "
+					"[<benchmark>...]\n\nbenchmarks:", argv[0]);
+			for (b = 0; b < N_BENCHMARKS; b++) {
+				printf(" %s", benchmarks[b].name);
+			}
+			printf("\n");
+			exit(strcmp(argv[i], "--help") == 0 ? EXIT_SUCCESS
+					: EXIT_FAILURE);
+		} else {
+			all = FALSE;
+		}
+	}
+
+	do_veri = FALSE;
+	success = EXIT_SUCCESS;
+	init_nogood();
+
+	printf("%-20s %8s %12s %12s %12s\n", "benchmark", "size", "ops/run",
+			"best ns/op", "mean ns/op");
+
+	for (b = 0; b < N_BENCHMARKS; b++) {
+		if (!all) {
+			for (i = 1; i < argc; i++) {
+				if (strcmp(argv[i], benchmarks[b].name) == 0) {
+					break;
+				}
+			}
+			if (i == argc) {
+				continue;
+			}
+		}
+		for (j = 0; j < MB_SIZES && benchmarks[b].sizes[j] != 0; j++) {
+			run_benchmark(&benchmarks[b], benchmarks[b].sizes[j], warmup,
+					reps);
+		}
+	}
+
+	free_nogood();
+	return EXIT_SUCCESS;
+}
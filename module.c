@@ -0,0 +1,467 @@
+/* [prove]: A proof verification system using bracketed expressions.
+ * Copyright (C) 2021  Gregor Feierabend
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <libgen.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include "module.h"
+#include "parser.h"
+#include "image.h"
+#include "cert.h"
+#include "strategy.h"
+#include "nogood.h"
+#include "perf.h"
+#include "debug.h"
+
+/* --- preprocessor directives ---------------------------------------------- */
+#define TRUE 1
+#define FALSE 0
+
+/* parameters of the FNV-1a hash of the content of a module */
+#define FNV_OFFSET 0xcbf29ce484222325ULL
+#define FNV_PRIME 0x100000001b3ULL
+
+/* maximum length of the name of an image in the cache (without the name of
+ * the directory) */
+#define MODULE_NAMELEN 48
+
+/* --- global variables ----------------------------------------------------- */
+
+/* imported modules in the order, in which they are concatenated (i.e. every
+ * module follows the modules it imports) */
+static Module* chain = NULL;
+static int n_chain = 0;
+
+/* modules, whose imports are being resolved (to detect cycles) */
+static char** visiting = NULL;
+static int n_visiting = 0;
+
+/* --- resolving imports ---------------------------------------------------- */
+/**
+ * @brief Gets the directory of a file.
+ *
+ * @param filename name of the file (NULL for the current directory)
+ *
+ * @return name of the directory (to be freed by the caller)
+ */
+static char* dir_of(char* filename)
+{
+	char* copy;
+	char* dir;
+
+	if (filename == NULL) {
+		copy = (char*) malloc(2);
+		strcpy(copy, ".");
+		return copy;
+	}
+
+	copy = (char*) malloc(strlen(filename) + 1);
+	strcpy(copy, filename);
+	dir = dirname(copy);
+	memmove(copy, dir, strlen(dir) + 1);
+	return copy;
+}
+
+/**
+ * @brief Reads a module, i.e. hashes its content and collects the paths of
+ * the import directives at its beginning (see parse_imports in parser.c).
+ *
+ * @param filename name of the module
+ * @param hash set to the hash of the content
+ * @param imports set to the paths of the imports (to be freed by the caller)
+ * @param n set to the number of imports
+ *
+ * @return FALSE, if the module cannot be read
+ */
+static unsigned short int read_module(char* filename, uint64_t* hash,
+		char*** imports, int* n)
+{
+	FILE* file;
+	char* line;
+	char* c;
+	char* end;
+	size_t size;
+	ssize_t len;
+	ssize_t i;
+	unsigned short int header;
+
+	*hash = FNV_OFFSET;
+	*imports = NULL;
+	*n = 0;
+	if ((file = fopen(filename, "r")) == NULL) {
+		return FALSE;
+	}
+
+	line = NULL;
+	size = 0;
+	header = TRUE;
+	while ((len = getline(&line, &size, file)) != -1) {
+		for (i = 0; i < len; i++) {
+			*hash = (*hash ^ (unsigned char) line[i]) * FNV_PRIME;
+		}
+		if (!header) {
+			continue;
+		}
+
+		for (c = line; *c == ' ' || *c == '\t'; c++);
+		if (isspace((unsigned char) *c) || *c == '\0' || *c == '#') {
+			/* blank lines and comments */
+			continue;
+		}
+		if (strncmp(c, "import", 6) != 0 || (c[6] != ' ' && c[6] != '\t')) {
+			header = FALSE;
+			continue;
+		}
+		for (c += 6; *c == ' ' || *c == '\t'; c++);
+		end = c + strcspn(c, "#\n");
+		while (end > c && isspace((unsigned char) end[-1])) {
+			end--;
+		}
+		if (end == c || *c == '[' || *c == ']') {
+			header = FALSE;
+			continue;
+		}
+		*end = '\0';
+
+		*imports = (char**) realloc(*imports, (*n + 1) * sizeof(char*));
+		(*imports)[*n] = (char*) malloc(end - c + 1);
+		strcpy((*imports)[*n], c);
+		(*n)++;
+	}
+
+	free(line);
+	fclose(file);
+	return TRUE;
+}
+
+/**
+ * @brief Appends a module (preceded by the modules it imports) to the chain
+ * of imported modules, unless it is part of the chain already.
+ *
+ * @param path path of the module as written in the import directive
+ * @param dir directory of the importing file
+ *
+ * @return FALSE, if a module cannot be read or the imports are cyclic
+ */
+static unsigned short int resolve(char* path, char* dir)
+{
+	char* full;
+	char* real;
+	char* sub;
+	char** imports;
+	uint64_t hash;
+	int n;
+	int i;
+	unsigned short int ok;
+
+	full = (char*) malloc(strlen(dir) + strlen(path) + 2);
+	if (path[0] == '/') {
+		strcpy(full, path);
+	} else {
+		sprintf(full, "%s/%s", dir, path);
+	}
+	real = realpath(full, NULL);
+	if (real == NULL) {
+		fprintf(stderr, "error opening module '%s'\n", full);
+		free(full);
+		return FALSE;
+	}
+	free(full);
+
+	for (i = 0; i < n_chain; i++) {
+		if (strcmp(chain[i].path, real) == 0) {
+			/* imported before */
+			free(real);
+			return TRUE;
+		}
+	}
+	for (i = 0; i < n_visiting; i++) {
+		if (strcmp(visiting[i], real) == 0) {
+			fprintf(stderr, "cyclic import of module '%s'\n", real);
+			free(real);
+			return FALSE;
+		}
+	}
+	if (!read_module(real, &hash, &imports, &n)) {
+		fprintf(stderr, "error opening module '%s'\n", real);
+		free(real);
+		return FALSE;
+	}
+
+	ok = TRUE;
+	visiting = (char**) realloc(visiting, (n_visiting + 1) * sizeof(char*));
+	visiting[n_visiting++] = real;
+	sub = dir_of(real);
+	for (i = 0; i < n; i++) {
+		if (ok) {
+			ok = resolve(imports[i], sub);
+		}
+		free(imports[i]);
+	}
+	free(imports);
+	free(sub);
+	n_visiting--;
+
+	if (!ok) {
+		free(real);
+		return FALSE;
+	}
+
+	chain = (Module*) realloc(chain, (n_chain + 1) * sizeof(Module));
+	chain[n_chain].path = real;
+	chain[n_chain].hash = hash;
+	n_chain++;
+	return TRUE;
+}
+
+/**
+ * @brief Frees the chain of imported modules.
+ */
+static void free_chain()
+{
+	while (n_chain > 0) {
+		free(chain[--n_chain].path);
+	}
+	free(chain);
+	chain = NULL;
+	while (n_visiting > 0) {
+		free(visiting[--n_visiting]);
+	}
+	free(visiting);
+	visiting = NULL;
+}
+
+/* --- compiling modules ---------------------------------------------------- */
+/**
+ * @brief Gets the directory, in which the images of modules are cached, i.e.
+ * the cache directory (see "--cache") or $XDG_CACHE_HOME/prove
+ * (~/.cache/prove by default). The directory is created, if it does not exist.
+ *
+ * @return name of the directory (to be freed by the caller) or NULL, if there
+ * is none
+ */
+static char* module_dir()
+{
+	char* base;
+	char* dir;
+	struct stat st;
+
+	if ((base = cache_path()) != NULL) {
+		dir = (char*) malloc(strlen(base) + 1);
+		strcpy(dir, base);
+		return dir;
+	}
+
+	if ((base = getenv("XDG_CACHE_HOME")) != NULL && *base != '\0') {
+		dir = (char*) malloc(strlen(base) + 7);
+		strcpy(dir, base);
+	} else if ((base = getenv("HOME")) != NULL && *base != '\0') {
+		dir = (char*) malloc(strlen(base) + 14);
+		sprintf(dir, "%s/.cache", base);
+	} else {
+		return NULL;
+	}
+	mkdir(dir, 0777);
+	strcat(dir, "/prove");
+
+	if ((stat(dir, &st) == -1 && mkdir(dir, 0777) == -1)
+			|| stat(dir, &st) == -1 || !S_ISDIR(st.st_mode)) {
+		free(dir);
+		return NULL;
+	}
+	return dir;
+}
+
+/**
+ * @brief Verifies a module as continuation of the loaded library and writes
+ * its image (in a child process, which does not return).
+ *
+ * @param m module
+ * @param name name of the image
+ */
+static void verify_module(Module* m, char* name)
+{
+	FILE* file;
+	Pnode* root;
+	char* tmp;
+	int fd;
+
+	if ((fd = open("/dev/null", O_WRONLY)) != -1) {
+		dup2(fd, STDOUT_FILENO);
+	}
+
+	/* only the importing file is drawn, certified or exported */
+	dbgops &= ~DBG_TIKZ;
+	do_replay = FALSE;
+	cache_export = NULL;
+	cert_redirect(NULL);
+	compiling_module = TRUE;
+	success = EXIT_SUCCESS;
+
+	if ((file = fopen(m->path, "r")) == NULL) {
+		fprintf(stderr, "error opening '%s'\n", m->path);
+		_exit(EXIT_FAILURE);
+	}
+	parse_source = m->path;
+	perf_source(m->path);
+	root = parse_file(file);
+
+	/* images are written to a temporary file first, so that concurrent runs
+	 * never load partial images */
+	if (success == EXIT_SUCCESS) {
+		tmp = (char*) malloc(strlen(name) + 24);
+		sprintf(tmp, "%s.%ld", name, (long) getpid());
+		if (!image_write(tmp, root) || rename(tmp, name) != 0) {
+			fprintf(stderr, "error writing '%s'\n", name);
+			remove(tmp);
+			success = EXIT_FAILURE;
+		}
+	}
+
+	fflush(stderr);
+	_exit(success);
+}
+
+/**
+ * @brief Compiles a module in a child process (see verify_module). The output
+ * of the child is only printed, if the module has not been verified.
+ *
+ * @param m module
+ * @param name name of the image
+ *
+ * @return TRUE, if the image has been written
+ */
+static unsigned short int compile_module(Module* m, char* name)
+{
+	FILE* errors;
+	pid_t pid;
+	int wstatus;
+	int c;
+
+	/* buffered output would be written by both processes otherwise */
+	fflush(NULL);
+	if ((errors = tmpfile()) == NULL) {
+		fprintf(stderr, "error creating a child process\n");
+		return FALSE;
+	}
+
+	if ((pid = fork()) == 0) {
+		dup2(fileno(errors), STDERR_FILENO);
+		verify_module(m, name);
+	}
+	if (pid == -1) {
+		fprintf(stderr, "error creating a child process\n");
+		fclose(errors);
+		return FALSE;
+	}
+
+	waitpid(pid, &wstatus, 0);
+	if (WIFEXITED(wstatus) && WEXITSTATUS(wstatus) == EXIT_SUCCESS) {
+		fclose(errors);
+		return TRUE;
+	}
+
+	rewind(errors);
+	while ((c = fgetc(errors)) != EOF) {
+		fputc(c, stderr);
+	}
+	fclose(errors);
+	fprintf(stderr, SHELL_RED "module '%s' has not been verified"
+			SHELL_RESET1 "\n", m->path);
+	return FALSE;
+}
+
+/**
+ * @brief Imports modules, i.e. loads the image of the concatenation of the
+ * imported modules as library. The image of every prefix of the chain of
+ * modules is cached under a hash of the contents of its modules and of the
+ * strategy pipeline, so that a module is only verified, if it or a module
+ * preceding it has changed.
+ *
+ * @param paths paths of the imported modules
+ * @param n number of imported modules
+ * @param source name of the importing file (NULL for the current directory)
+ *
+ * @return FALSE, if a module cannot be read or has not been verified
+ */
+unsigned short int import_modules(char** paths, int n, char* source)
+{
+	char* dir;
+	char* real;
+	char* name;
+	char* prev;
+	uint64_t key;
+	int i;
+	unsigned short int ok;
+
+	if (compiling_module) {
+		/* the imports of a module precede it in the chain, i.e. they are part
+		 * of the library already */
+		return TRUE;
+	}
+	if (prefix_last != NULL) {
+		fprintf(stderr, "imports cannot be combined with '--library'\n");
+		return FALSE;
+	}
+
+	if (source != NULL && (real = realpath(source, NULL)) != NULL) {
+		visiting = (char**) malloc(sizeof(char*));
+		visiting[n_visiting++] = real;
+	}
+	dir = dir_of(source);
+	ok = TRUE;
+	for (i = 0; ok && i < n; i++) {
+		ok = resolve(paths[i], dir);
+	}
+	free(dir);
+
+	if (ok && (dir = module_dir()) == NULL) {
+		fprintf(stderr, "error opening module cache\n");
+		ok = FALSE;
+	}
+	if (!ok) {
+		free_chain();
+		return FALSE;
+	}
+
+	key = mix_fp(mix_fp(pipeline_fp(), IMAGE_VERSION), do_veri);
+	prev = NULL;
+	for (i = 0; ok && i < n_chain; i++) {
+		key = mix_fp(key, chain[i].hash);
+		name = (char*) malloc(strlen(dir) + MODULE_NAMELEN);
+		sprintf(name, "%s/%016llx.img", dir, (unsigned long long) key);
+		if (access(name, R_OK) != 0) {
+			ok = (prev == NULL || image_load(prev))
+				&& compile_module(&(chain[i]), name);
+			image_close();
+		}
+		free(prev);
+		prev = name;
+	}
+	ok = ok && prev != NULL && image_load(prev);
+
+	free(prev);
+	free(dir);
+	free_chain();
+	return ok;
+}
@@ -0,0 +1,36 @@
+/* [prove]: A proof verification system using bracketed expressions.
+ * Copyright (C) 2021  Gregor Feierabend
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef MODULE_H
+#define MODULE_H
+
+#include <stdint.h>
+
+/* module in the order, in which the imported modules are concatenated */
+typedef struct module {
+	char* path;		/* canonical path of the module */
+	uint64_t hash;	/* hash of the content of the module */
+} Module;
+
+/* TRUE in the process, which compiles a module (its imports are part of the
+ * loaded library) */
+unsigned short int compiling_module;
+
+unsigned short int import_modules(char** paths, int n, char* source);
+
+#endif /* MODULE_H */
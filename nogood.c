@@ -0,0 +1,157 @@
+/* [prove]: A proof verification system using bracketed expressions.
+ * Copyright (C) 2021  Gregor Feierabend
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include "nogood.h"
+
+/* --- preprocessor directives ---------------------------------------------- */
+#define TRUE 1
+#define FALSE 0
+
+/* A nogood is a sub-goal, which has been found to fail. It is identified by
+ * the goal (a closed Pnode or the current position in a list), the context
+ * visible to it (the head of the prev_const chain or the beginning of the list)
+ * and the fingerprint of all substitutions in place. New constants coming into
+ * scope always start a new prev_const chain, hence they can never be confused
+ * with an old context. */
+typedef struct nogood {
+	NGKind kind;
+	Pnode* goal;
+	Pnode* ctx;
+	uint64_t aux;	/* further state the goal depends on */
+	uint64_t bind;	/* fingerprint of substitutions */
+	unsigned int scope;
+} Nogood;
+
+static Nogood* store = NULL;
+static unsigned int scope = 0;	/* entries of kind NG_VQ from older scopes are
+								   invalid */
+
+/**
+ * @brief Mixes a value into a 64-bit fingerprint.
+ *
+ * @param h fingerprint so far
+ * @param v value to be mixed in
+ *
+ * @return new fingerprint
+ */
+uint64_t mix_fp(uint64_t h, uint64_t v)
+{
+	h ^= v + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+	h ^= h >> 31;
+	h *= 0xbf58476d1ce4e5b9ULL;
+	h ^= h >> 29;
+	return h;
+}
+
+/**
+ * @brief Calculates the slot of a nogood in the store.
+ */
+static unsigned int ng_slot(NGKind kind, Pnode* goal, Pnode* ctx,
+		uint64_t aux)
+{
+	uint64_t h;
+
+	h = mix_fp(kind, NODE_FP(goal));
+	h = mix_fp(h, NODE_FP(ctx));
+	h = mix_fp(h, aux);
+	h = mix_fp(h, bind_fp);
+
+	return (unsigned int) (h & (NG_SLOTS - 1));
+}
+
+/**
+ * @brief Initialises the nogood store (unless it has been disabled).
+ */
+void init_nogood()
+{
+	store = ng_disabled ? NULL : (Nogood*) calloc(NG_SLOTS, sizeof(Nogood));
+	scope = 1;
+	bind_fp = 0;
+}
+
+/**
+ * @brief Frees the nogood store.
+ */
+void free_nogood()
+{
+	free(store);
+	store = NULL;
+}
+
+/**
+ * @brief Invalidates all nogoods of kind NG_VQ (to be called, when the
+ * verification of another statement starts).
+ */
+void next_nogood_scope()
+{
+	scope++;
+}
+
+/**
+ * @brief Checks, whether a sub-goal is known to fail under the substitutions
+ * currently in place.
+ *
+ * @param kind kind of the sub-goal
+ * @param goal Pnode (or position) to be verified
+ * @param ctx context visible to the goal
+ * @param aux further state the goal depends on
+ *
+ * @return TRUE, if the goal is known to fail
+ */
+unsigned short int is_nogood(NGKind kind, Pnode* goal, Pnode* ctx,
+		uint64_t aux)
+{
+	Nogood* ng;
+
+	if (store == NULL) {
+		return FALSE;
+	}
+
+	ng = store + ng_slot(kind, goal, ctx, aux);
+
+	return (ng->kind == kind && ng->goal == goal && ng->ctx == ctx
+			&& ng->aux == aux && ng->bind == bind_fp
+			&& (kind != NG_VQ || ng->scope == scope));
+}
+
+/**
+ * @brief Remembers the failure of a sub-goal under the substitutions currently
+ * in place, replacing whatever nogood occupied the same slot.
+ *
+ * @param kind kind of the sub-goal
+ * @param goal Pnode (or position) which could not be verified
+ * @param ctx context visible to the goal
+ * @param aux further state the goal depends on
+ */
+void add_nogood(NGKind kind, Pnode* goal, Pnode* ctx, uint64_t aux)
+{
+	Nogood* ng;
+
+	if (store == NULL) {
+		return;
+	}
+
+	ng = store + ng_slot(kind, goal, ctx, aux);
+
+	ng->kind = kind;
+	ng->goal = goal;
+	ng->ctx = ctx;
+	ng->aux = aux;
+	ng->bind = bind_fp;
+	ng->scope = scope;
+}
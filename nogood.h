@@ -0,0 +1,58 @@
+/* [prove]: A proof verification system using bracketed expressions.
+ * Copyright (C) 2021  Gregor Feierabend
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef NOGOOD_H
+#define NOGOOD_H
+
+#include <stdint.h>
+#include "pgraph.h"
+
+/* number of slots in the nogood store (power of two) */
+#define NG_SLOTS 65536
+
+/* kinds of sub-goals, whose failures are remembered */
+typedef enum {
+	NG_NONE = 0,
+	NG_ASMP = 1,	/* assumption checked by check_asmp; valid for the whole
+					   file */
+	NG_VQ = 2,		/* level of vq_recurs; valid while the same statement is
+					   being verified */
+} NGKind;
+
+/* TRUE, if failures are not remembered (see "--nonogoods") */
+unsigned short int ng_disabled;
+
+/* fingerprint of all substitutions currently in place (maintained by sub_var
+ * and unsub_var) */
+uint64_t bind_fp;
+
+/* identity of a Pnode in fingerprints and hashes: unlike its address, the
+ * immutable node number is the same in every run, so that hits and evictions
+ * (and thus the effort counters) are reproducible */
+#define NODE_FP(p) ((p) != NULL ? (uint64_t) ((p)->num_c + 2) : 0)
+
+uint64_t mix_fp(uint64_t h, uint64_t v);
+
+void init_nogood();
+void free_nogood();
+void next_nogood_scope();
+
+unsigned short int is_nogood(NGKind kind, Pnode* goal, Pnode* ctx,
+		uint64_t aux);
+void add_nogood(NGKind kind, Pnode* goal, Pnode* ctx, uint64_t aux);
+
+#endif /* NOGOOD_H */
@@ -0,0 +1,722 @@
+/* [prove]: A proof verification system using bracketed expressions.
+ * Copyright (C) 2020-2021  Gregor Feierabend
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include "parser.h"
+#include "pscanner.h"
+#include "debug.h"
+#include "verify.h"
+#include "pgraph.h"
+#include "strategy.h"
+#include "perf.h"
+#include "cert.h"
+#include "module.h"
+#include "jobs.h"
+#include "error.h"
+
+/* --- preprocessor directives ---------------------------------------------- */
+#define TRUE 1
+#define FALSE 0
+
+#define NOVERINUM 0
+
+/* initial size of the stack of the parser functions */
+#define PARSE_FRAMES 64
+
+/* --- global variables ----------------------------------------------------- */
+
+#if 0
+char* toktype[] = {"TOK_EOF", "TOK_LBRACK", "TOK_RBRACK", "TOK_IMPLY",
+	"TOK_REF", "TOK_EQ", /*"TOK_NOT",*/ "TOK_SYM"};
+#endif
+char* toktype[] = {"end of file", "left bracket", "right bracket", "'=>'",
+	"'ref=>'", "'='", "string"};
+
+Token    token;                     /* current token						*/
+Pnode*   pnode;                     /* current node in graph				*/
+Pnode*   prev_node;					/* remember previous node for equalities*/
+
+static int lvl;                     /* level/depth of current node in tree	*/
+static unsigned short int resume;   /* TRUE, until the top level of a library
+									   is continued							*/
+
+static PFrame* frames;              /* stack of the parser functions		*/
+static int n_frames;
+static int size_frames;
+
+/* --- function prototypes -------------------------------------------------- */
+void parse_imports(void);
+void parse_expr(void);
+void call_frame(PState state, unsigned short int veri_ref);
+void end_frame(void);
+void parse_formula(PFrame* f);
+void parse_formula_next(PFrame* f);
+void finish_formulator(PFrame* f);
+void finish_statement(PFrame* f);
+void parse_statement(PFrame* f);
+void finish_list(PFrame* f);
+
+void expect(TType type);
+void check_conflict(Pnode* pnode, TType ttype);
+
+/* --- parser functions ----------------------------------------------------- */
+/**
+ * @brief Parses (and verifies, unless do_veri is FALSE) a [prove] source file.
+ * The nogood store has to be initialised by the caller. If a library has been
+ * loaded (see image.c) or the file imports modules (see module.c), the file is
+ * parsed as continuation of their top level.
+ *
+ * @param file [prove] source file
+ *
+ * @return root of the graph of Pnodes
+ */
+Pnode* parse_file(FILE* file)
+{
+	lvl = 0;
+
+	init_scanner(file);
+	if (prefix_last != NULL) {
+		/* the file continues the top level of the library */
+		scan_fp = prefix_fp;
+	}
+	next_token(&token);
+	parse_imports();
+
+	prev_node = NULL;
+	resume = (prefix_last != NULL);
+	if (resume) {
+		gflags = GFLAG_NONE;
+		set_node_count(prefix_count);
+		pnode = prefix_last;
+	} else {
+		init_pgraph(&pnode);
+	}
+	jobs_start(file);
+
+	parse_expr();
+	expect(TOK_EOF);
+	jobs_finish();
+
+	if (n_unknown > 0) {
+		fprintf(stderr, SHELL_RED "%lu %s not been verified (budget "
+				"exhausted)" SHELL_RESET1 "\n", n_unknown,
+				n_unknown == 1 ? "list has" : "lists have");
+		success = EXIT_FAILURE;
+	}
+
+	return pnode;
+}
+
+/**
+ * @brief Parses the import directives at the beginning of a file, i.e. lines
+ * of the form "import <path>", and loads the imported modules as library.
+ */
+void parse_imports(void)
+{
+	char** paths;
+	char* path;
+	int n;
+
+	paths = NULL;
+	n = 0;
+	while (token.type == TOK_SYM && strcmp(token.id, "import") == 0
+			&& (path = scan_path()) != NULL) {
+		paths = (char**) realloc(paths, (n + 1) * sizeof(char*));
+		paths[n] = (char*) malloc(strlen(path) + 1);
+		strcpy(paths[n], path);
+		n++;
+		next_token(&token);
+	}
+	if (n == 0) {
+		return;
+	}
+
+	if (!import_modules(paths, n, parse_source)) {
+		exit(EXIT_FAILURE);
+	}
+	while (n > 0) {
+		free(paths[--n]);
+	}
+	free(paths);
+
+	/* the file continues the top level of the modules */
+	scan_fp = prefix_fp;
+	hash_token(&token);
+}
+
+/**
+ * @brief parser function for <expr>
+ *
+ * <formula> and <statement> contain each other for every level of brackets.
+ * Instead of recursing, their parser functions are run on an explicit stack of
+ * frames, so that the depth of nesting is only limited by memory.
+ */
+void parse_expr(void)
+{
+	PFrame* f;
+	int base;
+
+	/* maybe the EBNF should be altered a bit,
+	 * this seems to be a bit non-sensical */
+	base = n_frames;
+	call_frame(PS_FORMULA, FALSE);
+
+	while (n_frames > base) {
+		f = &(frames[n_frames - 1]);
+		switch (f->state) {
+		case PS_FORMULA:
+			parse_formula(f);
+			break;
+		case PS_FORMULA_NEXT:
+			parse_formula_next(f);
+			break;
+		case PS_FORMULATOR_DONE:
+			finish_formulator(f);
+			break;
+		case PS_STATEMENT_DONE:
+			finish_statement(f);
+			break;
+		case PS_STATEMENT:
+			parse_statement(f);
+			break;
+		case PS_LIST_DONE:
+			finish_list(f);
+			break;
+		}
+	}
+
+	if (n_frames == 0) {
+		free(frames);
+		frames = NULL;
+		size_frames = 0;
+	}
+}
+
+/**
+ * @brief Calls a parser function, i.e. pushes its frame onto the stack (frames
+ * may be moved, i.e. pointers to frames are invalid afterwards).
+ *
+ * @param state state, in which the parser function begins
+ * @param veri_ref TRUE if "ref=>" formulator was used (see parse_statement)
+ */
+void call_frame(PState state, unsigned short int veri_ref)
+{
+	if (n_frames == size_frames) {
+		size_frames = size_frames == 0 ? PARSE_FRAMES : 2 * size_frames;
+		frames = (PFrame*) realloc(frames, sizeof(PFrame) * size_frames);
+	}
+	frames[n_frames].state = state;
+	frames[n_frames].veri_ref = veri_ref;
+	frames[n_frames].pexstart = NULL; /* NULLed to make sure that existence
+										 will only be verified on the same
+										 level */
+	n_frames++;
+}
+
+/**
+ * @brief Returns from the parser function of the frame on top of the stack.
+ */
+void end_frame(void)
+{
+	n_frames--;
+}
+
+/**
+ * @brief parser function for <formula> (up to its first statement)
+ *
+ * @param f frame of the formula
+ */
+void parse_formula(PFrame* f)
+{
+	f->veri_ref = FALSE;
+	
+	if (resume) {
+		/* the top level of the library is continued right after its last
+		 * statement (see below) */
+	} else if (token.type == TOK_SYM) {
+		set_symbol(pnode, token.id);	
+		DBG_PARSER(fprintf(stderr, "%s", *(pnode->symbol)););
+		next_token(&token);
+		if (token.type == TOK_RBRACK) {
+			/* token is an identifier */
+			end_frame();
+			return;
+		} else if (token.type == TOK_LBRACK /*|| token.type == TOK_NOT*/) {
+			/* token is a formulator */
+			/* ?check for conflicting flags and report ERROR */
+			SET_NFLAG_FMLA(pnode)
+			/* continue */
+		} else {
+			/* formulators must not be mixed/identifiers must not contain = */
+			/* ERROR */
+			end_frame();
+			return;
+		}
+	} else if (IS_IMPL_TYPE_TOK(token.type)) {
+		set_symbol(pnode, token.id);	
+		DBG_PARSER(fprintf(stderr, SHELL_CYAN "%s" SHELL_RESET1, recall_chars()););
+		DBG_PARSER(fprintf(stderr, "%s", token.id););
+		/* token is an implication symbol */
+		f->veri_ref = (token.type == TOK_REF);
+		next_token(&token);
+		DBG_PARSER(fprintf(stderr, SHELL_CYAN "%s" SHELL_RESET1, recall_chars()););
+		if (token.type == TOK_RBRACK) {
+			/* statements must not contain only an implication symbol */
+			/* ERROR */
+			end_frame();
+			return;
+		} else if (token.type == TOK_LBRACK /*|| token.type == TOK_NOT*/) {
+			/* only valid option */
+			SET_NFLAG_IMPL(pnode)
+			UNSET_NFLAG_FRST(pnode)
+			/* continue */
+		} else {
+			/* formulators must not be mixed/identifiers must not contain = */
+			/* ERROR */
+			end_frame();
+			return;
+		}
+	} else if (token.type == TOK_EQ) {
+		DBG_PARSER(fprintf(stderr, "%s", token.id););
+		/* statements must not begin with an equality token */
+		/* ERROR */
+		end_frame();
+		return;
+	} else if (token.type == TOK_LBRACK /*|| token.type == TOK_NOT*/) {
+		/* continue */
+	} else if (token.type == TOK_RBRACK) {
+		/* empty statement */
+		end_frame();
+		return;
+	} else {
+		/* cannot go here, undefined behaviour */
+		/* ERROR */
+		end_frame();
+		return;
+	}
+
+	f->state = PS_FORMULA_NEXT;
+}
+
+/**
+ * @brief parser function for <formula>: parses the next statement (preceded by
+ * a formulator or continuing the top level of a library)
+ *
+ * @param f frame of the formula
+ */
+void parse_formula_next(PFrame* f)
+{
+	unsigned short int veri_ref;
+
+	/* TODO perform some check for ERRORS (wrt to EQ and IMP positioning */
+	veri_ref = f->veri_ref;
+	f->veri_ref = FALSE;
+	if (IS_FORMULATOR(token.type) && !resume) {
+		DBG_PARSER(fprintf(stderr, "%s", token.id););
+		set_symbol(pnode, token.id);
+		check_conflict(pnode, token.type);
+
+		veri_ref = (token.type == TOK_REF);
+		next_token(&token);
+		f->state = PS_FORMULATOR_DONE;
+		call_frame(PS_STATEMENT, veri_ref);
+	} else {
+		f->state = PS_STATEMENT_DONE;
+		/* the last statement of a library has been parsed already */
+		if (resume) {
+			resume = FALSE;
+			if (token.type == TOK_LBRACK) {
+				call_frame(PS_STATEMENT, veri_ref);
+			}
+		} else {
+			call_frame(PS_STATEMENT, veri_ref);
+		}
+	}
+}
+
+/**
+ * @brief parser function for <formula>: continues after a statement, which
+ * followed a formulator
+ *
+ * @param f frame of the formula
+ */
+void finish_formulator(PFrame* f)
+{
+	if (!IS_FORMULATOR(token.type)) {
+		prev_node = NULL;
+		end_frame();
+	} else {
+		f->state = PS_FORMULA_NEXT;
+	}
+}
+
+/**
+ * @brief parser function for <formula>: continues after a statement, which
+ * may be followed by a formulator
+ *
+ * @param f frame of the formula
+ */
+void finish_statement(PFrame* f)
+{
+	if (!IS_FORMULATOR(token.type)) {
+		end_frame();
+		return;
+	}
+
+	DBG_PARSER(fprintf(stderr, "%s", token.id););
+
+	create_right(pnode);
+	move_right(&pnode);
+
+	check_conflict(pnode, token.type);
+	set_symbol(pnode, token.id);
+
+	f->veri_ref = (token.type == TOK_REF);
+	next_token(&token);
+	if (token.type != TOK_LBRACK /*&& token.type != TOK_NOT*/) {
+		prev_node = NULL;
+		end_frame();
+	} else {
+		f->state = PS_FORMULA_NEXT;
+	}
+}
+
+/**
+ * @brief parser function for <statement>: parses the beginning of the next
+ * bracketed list (up to its <expr>)
+ *
+ * @param f frame of the statement, holding veri_ref (TRUE if "ref=>" formulator
+ * was used, which suggests to search among ids before searching among all
+ * visible constants)
+ */
+void parse_statement(PFrame* f)
+{
+	lvl++;
+	if (lvl == 1) {
+		/* statements at the top level are distributed among the workers
+		 * or verified by the pipeline (see jobs.c) */
+		job_next();
+	}
+	DBG_PARSER(fprintf(stderr, SHELL_CYAN "%s" SHELL_RESET1,
+				recall_chars()););
+	DBG_PARSER(fprintf(stderr, "%s", token.id););
+
+	expect(TOK_LBRACK);
+	DBG_PARSER(fprintf(stderr, SHELL_CYAN "%s" SHELL_RESET1,
+				recall_chars()););
+	if (HAS_GFLAG_VRFD) {
+		UNSET_GFLAG_VRFD
+	}
+
+	if (HAS_CHILD(pnode) || HAS_SYMBOL(pnode)) {
+		create_right(pnode);
+		move_right(&pnode);
+	}
+	create_child(pnode);
+	move_down(&pnode);
+
+	f->state = PS_LIST_DONE;
+	call_frame(PS_FORMULA, FALSE);
+}
+
+/**
+ * @brief parser function for <statement>: finishes a bracketed list after its
+ * <expr> (and triggers verification after the last list)
+ *
+ * @param f frame of the statement
+ */
+void finish_list(PFrame* f)
+{
+	Pnode* ptmp;
+	int proceed;
+	unsigned short int found;		/* indicating whether an identifier has been
+									   found during backtracking */
+	unsigned short int verified;	/* indicating whether the list has been
+									   verified */
+
+	proceed = TRUE;
+	found = FALSE;
+
+	DBG_PARSER(fprintf(stderr, SHELL_CYAN "%s" SHELL_RESET1,
+				recall_chars()););
+	DBG_PARSER(fprintf(stderr, "%s", token.id););
+	expect(TOK_RBRACK);
+	lvl--;
+
+	move_and_sum_up(&pnode);
+
+	if (HAS_NFLAG_EQTY(pnode)) {
+		/* TODO: add FATAL ERROR, if inexistent */
+		prev_node = pnode->left->left; 
+	}
+
+	/* check whether a new identifier was introduced */
+	if (CONTAINS_ID(pnode)) {
+		ptmp = pnode->prev_const;
+		while (ptmp != NULL) {
+			if (CONTAINS_ID(ptmp)) {
+				if (strcmp(*((*(ptmp->child))->symbol),
+							*((*(pnode->child))->symbol)) == 0) {
+					found = TRUE;
+					/*equate(ptmp, pnode);*/
+					free(*((*(pnode->child))->symbol));
+					free((*(pnode->child))->symbol);
+					(*(pnode->child))->symbol =
+						(*(ptmp->child))->symbol;
+					(*(pnode->child))->child =
+						(*(ptmp->child))->child;
+					(*(pnode->child))->right =
+						(*(ptmp->child))->right;
+					break;
+				}
+			}
+			ptmp = ptmp->prev_const;
+		}
+
+		if (found == FALSE) {
+			DBG_PARSER(fprintf(stderr, SHELL_MAGENTA "*" SHELL_RESET1);)
+
+			SET_NFLAG_NEWC(pnode)
+
+			(*(pnode->child))->child =
+				(Pnode**) malloc(sizeof(struct Pnode*));
+			*((*(pnode->child))->child) = NULL;
+			(*(pnode->child))->right =
+				(Pnode**) malloc(sizeof(struct Pnode*));
+			*((*(pnode->child))->right) = NULL;
+		}
+	}
+
+	/* postpone verification for existence */
+	/* FIXME: put this at a better place */
+	if (pnode->left != NULL && HAS_SYMBOL(pnode->left) && !HAS_GFLAG_VRFD &&
+			HAS_NFLAG_IMPL(pnode) && !HAS_NFLAG_ASMP(pnode)
+				&& !HAS_GFLAG_PSTP) {
+		SET_GFLAG_PSTP
+		f->pexstart = pnode;
+		DBG_VERIFY(fprintf(stderr, SHELL_BOLD "{%d}>"
+					SHELL_RESET2, pnode->num););
+	}
+
+	/* TODO: handle equalities */
+	if (HAS_NFLAG_EQTY(pnode)) {
+		/*equate(prev_node, pnode);*/
+		prev_node = pnode;
+	}
+
+	/* FIXME: Has this become redundant? */
+#if 0
+	if (HAS_NFLAG_IMPL(pnode) && !HAS_NFLAG_ASMP(pnode)
+			&& !HAS_GFLAG_VRFD && !HAS_GFLAG_PSTP) {
+		/* universal verification is triggered here */
+		if (pnode->num > NOVERINUM && /* DEBUG!!!! */
+				do_veri && !verify_universal(pnode)) {
+			fprintf(stderr,
+					SHELL_RED
+					"verification failed on line %d, column %d"
+					SHELL_RESET1
+					"\n",
+					 cursor.line, cursor.col);
+			if (!DBG_FINISH_IS_SET) {
+				exit(EXIT_FAILURE);
+			} else {
+				success = EXIT_FAILURE;
+			}
+		}
+	}
+#endif
+
+	if (token.type != TOK_LBRACK /*&& token.type != TOK_NOT*/) {
+		proceed = FALSE;
+
+		/* trigger quantifier verification here */
+		if (HAS_NFLAG_IMPL(pnode) && !HAS_NFLAG_ASMP(pnode)
+				&& HAS_GFLAG_PSTP && f->pexstart != NULL) {
+			DBG_VERIFY(
+					if (pnode->num != f->pexstart->num) {
+						fprintf(stderr, SHELL_BOLD "<{%d}" SHELL_RESET2,
+							pnode->num);
+					} else {
+						fprintf(stderr, SHELL_BOLD "|" SHELL_RESET2);
+					}
+			);
+			create_right_dummy(pnode);
+
+			/* "reference implication" is a hint only: the id-only search
+			 * is completed before falling back to a full search, but the
+			 * meaning of the implication is not changed */
+			if (f->veri_ref) {
+				DBG_PARSER(fprintf(stderr, SHELL_MAGENTA "<REF>"
+							SHELL_RESET1);)
+			}
+
+			/* verification functions are tried in the order of the
+			 * strategy pipeline (see strategy.c), unless a certificate
+			 * is replayed, the list is found in the cache (see
+			 * cert.c) or it is verified by another process (see
+			 * jobs.c) */
+			verified = TRUE;
+			if (pnode->num > NOVERINUM && /* DEBUG!!!! */ do_veri
+					&& !job_remote(cursor.line, cursor.col, &verified)) {
+				perf_start();
+				start_budget();
+				if (do_replay) {
+					verified = cert_replay(pnode, f->pexstart, cursor.line,
+							cursor.col);
+				} else if (!cache_lookup(pnode, f->pexstart, &verified)) {
+					verified = run_strategies(pnode, f->pexstart, f->veri_ref,
+							lvl == 0);
+				}
+				perf_finish(cursor.line, cursor.col, verified, lvl == 0,
+						budget_exhausted, st_solved);
+				cert_finish(cursor.line, cursor.col, verified, st_solved);
+				job_report();
+			}
+			if (!verified && budget_exhausted) {
+				/* the outcome is unknown, the file is not verified, but
+				 * the list is assumed for the rest of the file */
+				fprintf(stderr,
+						SHELL_BROWN
+						"verification on line %d, column %d unknown "
+						"(budget exhausted)"
+						SHELL_RESET1
+						"\n",
+						cursor.line, cursor.col);
+				n_unknown++;
+				budget_exhausted = FALSE;
+			} else if (!verified) {
+				if (lvl != 0) {
+					fprintf(stderr,
+							SHELL_BROWN
+							"<verification postponed to parent level>"
+							SHELL_RESET1
+							"\n");
+				} else {
+					fprintf(stderr,
+							SHELL_RED
+							"verification failed on line %d, column %d"
+							SHELL_RESET1
+							"\n",
+							cursor.line, cursor.col);
+					if (!DBG_FINISH_IS_SET) {
+						exit(EXIT_FAILURE);
+					} else {
+						success = EXIT_FAILURE;
+					}
+				}
+			}	
+			free_right_dummy(pnode);
+
+			UNSET_GFLAG_PSTP
+		}
+	}
+	DBG_PARSER(fprintf(stderr, SHELL_CYAN "%s" SHELL_RESET1,
+				recall_chars());); 
+
+	if (proceed) {
+		f->state = PS_STATEMENT;
+	} else {
+		end_frame();
+	}
+}
+
+/* --- helpers -------------------------------------------------------------- */
+
+/**
+ * @brief Checks, whether the current token is of desired type and reports an
+ * error otherwise.
+ *
+ * @param type type of the current token
+ */
+void expect(TType type)
+{
+	if (token.type == type) {
+		next_token(&token);
+	} else {
+		/* ERROR (after the results of the statements before, see jobs.c) */
+		job_sync();
+		fprintf(stderr, "unexpected token on line %d, column %d; expected %s, "
+				"but found %s\n",
+				 cursor.line, cursor.col, toktype[type], toktype[token.type]);
+		exit(ERR_SYNTAX);
+	}
+}/*}}}*/
+
+/**
+ * @brief Checks whether the current formulator type is conflicting with other
+ * formulators in the currently processed formula.
+ *
+ * @param pnode pointer to current node
+ * @param ttype type of currently processed token
+ */
+void check_conflict(Pnode* pnode, TType ttype)
+{
+	if (IS_IMPL_TYPE_TOK(ttype)) {
+		/* indent assumptions in debugging output to improve readability */
+		/* OUTPUT DBG_PARSER(if (!HAS_NFLAG_ASMP(pnode)) {
+			fprintf(stderr, "\n");
+			for (int i = 0; i < lvl; i++ ) {
+				fprintf(stderr, "\t");
+			}
+		}); */
+
+		if (!HAS_FFLAGS(pnode)) {
+			SET_NFLAG_IMPL(pnode)
+		} else if (HAS_NFLAG_IMPL(pnode)) {
+			return;
+		} else {
+			job_sync();
+			/*fprintf(stderr, "unexpected IMPL_TYPE_TOK "*/
+			fprintf(stderr, "unexpected implication token "
+				"on line %d, column %d\n", cursor.line, cursor.col);
+			exit(ERR_SYNTAX);
+		}
+	} else if (ttype == TOK_EQ) {
+		if (!HAS_FFLAGS(pnode)) {
+			SET_NFLAG_EQTY(pnode)
+			prev_node = pnode->left; /* TODO: add FATAL ERROR, if inexistent */
+		} else if (HAS_NFLAG_EQTY(pnode)) {
+			/* TODO: maybe only allow equalities of the form [...]=[...] */
+			return;
+		} else {
+			job_sync();
+			/*fprintf(stderr, "unexpected TOK_EQ "*/
+			fprintf(stderr, "unexpected '=' "
+				"on line %d, column %d\n", cursor.line, cursor.col);
+			exit(ERR_SYNTAX);
+		}
+	} else if (ttype == TOK_SYM) {
+		if (!HAS_FFLAGS(pnode)) {
+			SET_NFLAG_FMLA(pnode)
+		} else if (HAS_NFLAG_FMLA(pnode)) {
+			return;
+		} else {
+			job_sync();
+			/*fprintf(stderr, "unexpected TOK_SYM "*/
+			fprintf(stderr, "unexpected string "
+				"on line %d, column %d\n", cursor.line, cursor.col);
+			exit(ERR_SYNTAX);
+		}
+	} else {
+		job_sync();
+		fprintf(stderr, "unexpected error "
+			"on line %d, column %d\n", cursor.line, cursor.col);
+		exit(ERR_SYNTAX);
+	}
+}/*}}}*/
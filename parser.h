@@ -0,0 +1,61 @@
+/* [prove]: A proof verification system using bracketed expressions.
+ * Copyright (C) 2020-2021  Gregor Feierabend
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PARSER_H
+#define PARSER_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "pgraph.h"
+
+/* states of the parser functions (see parse_expr) */
+typedef enum {
+	PS_FORMULA = 0,		/* <formula> begins */
+	PS_FORMULA_NEXT,	/* next statement of <formula> */
+	PS_FORMULATOR_DONE,	/* statement following a formulator has been parsed */
+	PS_STATEMENT_DONE,	/* statement has been parsed */
+	PS_STATEMENT,		/* next bracketed list of <statement> */
+	PS_LIST_DONE,		/* <expr> of a bracketed list has been parsed */
+} PState;
+
+/* frame of a parser function, i.e. of a <formula> or a <statement> */
+typedef struct parse_frame {
+	PState state;
+	unsigned short int veri_ref;	/* TRUE if "ref=>" formulator was used */
+	Pnode* pexstart;				/* first node for verifying existence (of
+									   a statement) */
+} PFrame;
+
+/* FALSE, if statements are only parsed (not verified) */
+unsigned short int do_veri;
+/* exit status of the verification */
+unsigned short int success;
+
+/* last top-level Pnode of a precompiled library, which precedes the parsed
+ * file (NULL if none), the fingerprint of its tokens and its number of Pnodes
+ * (see image.c) */
+Pnode* prefix_last;
+uint64_t prefix_fp;
+int prefix_count;
+
+/* name of the parsed file, relative to which imports are resolved (NULL for
+ * the current directory) */
+char* parse_source;
+
+Pnode* parse_file(FILE* file);
+
+#endif /* PARSER_H */
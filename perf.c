@@ -0,0 +1,408 @@
+/* [prove]: A proof verification system using bracketed expressions.
+ * Copyright (C) 2021  Gregor Feierabend
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+#include "perf.h"
+
+/* --- preprocessor directives ---------------------------------------------- */
+#define TRUE 1
+#define FALSE 0
+
+/* initial number of records */
+#define PERF_RECORDS 256
+
+/* --- global variables ----------------------------------------------------- */
+static PerfRecord* records = NULL;
+static int n_records = 0;
+static int size_records = 0;
+
+static ProfFormat profile = PROF_NONE;
+static char* profile_file = NULL;	/* source file named in the profile */
+
+static struct timespec wall_start;
+static struct timespec cpu_start;
+
+/* hardware counters: file descriptors (-1 if unavailable), values at the
+ * start of the current statement and sums over all verified statements */
+static int hw_fd[HW_COUNTERS] = {-1, -1, -1, -1, -1};
+static unsigned short int hw_active = FALSE;
+static uint64_t hw_start[HW_COUNTERS];
+static uint64_t hw_verify[HW_COUNTERS];
+static char* hw_name[HW_COUNTERS] = {"cycles", "instructions", "L1d-misses",
+	"LLC-misses", "branch-misses"};
+
+/* --- performance counters ------------------------------------------------- */
+/**
+ * @brief Selects the format of the per-statement profile.
+ *
+ * @param format name of the format (currently only "json")
+ *
+ * @return FALSE, if the format is unknown
+ */
+unsigned short int set_profile(char* format)
+{
+	if (strcmp(format, "json") == 0) {
+		profile = PROF_JSON;
+	} else {
+		return FALSE;
+	}
+	return TRUE;
+}
+
+/**
+ * @brief Sets the name of the source file to be named in the profile.
+ *
+ * @param filename name of the source file
+ */
+void perf_source(char* filename)
+{
+	profile_file = filename;
+}
+
+/**
+ * @brief Returns the nanoseconds elapsed on a clock since a point in time.
+ *
+ * @param clock clock to be read
+ * @param start point in time
+ *
+ * @return elapsed nanoseconds
+ */
+uint64_t elapsed_ns(clockid_t clock, struct timespec* start)
+{
+	struct timespec now;
+
+	clock_gettime(clock, &now);
+	return (uint64_t) (now.tv_sec - start->tv_sec) * 1000000000ULL
+		+ now.tv_nsec - start->tv_nsec;
+}
+
+/**
+ * @brief Writes a string as JSON string to a stream.
+ *
+ * @param out stream
+ * @param str string to be written
+ */
+void fprint_json_str(FILE* out, char* str)
+{
+	putc('"', out);
+	for (; *str != '\0'; str++) {
+		if (*str == '"' || *str == '\\') {
+			fprintf(out, "\\%c", *str);
+		} else if ((unsigned char) *str < 0x20) {
+			fprintf(out, "\\u%04x", *str);
+		} else {
+			putc(*str, out);
+		}
+	}
+	putc('"', out);
+}
+
+/**
+ * @brief Prints a string as JSON string.
+ *
+ * @param str string to be printed
+ */
+void print_json_str(char* str)
+{
+	fprint_json_str(stdout, str);
+}
+
+/**
+ * @brief Prints a record of the profile as JSON object on a single line.
+ *
+ * @param r record to be printed
+ */
+void print_json_record(PerfRecord* r)
+{
+	printf("{\"file\":");
+	print_json_str(profile_file != NULL ? profile_file : "");
+	printf(",\"line\":%d,\"col\":%d,\"result\":\"%s\",\"strategy\":",
+			r->line, r->col, r->verified ? "verified"
+			: (r->exhausted ? "unknown"
+				: (r->toplevel ? "failed" : "postponed")));
+	if (r->strategy != NULL) {
+		print_json_str(r->strategy);
+	} else {
+		printf("null");
+	}
+	printf(",\"wall_ns\":%llu,\"cpu_ns\":%llu,\"comparisons\":%llu,"
+			"\"substitutions\":%llu,\"max_depth\":%llu,\"vq_recurs\":%llu,"
+			"\"asmp_lookups\":%llu,\"branches\":%llu,"
+			"\"nogoods\":%llu}\n",
+			(unsigned long long) r->wall_ns,
+			(unsigned long long) r->cpu_ns,
+			(unsigned long long) r->perf.comparisons,
+			(unsigned long long) r->perf.substitutions,
+			(unsigned long long) r->perf.max_depth,
+			(unsigned long long) r->perf.vq_calls,
+			(unsigned long long) r->perf.asmp_lookups,
+			(unsigned long long) r->perf.branches,
+			(unsigned long long) r->perf.nogoods);
+}
+
+/* --- hardware counters --------------------------------------------------- */
+/**
+ * @brief Opens the hardware performance counters of the process (user space
+ * only, so that a restrictive perf_event_paranoid setting is sufficient).
+ * Counters, which are not supported, are skipped.
+ *
+ * @return FALSE, if no counter is available
+ */
+unsigned short int hw_open()
+{
+#ifdef __linux__
+	static const uint32_t type[HW_COUNTERS] = {PERF_TYPE_HARDWARE,
+		PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE, PERF_TYPE_HARDWARE,
+		PERF_TYPE_HARDWARE};
+	static const uint64_t config[HW_COUNTERS] = {PERF_COUNT_HW_CPU_CYCLES,
+		PERF_COUNT_HW_INSTRUCTIONS,
+		PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+			| (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+		PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+	struct perf_event_attr attr;
+	int i;
+
+	for (i = 0; i < HW_COUNTERS; i++) {
+		memset(&attr, 0, sizeof(struct perf_event_attr));
+		attr.size = sizeof(struct perf_event_attr);
+		attr.type = type[i];
+		attr.config = config[i];
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+
+		hw_fd[i] = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+		if (hw_fd[i] != -1) {
+			hw_active = TRUE;
+		}
+	}
+
+	if (!hw_active) {
+		fprintf(stderr, "hardware counters are not available (%s)\n",
+				strerror(errno));
+	}
+#else
+	fprintf(stderr, "hardware counters are not supported on this system\n");
+#endif
+	memset(hw_verify, 0, sizeof(hw_verify));
+	return hw_active;
+}
+
+/**
+ * @brief Reads the current values of all hardware counters (0 for
+ * unavailable ones).
+ *
+ * @param values array of HW_COUNTERS values to be filled
+ */
+void hw_read(uint64_t* values)
+{
+	int i;
+
+	for (i = 0; i < HW_COUNTERS; i++) {
+		if (hw_fd[i] == -1 || read(hw_fd[i], &values[i], sizeof(uint64_t))
+				!= sizeof(uint64_t)) {
+			values[i] = 0;
+		}
+	}
+}
+
+/**
+ * @brief Prints the hardware counters spent in verification and in the rest
+ * of the program (i.e. mostly parsing) and closes them.
+ */
+void print_hw_stats()
+{
+	uint64_t total[HW_COUNTERS];
+	int i;
+
+	if (!hw_active) {
+		return;
+	}
+	hw_read(total);
+
+	fprintf(stderr, "%-16s %16s %16s\n", "hw counter", "parse", "verify");
+	for (i = 0; i < HW_COUNTERS; i++) {
+		if (hw_fd[i] == -1) {
+			fprintf(stderr, "%-16s %16s %16s\n", hw_name[i], "n/a", "n/a");
+		} else {
+			fprintf(stderr, "%-16s %16llu %16llu\n", hw_name[i],
+					(unsigned long long) (total[i] - hw_verify[i]),
+					(unsigned long long) hw_verify[i]);
+			close(hw_fd[i]);
+			hw_fd[i] = -1;
+		}
+	}
+	hw_active = FALSE;
+}
+
+/**
+ * @brief Resets the counters and clocks before a statement is verified.
+ */
+void perf_start()
+{
+	memset(&perf, 0, sizeof(Perf));
+	if (hw_active) {
+		hw_read(hw_start);
+	}
+	clock_gettime(CLOCK_MONOTONIC, &wall_start);
+	clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &cpu_start);
+}
+
+/**
+ * @brief Stores the counters of a statement, after it has been verified, and
+ * adds it to the profile.
+ *
+ * @param line line of the statement in the source file
+ * @param col column of the statement in the source file
+ * @param verified TRUE, if verification was successful
+ * @param toplevel TRUE, if the statement is at the top level of the file
+ * @param exhausted TRUE, if the budget of the statement has run out
+ * @param strategy name of the strategy, which verified the statement (NULL if
+ * none)
+ */
+void perf_finish(int line, int col, unsigned short int verified,
+		unsigned short int toplevel, unsigned short int exhausted,
+		char* strategy)
+{
+	PerfRecord r;
+	uint64_t hw_now[HW_COUNTERS];
+	int i;
+
+	if (hw_active) {
+		hw_read(hw_now);
+		for (i = 0; i < HW_COUNTERS; i++) {
+			hw_verify[i] += hw_now[i] - hw_start[i];
+		}
+	}
+
+	r.wall_ns = elapsed_ns(CLOCK_MONOTONIC, &wall_start);
+	r.cpu_ns = elapsed_ns(CLOCK_PROCESS_CPUTIME_ID, &cpu_start);
+	r.line = line;
+	r.col = col;
+	r.verified = verified;
+	r.toplevel = toplevel;
+	r.exhausted = exhausted && !verified;
+	r.strategy = strategy;
+	r.perf = perf;
+	perf_add(&r);
+}
+
+/**
+ * @brief Adds the record of a statement to the profile (e.g. a record of
+ * another process, see jobs.c).
+ *
+ * @param r record of the statement
+ */
+void perf_add(PerfRecord* r)
+{
+	if (n_records == size_records) {
+		size_records = size_records == 0 ? PERF_RECORDS : 2 * size_records;
+		records = (PerfRecord*) realloc(records,
+				sizeof(PerfRecord) * size_records);
+	}
+	records[n_records++] = *r;
+
+	if (profile == PROF_JSON) {
+		print_json_record(r);
+	}
+}
+
+/**
+ * @brief Gets the record of the statement, which has been verified last.
+ *
+ * @return record of the statement or NULL, if there is none
+ */
+PerfRecord* perf_last()
+{
+	return n_records > 0 ? &(records[n_records - 1]) : NULL;
+}
+
+/**
+ * @brief Prints the counters of every verified statement and their totals.
+ */
+void print_perf_stats()
+{
+	Perf total;
+	Perf* p;
+	uint64_t wall_ns;
+	struct rusage usage;
+	int i;
+
+	memset(&total, 0, sizeof(Perf));
+	wall_ns = 0;
+
+	fprintf(stderr, "%-12s %-8s %10s %12s %10s %6s %10s %10s %10s %8s\n",
+			"statement", "strategy", "time [us]", "comparisons", "subst",
+			"depth", "vq_recurs", "asmp", "branches", "nogoods");
+	for (i = 0; i < n_records; i++) {
+		p = &(records[i].perf);
+		fprintf(stderr, "%5d:%-6d %-8s %10llu %12llu %10llu %6llu %10llu "
+				"%10llu %10llu %8llu\n", records[i].line, records[i].col,
+				records[i].strategy != NULL ? records[i].strategy
+				: (records[i].exhausted ? "unknown" : "failed"),
+				(unsigned long long) records[i].wall_ns / 1000,
+				(unsigned long long) p->comparisons,
+				(unsigned long long) p->substitutions,
+				(unsigned long long) p->max_depth,
+				(unsigned long long) p->vq_calls,
+				(unsigned long long) p->asmp_lookups,
+				(unsigned long long) p->branches,
+				(unsigned long long) p->nogoods);
+
+		wall_ns += records[i].wall_ns;
+		total.comparisons += p->comparisons;
+		total.substitutions += p->substitutions;
+		if (p->max_depth > total.max_depth) {
+			total.max_depth = p->max_depth;
+		}
+		total.vq_calls += p->vq_calls;
+		total.asmp_lookups += p->asmp_lookups;
+		total.branches += p->branches;
+		total.nogoods += p->nogoods;
+	}
+	fprintf(stderr, "%-12s %-8s %10llu %12llu %10llu %6llu %10llu %10llu "
+			"%10llu %8llu\n", "total", "", (unsigned long long) wall_ns / 1000,
+			(unsigned long long) total.comparisons,
+			(unsigned long long) total.substitutions,
+			(unsigned long long) total.max_depth,
+			(unsigned long long) total.vq_calls,
+			(unsigned long long) total.asmp_lookups,
+			(unsigned long long) total.branches,
+			(unsigned long long) total.nogoods);
+
+	getrusage(RUSAGE_SELF, &usage);
+	fprintf(stderr, "peak RSS [kB]: %ld\n", usage.ru_maxrss);
+}
+
+/**
+ * @brief Frees the stored records.
+ */
+void free_perf()
+{
+	free(records);
+	records = NULL;
+	n_records = size_records = 0;
+}
@@ -0,0 +1,90 @@
+/* [prove]: A proof verification system using bracketed expressions.
+ * Copyright (C) 2021  Gregor Feierabend
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PERF_H
+#define PERF_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+/* performance counters (always compiled in) */
+typedef struct perf_counters {
+	uint64_t comparisons;	/* calls of const_equal */
+	uint64_t substitutions;	/* substitutions made by init_sub and next_sub */
+	uint64_t max_depth;		/* maximal depth of the BC stack */
+	uint64_t vq_calls;		/* calls of vq_recurs */
+	uint64_t asmp_lookups;	/* calls of check_asmp */
+	uint64_t branches;		/* branches explored */
+	uint64_t nogoods;		/* sub-goals known to fail (see nogood.h) */
+} Perf;
+
+/* counters of a single verified statement */
+typedef struct perf_record {
+	int line;
+	int col;
+	unsigned short int verified;
+	unsigned short int toplevel;	/* FALSE, if failure postpones verification
+									   to the parent level */
+	unsigned short int exhausted;	/* TRUE, if the outcome is unknown, as the
+									   budget has run out (see strategy.c) */
+	char* strategy;			/* strategy, which verified the statement */
+	uint64_t wall_ns;		/* wall clock time */
+	uint64_t cpu_ns;		/* CPU time of the process */
+	Perf perf;
+} PerfRecord;
+
+/* formats of the per-statement profile */
+typedef enum {
+	PROF_NONE = 0,
+	PROF_JSON = 1,	/* one JSON object per line on stdout */
+} ProfFormat;
+
+/* hardware performance counters (read via perf_event_open, if available) */
+typedef enum {
+	HW_CYCLES = 0,
+	HW_INSTRUCTIONS,
+	HW_L1D_MISSES,
+	HW_LLC_MISSES,
+	HW_BRANCH_MISSES,
+	HW_COUNTERS,		/* number of hardware counters */
+} HWCounter;
+
+/* counters of the statement currently being verified */
+Perf perf;
+
+#define PERF_INC(counter) perf.counter++;
+#define PERF_MAX(counter, value) \
+	if ((uint64_t) (value) > perf.counter) { perf.counter = (value); }
+
+unsigned short int set_profile(char* format);
+void perf_source(char* filename);
+
+void perf_start();
+void perf_finish(int line, int col, unsigned short int verified,
+		unsigned short int toplevel, unsigned short int exhausted,
+		char* strategy);
+void perf_add(PerfRecord* r);
+PerfRecord* perf_last();
+void print_perf_stats();
+void free_perf();
+void fprint_json_str(FILE* out, char* str);
+void print_json_str(char* str);
+
+unsigned short int hw_open();
+void print_hw_stats();
+
+#endif /* PERF_H */
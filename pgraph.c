@@ -30,7 +30,12 @@
 
 #define DO(x) ((x) || TRUE)
 
-static short int n = 0;		/* node counter */
+static int n = 0;		/* node counter */
+
+/* memory, which is part of the graph, but not owned by it (e.g. a mapped
+ * library image) */
+static char* foreign_lo = NULL;
+static char* foreign_hi = NULL;
 
 
 /* --- navigation through graph --------------------------------------------- */
@@ -127,7 +132,8 @@ void init_pgraph(Pnode** root)
 	*root = (Pnode*) malloc(sizeof(struct Pnode));
 
 	(*root)->parent = //(*root)->above =
-		(*root)->left = (*root)->prev_const = (*root)->prev_id = NULL;
+		(*root)->left = (*root)->prev_const = (*root)->prev_id =
+		(*root)->prev_eq = NULL;
 	(*root)->child = (*root)->right = NULL;
 	(*root)->symbol = NULL;
 	(*root)->flags = NFLAG_FRST | NFLAG_TRUE;
@@ -174,6 +180,7 @@ void create_child(Pnode* pnode)
 	}
 	child->prev_const = pnode->prev_const;
 	child->prev_id = pnode->prev_id;
+	child->prev_eq = pnode->prev_eq;
 
 	TIKZ(fprintf(tikz, TIKZ_CHILDNODE(pnode->num, n));
 	fprintf(tikz, TIKZ_CHILDARROW(pnode->num, n));
@@ -217,6 +224,7 @@ void create_right(Pnode* pnode)
 	right->flags = pnode->flags; /* | NFLAG_TRUE; */
 	UNSET_NFLAG_NEWC(right)
 	UNSET_NFLAG_FRST(right) /* TODO this can be done better */
+	UNSET_NFLAG_CLSD(right)
 	if (!HAS_FFLAGS(pnode)) {
 		SET_NFLAG_FRST(pnode) /* FRST flag is not set for identifiers (i.e. when
 								 no right node is created, but it is not needed
@@ -234,6 +242,14 @@ void create_right(Pnode* pnode)
 		right->prev_const = pnode->prev_const;
 	}
 
+	/* Constant equalities are additionally linked, such that the equalities
+	 * known from a certain perspective can be found quickly. */
+	if (pnode->vtree == NULL && !HAS_SYMBOL(pnode) && IS_EQUALITY(pnode)) {
+		right->prev_eq = pnode;
+	} else {
+		right->prev_eq = pnode->prev_eq;
+	}
+
 	if (HAS_NFLAG_NEWC(pnode)) {
 		/* This will result in duplicates, but we are lazy.
 		 * It also enables us to "hint" the software, which substitutions
@@ -300,6 +316,7 @@ void create_right_dummy(Pnode* pnode)
 	right->flags = pnode->flags; /* | NFLAG_TRUE; */
 	UNSET_NFLAG_NEWC(right)
 	UNSET_NFLAG_FRST(right) /* TODO this can be done better */
+	UNSET_NFLAG_CLSD(right)
 
 	/* If the current node has no variable children and is no formulator,
 	 * let it be the "previous constant" for the next node (linked list). */
@@ -312,6 +329,14 @@ void create_right_dummy(Pnode* pnode)
 		right->prev_const = pnode->prev_const;
 	}
 
+	/* Constant equalities are additionally linked, such that the equalities
+	 * known from a certain perspective can be found quickly. */
+	if (pnode->vtree == NULL && !HAS_SYMBOL(pnode) && IS_EQUALITY(pnode)) {
+		right->prev_eq = pnode;
+	} else {
+		right->prev_eq = pnode->prev_eq;
+	}
+
 	right->prev_id = pnode->prev_id;
 
 	/* All nodes are assumptions in "locked" subtrees. */
@@ -402,6 +427,7 @@ void move_and_sum_up(Pnode** pnode)
 	if ((*pnode)->parent != NULL) {
 		*pnode = (*pnode)->parent;
 		(*pnode)->vtree = vtree;
+		SET_NFLAG_CLSD((*pnode))
 	}
 }
 /**
@@ -487,6 +513,17 @@ int get_node_count() {
 	return n;
 }
 
+/**
+ * @brief Sets the node counter (e.g. after loading a library, so that node
+ * numbers continue those of the library).
+ *
+ * @param count new value of the node counter
+ */
+void set_node_count(int count)
+{
+	n = count;
+}
+
 #ifdef DTIKZ
 /**
  * @brief Add flags to TIKZ graph; to be called when freeing the graph.
@@ -527,6 +564,32 @@ void print_flags(Pnode* pnode) {
 #endif
 
 /* --- memory deallocation -------------------------------------------------- */
+/**
+ * @brief Sets the range of memory, which is part of the graph, but must not be
+ * freed by free_graph.
+ *
+ * @param lo beginning of the range
+ * @param hi end of the range
+ */
+void set_foreign(void* lo, void* hi)
+{
+	foreign_lo = (char*) lo;
+	foreign_hi = (char*) hi;
+}
+
+/**
+ * @brief Frees memory of the graph, unless it is foreign.
+ *
+ * @param ptr memory to be freed
+ */
+static void release(void* ptr)
+{
+	if ((char*) ptr >= foreign_lo && (char*) ptr < foreign_hi) {
+		return;
+	}
+	free(ptr);
+}
+
 /**
  * @brief Frees a graph of Pnodes.
  *
@@ -555,11 +618,11 @@ void free_graph(Pnode* pnode)
 		)
 
 		if (pnode->parent != NULL && HAS_NFLAG_NEWC(pnode->parent)) {
-			free(*(pnode->symbol));
-			free(pnode->symbol);
+			release(*(pnode->symbol));
+			release(pnode->symbol);
 
-			free(pnode->child);
-			free(pnode->right);
+			release(pnode->child);
+			release(pnode->right);
 		}
 
 		/* TODO: free linked list of variables */
@@ -569,13 +632,13 @@ void free_graph(Pnode* pnode)
 
 		if (pnode->left != NULL) {
 			move_left(&pnode);
-			free(*(pnode->right));
-			free(pnode->right);
+			release(*(pnode->right));
+			release(pnode->right);
 			pnode->right = NULL;
 		} else if (pnode->parent != NULL) {
 			move_up(&pnode);
-			free(*(pnode->child));
-			free(pnode->child);
+			release(*(pnode->child));
+			release(pnode->child);
 			pnode->child = NULL;
 		}
 	}
@@ -587,7 +650,7 @@ void free_graph(Pnode* pnode)
 		free(pnode->var);
 	}*/
 
-	free(pnode);
+	release(pnode);
 
 	TIKZ(fprintf(tikz, TIKZ_ENDSCOPE);)
 }
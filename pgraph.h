@@ -83,6 +83,8 @@ typedef enum {
 	NFLAG_NEWC = 32,
 	NFLAG_FRST = 64,
 	NFLAG_TRUE = 128,
+	NFLAG_CLSD = 256, /* statement has been closed, i.e. will not change
+						 anymore (apart from substitution) */
 } NFlags;
 
 #define HAS_NFLAG_IMPL(pnode) (pnode->flags & NFLAG_IMPL)
@@ -93,6 +95,7 @@ typedef enum {
 #define HAS_NFLAG_NEWC(pnode) (pnode->flags & NFLAG_NEWC)
 #define HAS_NFLAG_FRST(pnode) (pnode->flags & NFLAG_FRST)
 #define HAS_NFLAG_TRUE(pnode) (pnode->flags & NFLAG_TRUE)
+#define HAS_NFLAG_CLSD(pnode) (pnode->flags & NFLAG_CLSD)
 
 #define SET_NFLAG_IMPL(pnode) pnode->flags |= NFLAG_IMPL;
 #define SET_NFLAG_EQTY(pnode) pnode->flags |= NFLAG_EQTY;
@@ -102,12 +105,14 @@ typedef enum {
 #define SET_NFLAG_NEWC(pnode) pnode->flags |= NFLAG_NEWC;
 #define SET_NFLAG_FRST(pnode) pnode->flags |= NFLAG_FRST;
 #define SET_NFLAG_TRUE(pnode) pnode->flags |= NFLAG_TRUE;
+#define SET_NFLAG_CLSD(pnode) pnode->flags |= NFLAG_CLSD;
 
 #define UNSET_NFLAG_ASMP(pnode) pnode->flags &= ~NFLAG_ASMP;
 #define UNSET_NFLAG_NEWC(pnode) pnode->flags &= ~NFLAG_NEWC;
 #define UNSET_NFLAG_LOCK(pnode) pnode->flags &= ~NFLAG_LOCK;
 #define UNSET_NFLAG_FRST(pnode) pnode->flags &= ~NFLAG_FRST;
 #define UNSET_NFLAG_TRUE(pnode) pnode->flags &= ~NFLAG_TRUE;
+#define UNSET_NFLAG_CLSD(pnode) pnode->flags &= ~NFLAG_CLSD;
 
 #define TOGGLE_NFLAG_TRUE(pnode) \
 	if (HAS_NFLAG_TRUE(pnode)) UNSET_NFLAG_TRUE(pnode)\
@@ -130,6 +135,7 @@ typedef struct Pnode {
 
 	struct Pnode* prev_const; /* link to previous constant sub-tree */
 	struct Pnode* prev_id; /* link to previous constant id */
+	struct Pnode* prev_eq; /* link to previous constant equality */
 
 	VTree* vtree;
 
@@ -150,6 +156,9 @@ typedef struct Pnode {
 #define IS_EMPTY(pnode) \
 	(!HAS_CHILD(pnode) && !HAS_SYMBOL(pnode))
 #define IS_INTERNAL(pnode) (pnode->symbol == NULL)
+#define IS_EQUALITY(pnode) \
+	(HAS_CHILD(pnode) && HAS_NFLAG_EQTY((*(pnode->child))) \
+	 && !HAS_NFLAG_IMPL((*(pnode->child))))
 
 /* ------------------------------- FUNCTIONS -------------------------------- */
 
@@ -179,5 +188,7 @@ VTree* pos_in_vtree(VTree* vtree);
 VTree* next_var(VTree* vtree);
 
 int get_node_count();
+void set_node_count(int count);
+void set_foreign(void* lo, void* hi);
 
 #endif
@@ -22,49 +22,40 @@
 #include <sys/stat.h>
 #include <unistd.h>
 #include <libgen.h>
-#include "pscanner.h"
+#include "parser.h"
 #include "debug.h"
-#include "verify.h"
 #include "pgraph.h"
+#include "nogood.h"
+#include "reach.h"
+#include "strategy.h"
+#include "perf.h"
+#include "cert.h"
+#include "serve.h"
+#include "image.h"
+#include "jobs.h"
+#include "shard.h"
 #include "error.h"
 
-#ifdef DGMP
-#include <gmp.h>
-#endif
-
 /* --- preprocessor directives ---------------------------------------------- */
 #define TRUE 1
 #define FALSE 0
 
-#define NOVERINUM 0
-
 /* --- global variables ----------------------------------------------------- */
-
-#if 0
-char* toktype[] = {"TOK_EOF", "TOK_LBRACK", "TOK_RBRACK", "TOK_IMPLY",
-	"TOK_REF", "TOK_EQ", /*"TOK_NOT",*/ "TOK_SYM"};
-#endif
-char* toktype[] = {"end of file", "left bracket", "right bracket", "'=>'",
-	"'ref=>'", "'='", "string"};
-
-Token    token;                     /* current token						*/
-Pnode*   pnode;                     /* current node in graph				*/
-Pnode*   prev_node;					/* remember previous node for equalities*/
 FILE*    file;                      /* [prove] source file					*/
 
-static unsigned short int lvl;      /* level/depth of current node in tree	*/
-
+unsigned short int stats = FALSE;
+unsigned short int hwcounters = FALSE;
+unsigned short int do_serve = FALSE;
+char* socket_path = NULL;
+char* image_file = NULL;
+char* coordinator = NULL;			/* address of the coordinator (for workers) */
+char* coordinating = NULL;			/* address, on which workers are accepted */
+int n_shards = 1;
+char** files = NULL;				/* files to be distributed among workers */
+int n_files = 0;
 
 /* --- function prototypes -------------------------------------------------- */
-void parse_expr(void);
-void parse_formula(void);
-void parse_statement(unsigned short int veri_ref);
-
-void expect(TType type);
-void check_conflict(Pnode* pnode, TType ttype);
-
-unsigned short int success = EXIT_SUCCESS;
-unsigned short int do_veri = TRUE;
+void print_stats(void);
 
 /**
  * @brief main function of the [prove]-parser
@@ -78,6 +69,8 @@ int main(int argc, char *argv[])
 {
 	struct stat st = {0};			/* for checking directory existence */
 	unsigned short int i;
+	Pnode* root;						/* root of the graph */
+	char* end;
 
 	dbgops = DBG_NONE;
 #ifdef DTIKZ
@@ -86,6 +79,8 @@ int main(int argc, char *argv[])
 #endif
 
 	file = NULL;
+	do_veri = TRUE;
+	success = EXIT_SUCCESS;
 
 	if (argc < 2) {
 		fprintf(stderr, USAGE, argv[0]);
@@ -149,8 +144,114 @@ int main(int argc, char *argv[])
 				SET_DBG_COMPLETE
 				SET_DBG_FINISH
 				SET_DBG_VERIFY
+			} else if (strcmp(argv[i], "--nonogoods") == 0) {
+				ng_disabled = TRUE;
+			} else if (strcmp(argv[i], "--notraces") == 0) {
+				tr_disabled = TRUE;
+			} else if (strncmp(argv[i], "--dsteps=", 9) == 0) {
+				vq_steps = strtol(argv[i] + 9, &end, 10);
+				if (argv[i][9] == '\0' || *end != '\0' || argv[i][9] == '-'
+						|| vq_steps < 1) {
+					fprintf(stderr, "invalid number of units '%s'\n",
+							argv[i] + 9);
+					exit(EXIT_FAILURE);
+				}
 			} else if (strcmp(argv[i], "--noveri") == 0) {
 				do_veri = FALSE;
+			} else if (strncmp(argv[i], "--strategies=", 13) == 0) {
+				if (!set_strategies(argv[i] + 13)) {
+					fprintf(stderr, "try '--help'\n" USAGE, argv[0]);
+					exit(EXIT_FAILURE);
+				}
+			} else if (strncmp(argv[i], "--budget=", 9) == 0) {
+				if (!set_budget(argv[i] + 9)) {
+					fprintf(stderr, "try '--help'\n" USAGE, argv[0]);
+					exit(EXIT_FAILURE);
+				}
+			} else if (strcmp(argv[i], "--stats") == 0) {
+				stats = TRUE;
+			} else if (strcmp(argv[i], "--hwcounters") == 0) {
+				hwcounters = TRUE;
+			} else if (strncmp(argv[i], "--cert=", 7) == 0) {
+				if (do_replay) {
+					fprintf(stderr, "'--cert' cannot be combined with "
+							"'--replay'\n");
+					exit(EXIT_FAILURE);
+				}
+				if (!cert_open(argv[i] + 7)) {
+					fprintf(stderr, "error opening '%s'\n", argv[i] + 7);
+					exit(EXIT_FAILURE);
+				}
+			} else if (strncmp(argv[i], "--replay=", 9) == 0) {
+				if (do_cert) {
+					fprintf(stderr, "'%s' cannot be combined with "
+							"'--replay'\n", do_cache ? "--cache" : "--cert");
+					exit(EXIT_FAILURE);
+				}
+				if (!cert_load(argv[i] + 9)) {
+					exit(EXIT_FAILURE);
+				}
+			} else if (strncmp(argv[i], "--cache=", 8) == 0) {
+				if (do_replay) {
+					fprintf(stderr, "'--cache' cannot be combined with "
+							"'--replay'\n");
+					exit(EXIT_FAILURE);
+				}
+				if (!cache_open(argv[i] + 8)) {
+					fprintf(stderr, "error opening cache directory '%s'\n",
+							argv[i] + 8);
+					exit(EXIT_FAILURE);
+				}
+			} else if (strncmp(argv[i], "--compile=", 10) == 0) {
+				image_file = argv[i] + 10;
+			} else if (strncmp(argv[i], "--library=", 10) == 0) {
+				if (prefix_last != NULL) {
+					fprintf(stderr, "only one library can be loaded\n");
+					exit(EXIT_FAILURE);
+				}
+				if (!image_load(argv[i] + 10)) {
+					exit(EXIT_FAILURE);
+				}
+			} else if (strcmp(argv[i], "--jobs") == 0) {
+				n_jobs = sysconf(_SC_NPROCESSORS_ONLN);
+			} else if (strncmp(argv[i], "--jobs=", 7) == 0) {
+				n_jobs = strtol(argv[i] + 7, &end, 10);
+				if (argv[i][7] == '\0' || *end != '\0' || n_jobs < 1) {
+					fprintf(stderr, "invalid number of jobs '%s'\n",
+							argv[i] + 7);
+					exit(EXIT_FAILURE);
+				}
+			} else if (strcmp(argv[i], "--pipeline") == 0) {
+				n_pipeline = sysconf(_SC_NPROCESSORS_ONLN);
+			} else if (strncmp(argv[i], "--pipeline=", 11) == 0) {
+				n_pipeline = strtol(argv[i] + 11, &end, 10);
+				if (argv[i][11] == '\0' || *end != '\0' || n_pipeline < 1) {
+					fprintf(stderr, "invalid number of statements '%s'\n",
+							argv[i] + 11);
+					exit(EXIT_FAILURE);
+				}
+			} else if (strncmp(argv[i], "--coordinate=", 13) == 0) {
+				coordinating = argv[i] + 13;
+			} else if (strncmp(argv[i], "--shards=", 9) == 0) {
+				n_shards = strtol(argv[i] + 9, &end, 10);
+				if (argv[i][9] == '\0' || *end != '\0' || n_shards < 1) {
+					fprintf(stderr, "invalid number of shards '%s'\n",
+							argv[i] + 9);
+					exit(EXIT_FAILURE);
+				}
+			} else if (strncmp(argv[i], "--worker=", 9) == 0) {
+				coordinator = argv[i] + 9;
+			} else if (strcmp(argv[i], "--serve") == 0) {
+				do_serve = TRUE;
+			} else if (strncmp(argv[i], "--serve=", 8) == 0) {
+				do_serve = TRUE;
+				socket_path = argv[i] + 8;
+			} else if (strncmp(argv[i], "--profile=", 10) == 0) {
+				if (!set_profile(argv[i] + 10)) {
+					fprintf(stderr, "unknown profile format '%s', try "
+							"'--help'\n" USAGE, argv[i] + 10, argv[0]);
+					exit(EXIT_FAILURE);
+				}
 			} else if (argv[i][0] == '-' && argv[i][1] == '-') {
 				fprintf(stderr, "unknown argument '%s', try '--help'\n"
 						USAGE, argv[i], argv[0]);
@@ -160,31 +261,98 @@ int main(int argc, char *argv[])
 					fprintf(stderr, "error opening '%s'\n", argv[i]);
 					exit(EXIT_FAILURE);
 				}
+				perf_source(argv[i]);
+				parse_source = argv[i];
+				files = argv + i;
+				n_files = 1;
+			} else if (files + n_files == argv + i) {
+				/* further files are only accepted by the coordinator */
+				n_files++;
 			} else {
-				fprintf(stderr,
-						"Currently [prove] only supports opening one file at "
-						"a time. Refused to open '%s'.\n", argv[i]);
+				fprintf(stderr, "the files have to be given one after "
+						"another\n");
 				exit(EXIT_FAILURE);
 			}
 		}
 	}
 
+	if (n_files > 1 && coordinating == NULL) {
+		fprintf(stderr,
+				"Currently [prove] only supports opening one file at "
+				"a time. Refused to open '%s'.\n", files[1]);
+		exit(EXIT_FAILURE);
+	}
+
+	/* workers verify the shards sent by the coordinator (see shard.c) with
+	 * their own options */
+	if (coordinator != NULL) {
+		if (file != NULL || do_serve || coordinating != NULL || do_cert
+				|| do_replay || n_jobs > 1 || n_pipeline > 0
+				|| image_file != NULL) {
+			fprintf(stderr, "'--worker' cannot be combined with a file, "
+					"'--serve', '--coordinate', '--cert', '--replay', "
+					"'--jobs', '--pipeline' or '--compile'\n");
+			exit(EXIT_FAILURE);
+		}
+		return work(coordinator) ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
+	/* in server mode, the files are sent by the clients (see serve.c) */
+	if (do_serve) {
+		if (file != NULL || do_replay || (do_cert && !do_cache)
+				|| n_jobs > 1 || n_pipeline > 0) {
+			fprintf(stderr, "'--serve' cannot be combined with a file, "
+					"'--cert', '--replay', '--jobs' or '--pipeline'\n");
+			exit(EXIT_FAILURE);
+		}
+		return serve(socket_path) ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
+	/* the coordinator only collects the results of the workers */
+	if (coordinating != NULL) {
+		if (file == NULL || do_serve || do_replay || do_cache || n_jobs > 1
+				|| n_pipeline > 0 || hwcounters || image_file != NULL
+				|| prefix_last != NULL || !do_veri) {
+			fprintf(stderr, "'--coordinate' requires a file and cannot be "
+					"combined with '--serve', '--replay', '--cache', "
+					"'--jobs', '--pipeline', '--hwcounters', '--compile', "
+					"'--library' or '--noveri'\n");
+			exit(EXIT_FAILURE);
+		}
+		if (do_cert && n_files > 1) {
+			fprintf(stderr, "'--cert' requires a single file\n");
+			exit(EXIT_FAILURE);
+		}
+		if (stats) {
+			atexit(print_stats);
+		}
+		fclose(file);
+		if (!coordinate(coordinating, files, n_files, n_shards)) {
+			exit(EXIT_FAILURE);
+		}
+		cert_close();
+		return success;
+	}
+
+	/* workers verify every n-th statement and the pipeline verifies ahead of
+	 * parsing (see jobs.c), which is not supported by replayed certificates
+	 * and hardware counters */
+	if ((n_jobs > 1 || n_pipeline > 0) && (do_replay || hwcounters)) {
+		fprintf(stderr, "'%s' cannot be combined with '--replay' or "
+				"'--hwcounters'\n", n_jobs > 1 ? "--jobs" : "--pipeline");
+		exit(EXIT_FAILURE);
+	}
+	if (n_jobs > 1 && n_pipeline > 0) {
+		fprintf(stderr, "'--jobs' cannot be combined with '--pipeline'\n");
+		exit(EXIT_FAILURE);
+	}
+
 	TIKZ(
 		if (stat("debug", &st) == -1) {
 			mkdir("debug", 0700);
 		}
 	)
 
-	lvl = 0;
-
-#ifdef DGMP
-	mpz_init(comp_count);
-	mpz_set_ui(comp_count,0);
-#endif
-
-	init_scanner(file);
-	next_token(&token);
-
 	TIKZ(tikzfile = (char*) malloc(strlen(basename(argv[1]))
 				* (sizeof(char) + 5));
 	filename = basename(argv[1]);
@@ -196,29 +364,49 @@ int main(int argc, char *argv[])
 	}
 	fprintf(tikz, TIKZ_HEADER TIKZ_LGND TIKZ_GRAPHSCOPE);)
 
-	prev_node = NULL;
-	init_pgraph(&pnode);
+	/* statistics are also printed, when verification fails (handlers are
+	 * called in reverse order) */
+	if (hwcounters && hw_open()) {
+		atexit(print_hw_stats);
+	}
+	if (stats) {
+		atexit(print_stats);
+	}
+
+	init_nogood();
 
-	parse_expr();
-	expect(TOK_EOF);
+	root = parse_file(file);
 
 	TIKZ(fprintf(tikz, TIKZ_ENDSCOPE);)
 
-	free_graph(pnode);
+	/* only verified libraries are compiled */
+	if (image_file != NULL) {
+		if (!do_veri || success != EXIT_SUCCESS) {
+			fprintf(stderr, "'%s' has not been written, as the file has not "
+					"been verified\n", image_file);
+			success = EXIT_FAILURE;
+		} else if (!image_write(image_file, root)) {
+			fprintf(stderr, "error writing '%s'\n", image_file);
+			success = EXIT_FAILURE;
+		}
+	}
+
+	free_graph(root);
+	image_close();
+	if (!cert_close()) {
+		fprintf(stderr, SHELL_RED "certificate has records of lists, which "
+				"have not been verified" SHELL_RESET1 "\n");
+		exit(EXIT_FAILURE);
+	}
+	free_nogood();
 
 	TIKZ(fprintf(tikz, TIKZ_ENDPIC TIKZ_FOOTER);
 	fclose(tikz);)
 
 	fclose(file);
 
-	fprintf(stderr, SHELL_CYAN "Nodes in tree:\t%d",
+	fprintf(stderr, SHELL_CYAN "Nodes in tree:\t%d\n" SHELL_RESET1,
 			get_node_count());
-#ifdef DGMP
-	fprintf(stderr, "\nNodes compared:\t");
-	mpz_out_str(stderr, 10, comp_count);
-	mpz_clear(comp_count);
-#endif
-	fprintf(stderr, "\n" SHELL_RESET1);
 
 	if (!do_veri) {
 		return EXIT_SUCCESS;
@@ -227,412 +415,16 @@ int main(int argc, char *argv[])
 	}
 }/*}}}*/
 
-/* --- parser functions ----------------------------------------------------- */
-/**
- * @brief parser function for <expr>
- */
-void parse_expr(void)
-{
-	/* maybe the EBNF should be altered a bit,
-	 * this seems to be a bit non-sensical */
-	parse_formula();
-}
-
 /**
- * @brief parser function for <formula>
+ * @brief Prints statistics of the verification (registered by "--stats").
  */
-void parse_formula(void)
+void print_stats(void)
 {
-	int proceed;
-	unsigned short int veri_ref;
-
-	veri_ref = FALSE;
-	
-	if (token.type == TOK_SYM) {
-		set_symbol(pnode, token.id);	
-		DBG_PARSER(fprintf(stderr, "%s", *(pnode->symbol)););
-		next_token(&token);
-		if (token.type == TOK_RBRACK) {
-			/* token is an identifier */
-			return;
-		} else if (token.type == TOK_LBRACK /*|| token.type == TOK_NOT*/) {
-			/* token is a formulator */
-			/* ?check for conflicting flags and report ERROR */
-			SET_NFLAG_FMLA(pnode)
-			/* continue */
-		} else {
-			/* formulators must not be mixed/identifiers must not contain = */
-			/* ERROR */
-			return;
-		}
-	} else if (IS_IMPL_TYPE_TOK(token.type)) {
-		set_symbol(pnode, token.id);	
-		DBG_PARSER(fprintf(stderr, SHELL_CYAN "%s" SHELL_RESET1, recall_chars()););
-		DBG_PARSER(fprintf(stderr, "%s", token.id););
-		/* token is an implication symbol */
-		veri_ref = (token.type == TOK_REF);
-		next_token(&token);
-		DBG_PARSER(fprintf(stderr, SHELL_CYAN "%s" SHELL_RESET1, recall_chars()););
-		if (token.type == TOK_RBRACK) {
-			/* statements must not contain only an implication symbol */
-			/* ERROR */
-			return;
-		} else if (token.type == TOK_LBRACK /*|| token.type == TOK_NOT*/) {
-			/* only valid option */
-			SET_NFLAG_IMPL(pnode)
-			UNSET_NFLAG_FRST(pnode)
-			/* continue */
-		} else {
-			/* formulators must not be mixed/identifiers must not contain = */
-			/* ERROR */
-			return;
-		}
-	} else if (token.type == TOK_EQ) {
-		DBG_PARSER(fprintf(stderr, "%s", token.id););
-		/* statements must not begin with an equality token */
-		/* ERROR */
-		return;
-	} else if (token.type == TOK_LBRACK /*|| token.type == TOK_NOT*/) {
-		/* continue */
-	} else if (token.type == TOK_RBRACK) {
-		/* empty statement */
-		return;
-	} else {
-		/* cannot go here, undefined behaviour */
-		/* ERROR */
-		return;
-	}
-
-	proceed = TRUE;
-
-	/* TODO perform some check for ERRORS (wrt to EQ and IMP positioning */
-	while (proceed) {
-		if (IS_FORMULATOR(token.type)) {
-			DBG_PARSER(fprintf(stderr, "%s", token.id););
-			set_symbol(pnode, token.id);
-			check_conflict(pnode, token.type);
-
-			veri_ref = (token.type == TOK_REF);
-			next_token(&token);
-			parse_statement(veri_ref);
-			veri_ref = FALSE;
-			if (!IS_FORMULATOR(token.type)) {
-				proceed = FALSE;
-			}
-		} else {
-			parse_statement(veri_ref);
-			veri_ref = FALSE;
-			if (!IS_FORMULATOR(token.type)) {
-				return;
-			} else {
-				DBG_PARSER(fprintf(stderr, "%s", token.id););
-
-				create_right(pnode);
-				move_right(&pnode);
-
-				check_conflict(pnode, token.type);
-				set_symbol(pnode, token.id);
-
-				veri_ref = (token.type == TOK_REF);
-				next_token(&token);
-				if (token.type != TOK_LBRACK /*&& token.type != TOK_NOT*/) {
-					proceed = FALSE;
-				}
-			}
-		}
-	}
-	prev_node = NULL;
-}
-
-/**
- * @brief parser function for <statement>
- *
- * @param veri_ref TRUE if "ref=>" formulator was used; FIXME: currently
- * enforces id-only substitution, but should just "suggest"
- */
-void parse_statement(unsigned short int veri_ref)
-{
-	Pnode* ptmp;
-	Pnode* pexstart;				/* to remember first node for verifying
-									   existence */
-	int proceed;
-	unsigned short int found;		/* indicating whether an identifier has been
-									   found during backtracking */
-
-	proceed = TRUE;
-
-	pexstart = NULL; /* NULLed to make sure that existence will only be
-						verified on the same level */
-
-	while (proceed) {
-		found = FALSE;
-		lvl++;
-		DBG_PARSER(fprintf(stderr, SHELL_CYAN "%s" SHELL_RESET1,
-					recall_chars()););
-		DBG_PARSER(fprintf(stderr, "%s", token.id););
-
-		expect(TOK_LBRACK);
-		DBG_PARSER(fprintf(stderr, SHELL_CYAN "%s" SHELL_RESET1,
-					recall_chars()););
-		if (HAS_GFLAG_VRFD) {
-			UNSET_GFLAG_VRFD
-		}
-
-		if (HAS_CHILD(pnode) || HAS_SYMBOL(pnode)) {
-			create_right(pnode);
-			move_right(&pnode);
-		}
-		create_child(pnode);
-		move_down(&pnode);
-
-		parse_expr();
-
-		DBG_PARSER(fprintf(stderr, SHELL_CYAN "%s" SHELL_RESET1,
-					recall_chars()););
-		DBG_PARSER(fprintf(stderr, "%s", token.id););
-		expect(TOK_RBRACK);
-		lvl--;
-
-		move_and_sum_up(&pnode);
-
-		if (HAS_NFLAG_EQTY(pnode)) {
-			/* TODO: add FATAL ERROR, if inexistent */
-			prev_node = pnode->left->left; 
-		}
-
-		/* check whether a new identifier was introduced */
-		if (CONTAINS_ID(pnode)) {
-			ptmp = pnode->prev_const;
-			while (ptmp != NULL) {
-				if (CONTAINS_ID(ptmp)) {
-					if (strcmp(*((*(ptmp->child))->symbol),
-								*((*(pnode->child))->symbol)) == 0) {
-						found = TRUE;
-						/*equate(ptmp, pnode);*/
-						free(*((*(pnode->child))->symbol));
-						free((*(pnode->child))->symbol);
-						(*(pnode->child))->symbol =
-							(*(ptmp->child))->symbol;
-						(*(pnode->child))->child =
-							(*(ptmp->child))->child;
-						(*(pnode->child))->right =
-							(*(ptmp->child))->right;
-						break;
-					}
-				}
-				ptmp = ptmp->prev_const;
-			}
-
-			if (found == FALSE) {
-				DBG_PARSER(fprintf(stderr, SHELL_MAGENTA "*" SHELL_RESET1);)
-
-				SET_NFLAG_NEWC(pnode)
-
-				(*(pnode->child))->child =
-					(Pnode**) malloc(sizeof(struct Pnode*));
-				*((*(pnode->child))->child) = NULL;
-				(*(pnode->child))->right =
-					(Pnode**) malloc(sizeof(struct Pnode*));
-				*((*(pnode->child))->right) = NULL;
-			}
-		}
-
-		/* postpone verification for existence */
-		/* FIXME: put this at a better place */
-		if (pnode->left != NULL && HAS_SYMBOL(pnode->left) && !HAS_GFLAG_VRFD &&
-				HAS_NFLAG_IMPL(pnode) && !HAS_NFLAG_ASMP(pnode)
-					&& !HAS_GFLAG_PSTP) {
-			SET_GFLAG_PSTP
-			pexstart = pnode;
-			DBG_VERIFY(fprintf(stderr, SHELL_BOLD "{%d}>"
-						SHELL_RESET2, pnode->num););
-		}
-
-		/* TODO: handle equalities */
-		if (HAS_NFLAG_EQTY(pnode)) {
-			/*equate(prev_node, pnode);*/
-			prev_node = pnode;
-		}
-
-		/* FIXME: Has this become redundant? */
-#if 0
-		if (HAS_NFLAG_IMPL(pnode) && !HAS_NFLAG_ASMP(pnode)
-				&& !HAS_GFLAG_VRFD && !HAS_GFLAG_PSTP) {
-			/* universal verification is triggered here */
-			if (pnode->num > NOVERINUM && /* DEBUG!!!! */
-					do_veri && !verify_universal(pnode)) {
-				fprintf(stderr,
-						SHELL_RED
-						"verification failed on line %d, column %d"
-						SHELL_RESET1
-						"\n",
-						 cursor.line, cursor.col);
-				if (!DBG_FINISH_IS_SET) {
-					exit(EXIT_FAILURE);
-				} else {
-					success = EXIT_FAILURE;
-				}
-			}
-		}
-#endif
-
-		if (token.type != TOK_LBRACK /*&& token.type != TOK_NOT*/) {
-			proceed = FALSE;
-
-			/* trigger quantifier verification here */
-			if (HAS_NFLAG_IMPL(pnode) && !HAS_NFLAG_ASMP(pnode)
-					&& HAS_GFLAG_PSTP && pexstart != NULL) {
-				DBG_VERIFY(
-						if (pnode->num != pexstart->num) {
-							fprintf(stderr, SHELL_BOLD "<{%d}" SHELL_RESET2,
-								pnode->num);
-						} else {
-							fprintf(stderr, SHELL_BOLD "|" SHELL_RESET2);
-						}
-				);
-				create_right_dummy(pnode);
-
-				/* TODO: Introduce precedence for verification functions.
-				 * Implement this through an array of function pointers.
-				 * Currently "reference implication" _enforces_ id-only
-				 * substitution, but it should be handled as a _hint_ only
-				 * without changing the actual meaning of an implication. */
-				if (veri_ref) {
-					DBG_PARSER(fprintf(stderr, SHELL_MAGENTA "<REF>"
-								SHELL_RESET1);)
-				}
-
-				if (pnode->num > NOVERINUM && /* DEBUG!!!! */
-					do_veri && !verify_quantifiers(*(pnode->right), pexstart,
-						veri_ref)) {
-					if (lvl != 0) {
-						fprintf(stderr,
-								SHELL_BROWN
-								"<verification postponed to parent level>"
-								SHELL_RESET1
-								"\n");
-					} else {
-						/* TODO: Try different verification strategies here.
-						 * Next strategy to implement: Consideration of cases.
-						 **/
-						if (pnode->num != pexstart->num) {
-							fprintf(stderr,
-									SHELL_RED
-									"verification failed on line %d, column %d"
-									SHELL_RESET1
-									"\n",
-									cursor.line, cursor.col);
-							if (!DBG_FINISH_IS_SET) {
-								exit(EXIT_FAILURE);
-							} else {
-								success = EXIT_FAILURE;
-							}
-						} else {
-							fprintf(stderr,
-									SHELL_BROWN
-									"<trying case-based verification>"
-									SHELL_RESET1);
-							if (!verify_cases(pnode)) {
-								fprintf(stderr,
-										SHELL_RED
-										"verification failed on line %d, "
-										"column %d" SHELL_RESET1 "\n",
-										cursor.line, cursor.col);
-								if (!DBG_FINISH_IS_SET) {
-									exit(EXIT_FAILURE);
-								} else {
-									success = EXIT_FAILURE;
-								}
-							}
-						}
-					}
-				}	
-				free_right_dummy(pnode);
-
-				UNSET_GFLAG_PSTP
-			}
-		}
-		DBG_PARSER(fprintf(stderr, SHELL_CYAN "%s" SHELL_RESET1,
-					recall_chars());); 
+	print_strategy_stats();
+	if (cache_hits + cache_misses > 0) {
+		fprintf(stderr, "cache: %lu hits, %lu misses\n", cache_hits,
+				cache_misses);
 	}
+	print_perf_stats();
+	free_perf();
 }
-
-/* --- helpers -------------------------------------------------------------- */
-
-/**
- * @brief Checks, whether the current token is of desired type and reports an
- * error otherwise.
- *
- * @param type type of the current token
- */
-void expect(TType type)
-{
-	if (token.type == type) {
-		next_token(&token);
-	} else {
-		/* ERROR */
-		fprintf(stderr, "unexpected token on line %d, column %d; expected %s, "
-				"but found %s\n",
-				 cursor.line, cursor.col, toktype[type], toktype[token.type]);
-		exit(ERR_SYNTAX);
-	}
-}/*}}}*/
-
-/**
- * @brief Checks whether the current formulator type is conflicting with other
- * formulators in the currently processed formula.
- *
- * @param pnode pointer to current node
- * @param ttype type of currently processed token
- */
-void check_conflict(Pnode* pnode, TType ttype)
-{
-	if (IS_IMPL_TYPE_TOK(ttype)) {
-		/* indent assumptions in debugging output to improve readability */
-		/* OUTPUT DBG_PARSER(if (!HAS_NFLAG_ASMP(pnode)) {
-			fprintf(stderr, "\n");
-			for (int i = 0; i < lvl; i++ ) {
-				fprintf(stderr, "\t");
-			}
-		}); */
-
-		if (!HAS_FFLAGS(pnode)) {
-			SET_NFLAG_IMPL(pnode)
-		} else if (HAS_NFLAG_IMPL(pnode)) {
-			return;
-		} else {
-			/*fprintf(stderr, "unexpected IMPL_TYPE_TOK "*/
-			fprintf(stderr, "unexpected implication token "
-				"on line %d, column %d\n", cursor.line, cursor.col);
-			exit(ERR_SYNTAX);
-		}
-	} else if (ttype == TOK_EQ) {
-		if (!HAS_FFLAGS(pnode)) {
-			SET_NFLAG_EQTY(pnode)
-			prev_node = pnode->left; /* TODO: add FATAL ERROR, if inexistent */
-		} else if (HAS_NFLAG_EQTY(pnode)) {
-			/* TODO: maybe only allow equalities of the form [...]=[...] */
-			return;
-		} else {
-			/*fprintf(stderr, "unexpected TOK_EQ "*/
-			fprintf(stderr, "unexpected '=' "
-				"on line %d, column %d\n", cursor.line, cursor.col);
-			exit(ERR_SYNTAX);
-		}
-	} else if (ttype == TOK_SYM) {
-		if (!HAS_FFLAGS(pnode)) {
-			SET_NFLAG_FMLA(pnode)
-		} else if (HAS_NFLAG_FMLA(pnode)) {
-			return;
-		} else {
-			/*fprintf(stderr, "unexpected TOK_SYM "*/
-			fprintf(stderr, "unexpected string "
-				"on line %d, column %d\n", cursor.line, cursor.col);
-			exit(ERR_SYNTAX);
-		}
-	} else {
-		fprintf(stderr, "unexpected error "
-			"on line %d, column %d\n", cursor.line, cursor.col);
-		exit(ERR_SYNTAX);
-	}
-}/*}}}*/
@@ -21,14 +21,20 @@
 #include <string.h>
 #include <stdio.h>
 #include "pscanner.h"
+#include "jobs.h"
 #include "token.h"
 #include "debug.h"
+#include "error.h"
 
 #define TRUE 1
 #define FALSE 0
 
 #define SKIP_BUFFER 4096
 
+/* parameters of the FNV-1a hash of the scanned tokens */
+#define FNV_OFFSET 0xcbf29ce484222325ULL
+#define FNV_PRIME 0x100000001b3ULL
+
 static FILE *file;  /* [prove] source file                */
 static int   col;   /* column number of current character */
 static int   ch;    /* current character                  */
@@ -41,6 +47,7 @@ static void next_char(void); /* advances the "cursor" to the next character */
 /* reads an identifier for a <symbol> or <operand> and stores it to token->id */
 static void process_string(Token *token);
 
+
 /**
  * @brief Initialises the scanner.
  *
@@ -51,6 +58,7 @@ void init_scanner(FILE *f)
 	file = f;
 	cursor.line = 1;
 	cursor.col = 0;
+	scan_fp = FNV_OFFSET;
 	next_char();
 }
 
@@ -100,6 +108,7 @@ void next_token(Token *token)
 				skip_char();
 			}
 			next_token(token);
+			return;
 		} else if (isalpha(ch) || isdigit(ch) || isspecial(ch)) {
 			/* process a <string> */
 			token->type = TOK_SYM;
@@ -137,15 +146,68 @@ void next_token(Token *token)
 				break;
 			default:
 				cursor.col = col;
-				/* ERROR */
+				/* ERROR (after the results of the statements before, see
+				 * jobs.c) */
+				job_sync();
 				fprintf(stderr, "illegal character '%c' at line %d, column %d\n",
 						ch, cursor.line, cursor.col);
-				exit(EXIT_FAILURE);
+				exit(ERR_SYNTAX);
 				token->type = TOK_EOF;
 		}
 	} else {
 		token->type = TOK_EOF;
 	}
+
+	hash_token(token);
+}
+
+/**
+ * @brief Adds a token to the fingerprint of the scanned prefix.
+ *
+ * @param token pointer to token structure
+ */
+void hash_token(Token *token)
+{
+	char* c;
+
+	scan_fp = (scan_fp ^ (unsigned char) token->type) * FNV_PRIME;
+	if (token->type == TOK_SYM) {
+		for (c = token->id; *c != '\0'; c++) {
+			scan_fp = (scan_fp ^ (unsigned char) *c) * FNV_PRIME;
+		}
+		/* separates adjacent symbols */
+		scan_fp = (scan_fp ^ 0xff) * FNV_PRIME;
+	}
+}
+
+/**
+ * @brief Reads the path of an import directive (i.e. the rest of the current
+ * line, excluding comments) after the token "import".
+ *
+ * @return path or NULL, if the line does not continue with a path (nothing
+ * but blanks has been consumed in this case)
+ */
+char* scan_path()
+{
+	static char path[PATH_MAX];
+	int i;
+
+	while (ch == ' ' || ch == '\t') {
+		skip_char();
+	}
+	if (ch == EOF || ch == '\n' || ch == '#' || ch == '[' || ch == ']') {
+		return NULL;
+	}
+
+	for (i = 0; ch != EOF && ch != '\n' && ch != '#' && i < PATH_MAX - 1; i++) {
+		path[i] = ch;
+		next_char();
+	}
+	while (i > 0 && isspace(path[i - 1])) {
+		i--;
+	}
+	path[i] = '\0';
+	return path;
 }
 
 /**
@@ -18,6 +18,7 @@
 #ifndef SCANNER_H
 #define SCANNER_H
 
+#include <stdint.h>
 #include "token.h"
 
 /* current position of token in source file */
@@ -28,8 +29,17 @@ typedef struct {
 
 Cursor cursor;
 
+/* fingerprint of all tokens scanned so far (i.e. of the prefix of the source
+ * file, which determines the graph built so far; comments and whitespace are
+ * not part of it) */
+uint64_t scan_fp;
+
 void init_scanner(FILE *f);
 void next_token(Token *token);
+char* scan_path();
+
+/* adds a token to the fingerprint of the scanned prefix */
+void hash_token(Token *token);
 
 char* recall_chars();
 
@@ -0,0 +1,193 @@
+/* [prove]: A proof verification system using bracketed expressions.
+ * Copyright (C) 2021  Gregor Feierabend
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+#include "reach.h"
+
+/* --- preprocessor directives ---------------------------------------------- */
+#define TRUE 1
+#define FALSE 0
+
+#define TR_INITSIZE 64
+
+static Trace* traces[TR_BUCKETS];
+
+/**
+ * @brief Calculates the hash bucket of a trace.
+ */
+static unsigned int tr_bucket(Pnode* pexstart, Pnode* veri_perspec,
+		Pnode* sub_perspec)
+{
+	uintptr_t h;
+
+	h = (uintptr_t) pexstart ^ ((uintptr_t) veri_perspec >> 3)
+		^ ((uintptr_t) sub_perspec >> 7);
+	return (unsigned int) ((h ^ (h >> 11)) % TR_BUCKETS);
+}
+
+/**
+ * @brief Looks up a trace recorded earlier for the same perspectives.
+ *
+ * @param pexstart start of exploration
+ * @param veri_perspec perspective for verifying assumptions
+ * @param sub_perspec perspective for substitutions
+ * @param exnum Pnode number which must not be exceeded by replaced constants
+ * @param opts remaining options of next_backwards as bits
+ *
+ * @return trace or NULL, if none has been recorded
+ */
+Trace* find_trace(Pnode* pexstart, Pnode* veri_perspec, Pnode* sub_perspec,
+		int exnum, unsigned short int opts)
+{
+	Trace* t;
+
+	for (t = traces[tr_bucket(pexstart, veri_perspec, sub_perspec)];
+			t != NULL; t = t->next) {
+		if (t->pexstart == pexstart && t->veri_perspec == veri_perspec
+				&& t->sub_perspec == sub_perspec && t->exnum == exnum
+				&& t->opts == opts) {
+			return t;
+		}
+	}
+	return NULL;
+}
+
+/**
+ * @brief Creates a new (empty) trace, which is not yet stored.
+ *
+ * @return new trace
+ */
+Trace* new_trace(Pnode* pexstart, Pnode* veri_perspec, Pnode* sub_perspec,
+		int exnum, unsigned short int opts)
+{
+	Trace* t;
+
+	t = (Trace*) malloc(sizeof(Trace));
+	t->pexstart = pexstart;
+	t->veri_perspec = veri_perspec;
+	t->sub_perspec = sub_perspec;
+	t->exnum = exnum;
+	t->opts = opts;
+	t->suspended = FALSE;
+	t->n_events = 0;
+	t->size = TR_INITSIZE;
+	t->events = (TREvent*) malloc(sizeof(TREvent) * t->size);
+	t->next = NULL;
+
+	return t;
+}
+
+/**
+ * @brief Stores a recorded trace, replacing the trace recorded earlier for the
+ * same perspectives. If traces are disabled, the trace is freed instead (and
+ * hence never replayed).
+ *
+ * @param t trace to be stored
+ */
+void store_trace(Trace* t)
+{
+	Trace** titer;
+
+	if (tr_disabled) {
+		free_trace(t);
+		return;
+	}
+
+	for (titer = &traces[tr_bucket(t->pexstart, t->veri_perspec,
+				t->sub_perspec)]; *titer != NULL; titer = &((*titer)->next)) {
+		if ((*titer)->pexstart == t->pexstart
+				&& (*titer)->veri_perspec == t->veri_perspec
+				&& (*titer)->sub_perspec == t->sub_perspec
+				&& (*titer)->exnum == t->exnum && (*titer)->opts == t->opts) {
+			t->next = (*titer)->next;
+			free_trace(*titer);
+			*titer = t;
+			return;
+		}
+	}
+	t->next = NULL;
+	*titer = t;
+}
+
+/**
+ * @brief Frees a single trace.
+ *
+ * @param t trace to be freed
+ */
+void free_trace(Trace* t)
+{
+	free(t->events);
+	free(t);
+}
+
+/**
+ * @brief Frees all stored traces (to be called, when the Pnodes they refer to
+ * may change, i.e. after the verification of a statement).
+ */
+void clear_traces()
+{
+	Trace* t;
+	int i;
+
+	for (i = 0; i < TR_BUCKETS; i++) {
+		while (traces[i] != NULL) {
+			t = traces[i];
+			traces[i] = t->next;
+			free_trace(t);
+		}
+	}
+}
+
+/**
+ * @brief Appends an event to the trace currently being recorded. Recording is
+ * suspended between a successful TR_SUBST and TR_REND.
+ *
+ * @param pnode Pnode the event refers to
+ * @param kind kind of the event
+ * @param res result of a check
+ */
+void trace_event(Pnode* pnode, TRKind kind, unsigned short int res)
+{
+	if (trace_rec == NULL) {
+		return;
+	}
+
+	if (kind == TR_REND) {
+		if (!trace_rec->suspended) {
+			return;
+		}
+		trace_rec->suspended = FALSE;
+	} else if (trace_rec->suspended) {
+		return;
+	}
+
+	if (trace_rec->n_events == trace_rec->size) {
+		trace_rec->size *= 2;
+		trace_rec->events = (TREvent*) realloc(trace_rec->events,
+				sizeof(TREvent) * trace_rec->size);
+	}
+
+	trace_rec->events[trace_rec->n_events].pnode = pnode;
+	trace_rec->events[trace_rec->n_events].kind = kind;
+	trace_rec->events[trace_rec->n_events].res = res;
+	trace_rec->n_events++;
+
+	if (kind == TR_SUBST && res) {
+		trace_rec->suspended = TRUE;
+	}
+}
@@ -0,0 +1,84 @@
+/* [prove]: A proof verification system using bracketed expressions.
+ * Copyright (C) 2021  Gregor Feierabend
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef REACH_H
+#define REACH_H
+
+#include "pgraph.h"
+
+/* number of hash buckets for traces */
+#define TR_BUCKETS 256
+
+/* events recorded while moving an explorer backwards through the tree */
+typedef enum {
+	TR_YIELD,	/* explorer reached a sub-tree */
+	TR_ASMP,	/* assumption was checked (res holds the result) */
+	TR_SUBST,	/* substitution was initialised (res holds the result); if
+				   successful, events are not recorded until TR_REND */
+	TR_REND,	/* end of substitution */
+	TR_END,		/* no reachable sub-trees left */
+} TRKind;
+
+typedef struct trace_event {
+	Pnode* pnode;
+	unsigned char kind;
+	unsigned char res;
+} TREvent;
+
+/* sequence of events, which lead to the reachable sub-trees from the
+ * perspective of a certain Pnode */
+typedef struct trace {
+	Pnode* pexstart;		/* start of exploration */
+	Pnode* veri_perspec;	/* perspective for verifying assumptions */
+	Pnode* sub_perspec;		/* perspective for substitutions */
+	int exnum;
+	unsigned short int opts;/* idonly, exst, do_sub and p_a as bits */
+	unsigned short int suspended;
+	TREvent* events;
+	int n_events;
+	int size;
+	struct trace* next;
+} Trace;
+
+/* replay status of a single explorer */
+typedef struct replay {
+	Trace* trace;		/* trace being replayed (NULL if exploring) */
+	Trace* rec;			/* trace being recorded (NULL if replaying) */
+	Pnode* pexstart;
+	int pos;			/* position of next event in trace */
+	int delivered;		/* number of reachable sub-trees delivered so far */
+	int skip;			/* number of reachable sub-trees to be skipped */
+	unsigned short int in_region; /* TRUE, while substitution is in place */
+	unsigned short int suspended; /* TRUE, if the search has been suspended
+									 while moving to the next sub-tree */
+} Replay;
+
+Trace* trace_rec; /* trace of the explorer currently moving (or NULL) */
+unsigned short int tr_disabled; /* TRUE, if traces are not replayed (see
+								   "--notraces") */
+
+Trace* find_trace(Pnode* pexstart, Pnode* veri_perspec, Pnode* sub_perspec,
+		int exnum, unsigned short int opts);
+Trace* new_trace(Pnode* pexstart, Pnode* veri_perspec, Pnode* sub_perspec,
+		int exnum, unsigned short int opts);
+void store_trace(Trace* t);
+void free_trace(Trace* t);
+void clear_traces();
+
+void trace_event(Pnode* pnode, TRKind kind, unsigned short int res);
+
+#endif /* REACH_H */
@@ -0,0 +1,577 @@
+/* [prove]: A proof verification system using bracketed expressions.
+ * Copyright (C) 2021  Gregor Feierabend
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <limits.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include "serve.h"
+#include "parser.h"
+#include "pgraph.h"
+#include "nogood.h"
+#include "perf.h"
+#include "cert.h"
+#include "error.h"
+#include "debug.h"
+
+/* --- preprocessor directives ---------------------------------------------- */
+#define TRUE 1
+#define FALSE 0
+
+/* initial size of the buffer for a line of a request */
+#define SERVE_BUFFER 4096
+
+/* The server reads one request per line of the form
+ *
+ *   {"id": <number>, "file": <string>, "text": <string>}
+ *
+ * where "text" is the (edited) content of the file. Every request is verified
+ * by a child process, which prints one record per verified list (exactly as
+ * "--profile=json") followed by a single response of the form
+ *
+ *   {"id": <number>, "status": "verified" | "failed" | "error",
+ *    "exit": <status>, "line": <line>, "col": <column>, "message": <string>,
+ *    "wall_ns": <time>}
+ *
+ * where "line", "col" and "message" refer to the first error (if any). The
+ * status is "failed", if a list has not been verified, and "error", if the
+ * file could not be parsed (e.g. an illegal character or a syntax error, for
+ * which the exit status is ERR_SYNTAX) or the verification has been aborted.
+ *
+ * Outcomes of verified lists are kept in the verification cache of the server
+ * (see cert.c): the child exports the outcomes of all lists it has verified to
+ * the server. As the key of a list depends on all tokens preceding it, every
+ * list before the first changed statement is checked against the cache
+ * instead of being searched, while the changed list and all following lists
+ * are searched again (unless they have been verified before in the same
+ * context). */
+
+/* --- global variables ----------------------------------------------------- */
+static char* line_buf = NULL;	/* buffer of the current request */
+static size_t line_size = 0;
+static size_t line_len = 0;		/* number of bytes in the buffer */
+static size_t line_end = 0;		/* end of the current line in the buffer */
+
+/* --- requests ------------------------------------------------------------- */
+/**
+ * @brief Reads the next line from a file descriptor (the line is valid until
+ * the next call).
+ *
+ * @param fd file descriptor of the client
+ *
+ * @return line without its newline or NULL at the end of the input
+ */
+char* read_line(int fd)
+{
+	char* nl;
+	ssize_t n;
+
+	/* drop the previous line */
+	if (line_end > 0) {
+		memmove(line_buf, line_buf + line_end, line_len - line_end);
+		line_len -= line_end;
+		line_end = 0;
+	}
+
+	while (line_len == 0 || (nl = memchr(line_buf, '\n', line_len)) == NULL) {
+		if (line_len + SERVE_BUFFER > line_size) {
+			line_size = line_size == 0 ? SERVE_BUFFER : 2 * line_size;
+			line_buf = (char*) realloc(line_buf, line_size + 1);
+		}
+		if ((n = read(fd, line_buf + line_len, line_size - line_len)) <= 0) {
+			if (line_len == 0) {
+				return NULL;
+			}
+			/* last line without newline */
+			nl = line_buf + line_len;
+			line_len++;
+			break;
+		}
+		line_len += n;
+	}
+
+	*nl = '\0';
+	line_end = nl - line_buf + 1;
+	return line_buf;
+}
+
+/**
+ * @brief Skips whitespace.
+ */
+static char* skip_ws(char* pos)
+{
+	while (isspace((unsigned char) *pos)) {
+		pos++;
+	}
+	return pos;
+}
+
+/**
+ * @brief Decodes a JSON string in place.
+ *
+ * @param ppos pointer to the position of the opening quote; set to the
+ * position after the closing quote
+ * @param len set to the length of the decoded string
+ *
+ * @return decoded string or NULL, if the string is invalid
+ */
+char* json_string(char** ppos, size_t* len)
+{
+	char* pos;
+	char* out;
+	char* start;
+	unsigned long cp;
+	unsigned long lo;
+
+	pos = *ppos;
+	if (*pos != '"') {
+		return NULL;
+	}
+	start = out = ++pos;
+
+	while (*pos != '"') {
+		if (*pos == '\0') {
+			return NULL;
+		}
+		if (*pos != '\\') {
+			*out++ = *pos++;
+			continue;
+		}
+		switch (*++pos) {
+			case 'n': *out++ = '\n'; break;
+			case 't': *out++ = '\t'; break;
+			case 'r': *out++ = '\r'; break;
+			case 'b': *out++ = '\b'; break;
+			case 'f': *out++ = '\f'; break;
+			case '"': case '\\': case '/': *out++ = *pos; break;
+			case 'u':
+				if (sscanf(pos + 1, "%4lx", &cp) != 1) {
+					return NULL;
+				}
+				pos += 4;
+				/* surrogate pair */
+				if (cp >= 0xd800 && cp < 0xdc00 && pos[1] == '\\'
+						&& pos[2] == 'u' && sscanf(pos + 3, "%4lx", &lo) == 1
+						&& lo >= 0xdc00 && lo < 0xe000) {
+					cp = 0x10000 + ((cp - 0xd800) << 10) + (lo - 0xdc00);
+					pos += 6;
+				}
+				/* UTF-8 (never longer than the escape sequence) */
+				if (cp < 0x80) {
+					*out++ = cp;
+				} else if (cp < 0x800) {
+					*out++ = 0xc0 | (cp >> 6);
+					*out++ = 0x80 | (cp & 0x3f);
+				} else if (cp < 0x10000) {
+					*out++ = 0xe0 | (cp >> 12);
+					*out++ = 0x80 | ((cp >> 6) & 0x3f);
+					*out++ = 0x80 | (cp & 0x3f);
+				} else {
+					*out++ = 0xf0 | (cp >> 18);
+					*out++ = 0x80 | ((cp >> 12) & 0x3f);
+					*out++ = 0x80 | ((cp >> 6) & 0x3f);
+					*out++ = 0x80 | (cp & 0x3f);
+				}
+				break;
+			default:
+				return NULL;
+		}
+		pos++;
+	}
+
+	*out = '\0';
+	*len = out - start;
+	*ppos = pos + 1;
+	return start;
+}
+
+/**
+ * @brief Parses a request (the line is modified).
+ *
+ * @param line line of the request
+ * @param rq request to be filled in
+ *
+ * @return NULL or a message, if the request is invalid
+ */
+char* parse_request(char* line, Request* rq)
+{
+	char* pos;
+	char* key;
+	char* value;
+	char* end;
+	size_t len;
+	size_t key_len;
+	long value_int;
+
+	rq->id = 0;
+	rq->file = rq->text = NULL;
+	rq->len = 0;
+	rq->shard = 0;
+	rq->shards = 1;
+	rq->cert = FALSE;
+
+	pos = skip_ws(line);
+	if (*pos++ != '{') {
+		return "request is not a JSON object";
+	}
+
+	for (pos = skip_ws(pos); *pos != '}'; pos = skip_ws(pos)) {
+		if ((key = json_string(&pos, &key_len)) == NULL) {
+			return "invalid key";
+		}
+		pos = skip_ws(pos);
+		if (*pos++ != ':') {
+			return "expected ':'";
+		}
+		pos = skip_ws(pos);
+
+		if (*pos == '"') {
+			if ((value = json_string(&pos, &len)) == NULL) {
+				return "invalid string";
+			}
+			if (strcmp(key, "file") == 0) {
+				rq->file = value;
+			} else if (strcmp(key, "text") == 0) {
+				rq->text = value;
+				rq->len = len;
+			}
+		} else if (strcmp(key, "id") == 0) {
+			rq->id = strtol(pos, &end, 10);
+			if (end == pos) {
+				return "invalid id";
+			}
+			pos = end;
+		} else if (strcmp(key, "shard") == 0 || strcmp(key, "shards") == 0
+				|| strcmp(key, "cert") == 0) {
+			value_int = strtol(pos, &end, 10);
+			if (end == pos || value_int < 0 || value_int > INT_MAX) {
+				return "invalid shard";
+			}
+			if (strcmp(key, "shard") == 0) {
+				rq->shard = value_int;
+			} else if (strcmp(key, "shards") == 0) {
+				rq->shards = value_int;
+			} else {
+				rq->cert = (value_int != 0);
+			}
+			pos = end;
+		} else {
+			/* other scalar values are ignored */
+			while (*pos != ',' && *pos != '}' && *pos != '\0'
+					&& *pos != '{' && *pos != '[') {
+				pos++;
+			}
+			if (*pos == '{' || *pos == '[' || *pos == '\0') {
+				return "unsupported value";
+			}
+		}
+
+		pos = skip_ws(pos);
+		if (*pos == ',') {
+			pos = skip_ws(pos + 1);
+		} else if (*pos != '}') {
+			return "expected ',' or '}'";
+		}
+	}
+
+	if (rq->text == NULL) {
+		return "missing \"text\"";
+	}
+	if (rq->shards < 1 || rq->shard >= rq->shards) {
+		return "invalid shard";
+	}
+	return NULL;
+}
+
+/* --- verification --------------------------------------------------------- */
+/**
+ * @brief Verifies the content of a request (in the child process).
+ *
+ * @param rq request
+ * @param exported stream, to which new cache entries are exported
+ */
+void verify_request(Request* rq, FILE* exported)
+{
+	FILE* file;
+	Pnode* root;
+
+	if (rq->len == 0) {
+		file = fopen("/dev/null", "r");
+	} else {
+		file = fmemopen(rq->text, rq->len, "r");
+	}
+	if (file == NULL) {
+		fprintf(stderr, "error opening the content of the request\n");
+		exit(EXIT_FAILURE);
+	}
+
+	perf_source(rq->file != NULL ? rq->file : "");
+	parse_source = rq->file;
+	cache_export = exported;
+	success = EXIT_SUCCESS;
+
+	init_nogood();
+	root = parse_file(file);
+	free_graph(root);
+	free_nogood();
+	fclose(file);
+
+	exit(success);
+}
+
+/**
+ * @brief Finds the first error message in the output of the child and removes
+ * colour codes.
+ *
+ * @param errors output of the child
+ * @param line set to the line of the error
+ * @param col set to the column of the error
+ *
+ * @return error message (allocated) or NULL, if there is none
+ */
+char* first_error(FILE* errors, int* line, int* col)
+{
+	char* buf;
+	char* msg;
+	char* pos;
+	char* out;
+	size_t size;
+
+	buf = NULL;
+	size = 0;
+	msg = NULL;
+	rewind(errors);
+	while (getline(&buf, &size, errors) != -1) {
+		for (pos = strstr(buf, "line "); pos != NULL;
+				pos = strstr(pos + 1, "line ")) {
+			if (sscanf(pos, "line %d, column %d", line, col) == 2) {
+				msg = buf;
+				break;
+			}
+		}
+		if (msg != NULL) {
+			break;
+		}
+	}
+	if (msg == NULL) {
+		free(buf);
+		return NULL;
+	}
+
+	/* strip escape sequences and the newline; non-ASCII characters are
+	 * replaced (the message may contain a single byte of a multi-byte
+	 * character, which would not be valid JSON) */
+	for (pos = out = msg; *pos != '\0' && *pos != '\n'; pos++) {
+		if (*pos == '\033') {
+			while (*pos != '\0' && *pos != 'm') {
+				pos++;
+			}
+			if (*pos == '\0') {
+				break;
+			}
+		} else {
+			*out++ = ((unsigned char) *pos < 0x80) ? *pos : '?';
+		}
+	}
+	*out = '\0';
+
+	/* drop progress messages (e.g. "<trying ...>") in front of the error */
+	if ((pos = strrchr(msg, '>')) != NULL && pos < strstr(msg, "line ")) {
+		memmove(msg, pos + 1, strlen(pos + 1) + 1);
+	}
+	return msg;
+}
+
+/**
+ * @brief Verifies a request in a child process, imports the outcomes of the
+ * verified lists into the cache and prints the response.
+ *
+ * @param rq request
+ */
+void handle_request(Request* rq)
+{
+	FILE* errors;
+	FILE* exported;
+	struct timespec start;
+	struct timespec now;
+	uint64_t wall_ns;
+	char* msg;
+	char* status;
+	int fds[2];
+	int line;
+	int col;
+	int wstatus;
+	int code;
+	pid_t pid;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	fflush(stdout);
+	fflush(stderr);
+
+	errors = tmpfile();
+	if (errors == NULL || pipe(fds) == -1) {
+		fprintf(stderr, "error creating a child process\n");
+		exit(EXIT_FAILURE);
+	}
+
+	if ((pid = fork()) == 0) {
+		close(fds[0]);
+		dup2(fileno(errors), STDERR_FILENO);
+		verify_request(rq, fdopen(fds[1], "w"));
+	}
+
+	close(fds[1]);
+	if (pid == -1) {
+		close(fds[0]);
+		code = -1;
+	} else {
+		exported = fdopen(fds[0], "r");
+		cache_import(exported);
+		fclose(exported);
+		waitpid(pid, &wstatus, 0);
+		code = WIFEXITED(wstatus) ? WEXITSTATUS(wstatus) : -1;
+	}
+
+	line = col = 0;
+	msg = first_error(errors, &line, &col);
+	fclose(errors);
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	wall_ns = (uint64_t) (now.tv_sec - start.tv_sec) * 1000000000ULL
+		+ now.tv_nsec - start.tv_nsec;
+
+	if (code == EXIT_SUCCESS) {
+		status = "verified";
+	} else if (code == EXIT_FAILURE && msg != NULL) {
+		status = "failed";
+	} else {
+		status = "error";
+	}
+
+	printf("{\"id\":%ld,\"status\":\"%s\",\"exit\":%d,\"line\":%d,"
+			"\"col\":%d,\"message\":", rq->id, status, code, line, col);
+	if (msg != NULL) {
+		print_json_str(msg);
+	} else if (code == -1) {
+		print_json_str("verification has been aborted");
+	} else {
+		printf("null");
+	}
+	printf(",\"wall_ns\":%llu}\n", (unsigned long long) wall_ns);
+	fflush(stdout);
+
+	free(msg);
+}
+
+/* --- server --------------------------------------------------------------- */
+/**
+ * @brief Answers the requests of a client until the end of its input.
+ *
+ * @param fd file descriptor, from which requests are read (responses are
+ * printed to stdout)
+ */
+void serve_client(int fd)
+{
+	Request rq;
+	char* line;
+	char* err;
+
+	while ((line = read_line(fd)) != NULL) {
+		if (*skip_ws(line) == '\0') {
+			continue;
+		}
+		if ((err = parse_request(line, &rq)) != NULL) {
+			printf("{\"id\":%ld,\"status\":\"error\",\"exit\":%d,\"line\":0,"
+					"\"col\":0,\"message\":", rq.id, ERR_SYNTAX);
+			print_json_str(err);
+			printf(",\"wall_ns\":0}\n");
+			fflush(stdout);
+			continue;
+		}
+		handle_request(&rq);
+	}
+
+	line_len = line_end = 0;
+}
+
+/**
+ * @brief Runs the verification server, which keeps the outcomes of all
+ * verified lists in memory, so that edited files are verified incrementally.
+ *
+ * @param socket_path path of a Unix socket, on which clients are accepted one
+ * after another, or NULL, if requests are read from stdin
+ *
+ * @return FALSE, if the socket cannot be created
+ */
+unsigned short int serve(char* socket_path)
+{
+	struct sockaddr_un addr;
+	int sock;
+	int client;
+	int out;
+
+	if (!do_cache) {
+		cache_open(NULL);
+	}
+	set_profile("json");
+
+	if (socket_path == NULL) {
+		serve_client(STDIN_FILENO);
+		return TRUE;
+	}
+
+	if (strlen(socket_path) >= sizeof(addr.sun_path)) {
+		fprintf(stderr, "socket path '%s' is too long\n", socket_path);
+		return FALSE;
+	}
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strcpy(addr.sun_path, socket_path);
+
+	unlink(socket_path);
+	if ((sock = socket(AF_UNIX, SOCK_STREAM, 0)) == -1
+			|| bind(sock, (struct sockaddr*) &addr, sizeof(addr)) == -1
+			|| listen(sock, 1) == -1) {
+		fprintf(stderr, "error opening socket '%s'\n", socket_path);
+		return FALSE;
+	}
+
+	/* responses are printed to the client; disconnected clients are noticed
+	 * when reading */
+	signal(SIGPIPE, SIG_IGN);
+	out = dup(STDOUT_FILENO);
+	while ((client = accept(sock, NULL, NULL)) != -1) {
+		fflush(stdout);
+		dup2(client, STDOUT_FILENO);
+		serve_client(client);
+		fflush(stdout);
+		dup2(out, STDOUT_FILENO);
+		close(client);
+	}
+
+	close(sock);
+	unlink(socket_path);
+	return FALSE;
+}
@@ -0,0 +1,40 @@
+/* [prove]: A proof verification system using bracketed expressions.
+ * Copyright (C) 2021  Gregor Feierabend
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef SERVE_H
+#define SERVE_H
+
+/* request of a client (a single line of JSON) */
+typedef struct request {
+	long id;		/* id of the request (echoed in the response) */
+	char* file;		/* name of the file (for the records; may be NULL) */
+	char* text;		/* content of the file to be verified */
+	size_t len;		/* length of the content */
+	int shard;		/* shard to be verified by a worker (see shard.c) */
+	int shards;		/* number of shards of the file */
+	unsigned short int cert;	/* TRUE, if a worker has to send certificate
+								   records */
+} Request;
+
+unsigned short int serve(char* socket_path);
+
+/* for the workers of a coordinator (see shard.c) */
+char* read_line(int fd);
+char* parse_request(char* line, Request* rq);
+
+#endif /* SERVE_H */
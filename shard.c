@@ -0,0 +1,707 @@
+/* [prove]: A proof verification system using bracketed expressions.
+ * Copyright (C) 2021  Gregor Feierabend
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <netdb.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include "shard.h"
+#include "jobs.h"
+#include "serve.h"
+#include "parser.h"
+#include "nogood.h"
+#include "perf.h"
+#include "cert.h"
+#include "debug.h"
+
+/* --- preprocessor directives ---------------------------------------------- */
+#define TRUE 1
+#define FALSE 0
+
+/* maximal number of times a shard is dispatched */
+#define SHARD_ATTEMPTS 3
+
+/* number of attempts of a worker to connect to the coordinator (every 100 ms,
+ * so that workers can be started before the coordinator) */
+#define SHARD_CONNECT 50
+
+/* initial size of the buffer for the results of a shard */
+#define SHARD_BUFFER 4096
+
+/* The coordinator splits every file into shards, i.e. every n-th statement at
+ * the top level, and sends each shard to a worker as a single line
+ *
+ *   {"id": <number>, "file": <string>, "shard": <number>, "shards": <number>,
+ *    "cert": 0 | 1, "text": <string>}
+ *
+ * (a request of the server, see serve.c). The worker verifies the shard in a
+ * child process exactly as a worker of "--jobs" and answers with one JobRecord
+ * per verified list (followed by its output and certificate record), followed
+ * by a JobRecord with line 0, which holds the exit status of the child and the
+ * output following the last list. The records are binary, i.e. coordinator and
+ * workers have to run the same build of [prove].
+ *
+ * Shards of workers, which disconnect or terminate abnormally, are dispatched
+ * to another worker; the results of a file are printed in order as soon as all
+ * of its shards are complete. */
+
+/* --- global variables ----------------------------------------------------- */
+static Shard* shards = NULL;
+static int n_shards_total = 0;
+
+static Worker* workers = NULL;
+static int n_workers = 0;
+
+/* --- sockets -------------------------------------------------------------- */
+/**
+ * @brief Opens a socket, which is either listening on an address or connected
+ * to it.
+ *
+ * @param address "<host>:<port>" or path of a Unix socket
+ * @param listening TRUE for a listening socket
+ *
+ * @return file descriptor or -1 on error
+ */
+static int open_address(char* address, unsigned short int listening)
+{
+	struct sockaddr_un addr;
+	struct addrinfo hints;
+	struct addrinfo* res;
+	struct addrinfo* ai;
+	char* port;
+	char* host;
+	int sock;
+	int on;
+
+	port = strrchr(address, ':');
+	if (port == NULL || strchr(address, '/') != NULL) {
+		if (strlen(address) >= sizeof(addr.sun_path)) {
+			return -1;
+		}
+		memset(&addr, 0, sizeof(addr));
+		addr.sun_family = AF_UNIX;
+		strcpy(addr.sun_path, address);
+
+		if ((sock = socket(AF_UNIX, SOCK_STREAM, 0)) == -1) {
+			return -1;
+		}
+		if (listening) {
+			unlink(address);
+			if (bind(sock, (struct sockaddr*) &addr, sizeof(addr)) == -1
+					|| listen(sock, SOMAXCONN) == -1) {
+				close(sock);
+				return -1;
+			}
+		} else if (connect(sock, (struct sockaddr*) &addr, sizeof(addr))
+				== -1) {
+			close(sock);
+			return -1;
+		}
+		return sock;
+	}
+
+	host = (char*) malloc(port - address + 1);
+	memcpy(host, address, port - address);
+	host[port - address] = '\0';
+
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+	hints.ai_flags = listening ? AI_PASSIVE : 0;
+	if (getaddrinfo(*host != '\0' ? host : NULL, port + 1, &hints, &res)
+			!= 0) {
+		free(host);
+		return -1;
+	}
+	free(host);
+
+	sock = -1;
+	for (ai = res; ai != NULL; ai = ai->ai_next) {
+		if ((sock = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol))
+				== -1) {
+			continue;
+		}
+		if (listening) {
+			on = 1;
+			setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+			if (bind(sock, ai->ai_addr, ai->ai_addrlen) == 0
+					&& listen(sock, SOMAXCONN) == 0) {
+				break;
+			}
+		} else if (connect(sock, ai->ai_addr, ai->ai_addrlen) == 0) {
+			break;
+		}
+		close(sock);
+		sock = -1;
+	}
+	freeaddrinfo(res);
+	return sock;
+}
+
+/**
+ * @brief Writes a number of bytes to a socket.
+ *
+ * @param fd file descriptor of the socket
+ * @param buf bytes to be written
+ * @param len number of bytes
+ *
+ * @return FALSE, if the connection has been closed
+ */
+static unsigned short int write_all(int fd, void* buf, size_t len)
+{
+	ssize_t n;
+
+	while (len > 0) {
+		if ((n = write(fd, buf, len)) == -1) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return FALSE;
+		}
+		buf = (char*) buf + n;
+		len -= n;
+	}
+	return TRUE;
+}
+
+/* --- worker --------------------------------------------------------------- */
+/**
+ * @brief Verifies a shard in a child process, which sends the records of its
+ * lists to the coordinator, and sends the concluding record.
+ *
+ * @param rq request of the coordinator
+ * @param sock file descriptor of the connection to the coordinator
+ *
+ * @return FALSE, if the connection has been closed
+ */
+static unsigned short int verify_shard(Request* rq, int sock)
+{
+	JobRecord r;
+	FILE* errors;
+	FILE* file;
+	struct stat st;
+	char* output;
+	ssize_t n;
+	int wstatus;
+	pid_t pid;
+
+	if ((errors = tmpfile()) == NULL) {
+		fprintf(stderr, "error creating a temporary file\n");
+		exit(EXIT_FAILURE);
+	}
+
+	fflush(NULL);
+	if ((pid = fork()) == 0) {
+		dup2(fileno(errors), STDERR_FILENO);
+		if (rq->len == 0) {
+			file = fopen("/dev/null", "r");
+		} else {
+			file = fmemopen(rq->text, rq->len, "r");
+		}
+		if (file == NULL) {
+			fprintf(stderr, "error opening the content of the request\n");
+			exit(EXIT_FAILURE);
+		}
+
+		perf_source(rq->file != NULL ? rq->file : "");
+		parse_source = rq->file;
+		success = EXIT_SUCCESS;
+
+		/* the records are sent to the coordinator list by list (see
+		 * jobs.c) */
+		if (rq->cert) {
+			cert_open("/dev/null");
+		}
+		job_worker(rq->shard, rq->shards, sock);
+
+		init_nogood();
+		parse_file(file);
+		/* not reached (see jobs_finish) */
+		exit(success);
+	}
+
+	memset(&r, 0, sizeof(JobRecord));
+	r.status = -1;
+	if (pid != -1 && waitpid(pid, &wstatus, 0) != -1
+			&& WIFEXITED(wstatus)) {
+		r.status = WEXITSTATUS(wstatus);
+	}
+
+	output = NULL;
+	if (fstat(fileno(errors), &st) == 0 && st.st_size > 0) {
+		output = (char*) malloc(st.st_size);
+		n = pread(fileno(errors), output, st.st_size, 0);
+		r.len_output = n > 0 ? n : 0;
+	}
+	fclose(errors);
+
+	if (!write_all(sock, &r, sizeof(JobRecord))
+			|| !write_all(sock, output, r.len_output)) {
+		free(output);
+		return FALSE;
+	}
+	free(output);
+	return TRUE;
+}
+
+/**
+ * @brief Runs a worker, which verifies the shards sent by a coordinator until
+ * the coordinator closes the connection. The options of the worker (e.g. the
+ * strategies or a library) apply to every shard.
+ *
+ * @param address address of the coordinator
+ *
+ * @return FALSE, if the coordinator cannot be reached
+ */
+unsigned short int work(char* address)
+{
+	struct timespec delay = {0, 100000000};
+	Request rq;
+	char* line;
+	char* err;
+	int sock;
+	int i;
+
+	for (i = 0; (sock = open_address(address, FALSE)) == -1; i++) {
+		if (i == SHARD_CONNECT) {
+			fprintf(stderr, "error connecting to '%s'\n", address);
+			return FALSE;
+		}
+		nanosleep(&delay, NULL);
+	}
+
+	signal(SIGPIPE, SIG_IGN);
+	while ((line = read_line(sock)) != NULL) {
+		if ((err = parse_request(line, &rq)) != NULL) {
+			fprintf(stderr, "invalid request of the coordinator: %s\n", err);
+			close(sock);
+			return FALSE;
+		}
+		if (!verify_shard(&rq, sock)) {
+			break;
+		}
+	}
+
+	close(sock);
+	return TRUE;
+}
+
+/* --- coordinator ---------------------------------------------------------- */
+/**
+ * @brief Reads the content of a file.
+ *
+ * @param filename name of the file
+ * @param len set to the length of the content
+ *
+ * @return content (terminated by '\0') or NULL on error
+ */
+static char* read_file(char* filename, size_t* len)
+{
+	FILE* file;
+	char* text;
+	size_t size;
+	size_t n;
+
+	if ((file = fopen(filename, "r")) == NULL) {
+		return NULL;
+	}
+	size = SHARD_BUFFER;
+	text = (char*) malloc(size);
+	*len = 0;
+	while ((n = fread(text + *len, 1, size - *len - 1, file)) > 0) {
+		*len += n;
+		if (*len + 1 == size) {
+			size *= 2;
+			text = (char*) realloc(text, size);
+		}
+	}
+	text[*len] = '\0';
+	fclose(file);
+	return text;
+}
+
+/**
+ * @brief Sends a shard to an idle worker.
+ *
+ * @param w worker
+ * @param s index of the shard
+ * @param files names of the files
+ * @param texts contents of the files
+ * @param n_shards number of shards of every file
+ *
+ * @return FALSE, if the connection has been closed
+ */
+static unsigned short int dispatch(Worker* w, int s, char** files,
+		char** texts, int n_shards)
+{
+	FILE* line;
+	char* buf;
+	size_t len;
+	unsigned short int sent;
+
+	buf = NULL;
+	line = open_memstream(&buf, &len);
+	fprintf(line, "{\"id\":%d,\"file\":", s);
+	fprint_json_str(line, files[shards[s].file]);
+	fprintf(line, ",\"shard\":%d,\"shards\":%d,\"cert\":%d,\"text\":",
+			shards[s].num, n_shards, do_cert ? 1 : 0);
+	fprint_json_str(line, texts[shards[s].file]);
+	fprintf(line, "}\n");
+	fclose(line);
+
+	sent = write_all(w->fd, buf, len);
+	free(buf);
+	if (sent) {
+		w->shard = s;
+		w->len = w->complete = 0;
+		shards[s].state = SHARD_RUNNING;
+		shards[s].attempts++;
+	}
+	return sent;
+}
+
+/**
+ * @brief Puts a shard, whose worker has failed, back into the queue (or
+ * aborts it, if it has failed too often).
+ *
+ * @param s index of the shard
+ * @param files names of the files
+ */
+static void redispatch(int s, char** files)
+{
+	if (shards[s].attempts < SHARD_ATTEMPTS) {
+		fprintf(stderr, SHELL_BROWN "<worker has failed, shard %d of '%s' is "
+				"dispatched again>" SHELL_RESET1 "\n", shards[s].num,
+				files[shards[s].file]);
+		shards[s].state = SHARD_PENDING;
+	} else {
+		shards[s].state = SHARD_DONE;
+		shards[s].status = -1;
+	}
+}
+
+/**
+ * @brief Closes the connection to a worker (its shard is dispatched again).
+ *
+ * @param i index of the worker
+ * @param files names of the files
+ */
+static void drop_worker(int i, char** files)
+{
+	if (workers[i].shard >= 0) {
+		redispatch(workers[i].shard, files);
+	}
+	close(workers[i].fd);
+	free(workers[i].buf);
+	workers[i] = workers[--n_workers];
+}
+
+/**
+ * @brief Receives results of a worker.
+ *
+ * @param i index of the worker
+ * @param files names of the files
+ *
+ * @return FALSE, if the connection has been closed (and the worker has been
+ * dropped)
+ */
+static unsigned short int receive(int i, char** files)
+{
+	JobRecord r;
+	Worker* w;
+	Shard* sh;
+	size_t end;
+	ssize_t n;
+
+	w = &(workers[i]);
+	if (w->len + SHARD_BUFFER > w->size) {
+		w->size = w->size == 0 ? 4 * SHARD_BUFFER : 2 * w->size;
+		w->buf = (char*) realloc(w->buf, w->size);
+	}
+	if ((n = read(w->fd, w->buf + w->len, w->size - w->len)) <= 0
+			|| w->shard < 0) {
+		drop_worker(i, files);
+		return FALSE;
+	}
+	w->len += n;
+
+	while (w->len - w->complete >= sizeof(JobRecord)) {
+		memcpy(&r, w->buf + w->complete, sizeof(JobRecord));
+		end = w->complete + sizeof(JobRecord) + r.len_output + r.len_cert;
+		if (w->len < end) {
+			break;
+		}
+		if (r.perf.line != 0) {
+			w->complete = end;
+			continue;
+		}
+
+		/* end of the shard: the records are kept until the file is
+		 * printed */
+		sh = &(shards[w->shard]);
+		if (r.status == -1) {
+			redispatch(w->shard, files);
+		} else {
+			sh->state = SHARD_DONE;
+			sh->status = r.status;
+			sh->data = (char*) malloc(w->complete + 1);
+			memcpy(sh->data, w->buf, w->complete);
+			sh->len = w->complete;
+			sh->output = (char*) malloc(r.len_output + 1);
+			memcpy(sh->output, w->buf + w->complete + sizeof(JobRecord),
+					r.len_output);
+			sh->len_output = r.len_output;
+		}
+		memmove(w->buf, w->buf + end, w->len - end);
+		w->len -= end;
+		w->complete = 0;
+		w->shard = -1;
+	}
+	return TRUE;
+}
+
+/**
+ * @brief Prints the results of a file, whose shards are complete, in the order
+ * of its lists, as if it had been verified by this process.
+ *
+ * @param f index of the file
+ * @param files names of the files
+ * @param n_shards number of shards of every file
+ */
+static void print_file(int f, char** files, int n_shards)
+{
+	JobRecord r;
+	Shard* sh;
+	JobRecord next;
+	size_t* pos;
+	char* text;
+	char* output;
+	unsigned long int unknown;
+	int status;
+	int k;
+	int first;
+
+	perf_source(files[f]);
+	unknown = n_unknown;
+	sh = &(shards[f * n_shards]);
+	pos = (size_t*) calloc(n_shards, sizeof(size_t));
+	status = EXIT_SUCCESS;
+
+	/* the records of every shard are in order, the shards are merged */
+	for (;;) {
+		first = -1;
+		for (k = 0; k < n_shards; k++) {
+			if (pos[k] >= sh[k].len) {
+				continue;
+			}
+			memcpy(&next, sh[k].data + pos[k], sizeof(JobRecord));
+			if (first == -1 || next.perf.line < r.perf.line
+					|| (next.perf.line == r.perf.line
+						&& next.perf.col < r.perf.col)) {
+				first = k;
+				r = next;
+			}
+		}
+		if (first == -1) {
+			break;
+		}
+
+		output = sh[first].data + pos[first] + sizeof(JobRecord);
+		text = (char*) malloc(r.len_cert + 1);
+		memcpy(text, output + r.len_output, r.len_cert);
+		text[r.len_cert] = '\0';
+		pos[first] += sizeof(JobRecord) + r.len_output + r.len_cert;
+
+		job_add(&r, output, text);
+		free(text);
+		if (!job_check(&r)) {
+			status = EXIT_FAILURE;
+			if (!DBG_FINISH_IS_SET) {
+				break;
+			}
+		}
+	}
+
+	/* errors outside of lists (e.g. syntax errors) are the same in every
+	 * shard */
+	for (k = 0; status == EXIT_SUCCESS && k < n_shards; k++) {
+		if (sh[k].status == -1) {
+			fprintf(stderr, SHELL_RED "verification aborted (the workers of "
+					"shard %d have failed)" SHELL_RESET1 "\n", k);
+			status = EXIT_FAILURE;
+		} else if (sh[k].status != EXIT_SUCCESS) {
+			fwrite(sh[k].output, 1, sh[k].len_output, stderr);
+			status = sh[k].status;
+		}
+	}
+
+	/* lists, whose budget has run out, have not been verified */
+	if (status == EXIT_SUCCESS && n_unknown > unknown) {
+		status = EXIT_FAILURE;
+	}
+	if (status != EXIT_SUCCESS) {
+		fprintf(stderr, SHELL_RED "'%s' has not been verified" SHELL_RESET1
+				"\n", files[f]);
+		if (success == EXIT_SUCCESS) {
+			success = status;
+		}
+	}
+	fflush(stderr);
+	fflush(stdout);
+
+	for (k = 0; k < n_shards; k++) {
+		free(sh[k].data);
+		free(sh[k].output);
+		sh[k].data = sh[k].output = NULL;
+	}
+	free(pos);
+}
+
+/**
+ * @brief Runs the coordinator, which distributes the shards of files among
+ * the workers connecting to an address and prints their results in order.
+ * The outcome is stored in success.
+ *
+ * @param address "<host>:<port>" or path of a Unix socket
+ * @param files names of the files
+ * @param n_files number of files
+ * @param n_shards number of shards of every file
+ *
+ * @return FALSE, if a file or the socket cannot be opened
+ */
+unsigned short int coordinate(char* address, char** files, int n_files,
+		int n_shards)
+{
+	struct pollfd* fds;
+	char** texts;
+	size_t len;
+	int sock;
+	int next_file;
+	int s;
+	int i;
+	int n;
+
+	texts = (char**) malloc(n_files * sizeof(char*));
+	for (i = 0; i < n_files; i++) {
+		if ((texts[i] = read_file(files[i], &len)) == NULL) {
+			fprintf(stderr, "error opening '%s'\n", files[i]);
+			return FALSE;
+		}
+	}
+
+	n_shards_total = n_files * n_shards;
+	shards = (Shard*) calloc(n_shards_total, sizeof(Shard));
+	for (s = 0; s < n_shards_total; s++) {
+		shards[s].file = s / n_shards;
+		shards[s].num = s % n_shards;
+	}
+
+	if ((sock = open_address(address, TRUE)) == -1) {
+		fprintf(stderr, "error opening socket '%s'\n", address);
+		return FALSE;
+	}
+	signal(SIGPIPE, SIG_IGN);
+
+	next_file = 0;
+	fds = NULL;
+	while (next_file < n_files) {
+		/* pending shards are dispatched in order (so that files are
+		 * completed in order) */
+		s = 0;
+		for (i = 0; i < n_workers; i++) {
+			for (; s < n_shards_total && shards[s].state != SHARD_PENDING;
+					s++);
+			if (s == n_shards_total) {
+				break;
+			}
+			if (workers[i].shard < 0 && !dispatch(&(workers[i]), s, files,
+						texts, n_shards)) {
+				drop_worker(i--, files);
+			}
+		}
+
+		fds = (struct pollfd*) realloc(fds, (n_workers + 1)
+				* sizeof(struct pollfd));
+		fds[0].fd = sock;
+		fds[0].events = POLLIN;
+		for (i = 0; i < n_workers; i++) {
+			fds[i + 1].fd = workers[i].fd;
+			fds[i + 1].events = POLLIN;
+		}
+		if (poll(fds, n_workers + 1, -1) == -1) {
+			if (errno == EINTR) {
+				continue;
+			}
+			break;
+		}
+
+		/* workers are dropped in reverse order (see drop_worker) */
+		n = n_workers;
+		for (i = n - 1; i >= 0; i--) {
+			if (fds[i + 1].revents != 0) {
+				receive(i, files);
+			}
+		}
+		if (fds[0].revents & POLLIN) {
+			workers = (Worker*) realloc(workers, (n_workers + 1)
+					* sizeof(Worker));
+			memset(&(workers[n_workers]), 0, sizeof(Worker));
+			workers[n_workers].shard = -1;
+			if ((workers[n_workers].fd = accept(sock, NULL, NULL)) != -1) {
+				n_workers++;
+			}
+		}
+
+		while (next_file < n_files) {
+			for (i = 0; i < n_shards && shards[next_file * n_shards + i].state
+					== SHARD_DONE; i++);
+			if (i < n_shards) {
+				break;
+			}
+			print_file(next_file++, files, n_shards);
+		}
+	}
+
+	/* the workers terminate, when the connection is closed */
+	for (i = 0; i < n_workers; i++) {
+		close(workers[i].fd);
+		free(workers[i].buf);
+	}
+	free(workers);
+	free(fds);
+	close(sock);
+	if (strchr(address, ':') == NULL || strchr(address, '/') != NULL) {
+		unlink(address);
+	}
+
+	for (i = 0; i < n_files; i++) {
+		free(texts[i]);
+	}
+	free(texts);
+	free(shards);
+	return next_file == n_files;
+}
@@ -0,0 +1,60 @@
+/* [prove]: A proof verification system using bracketed expressions.
+ * Copyright (C) 2021  Gregor Feierabend
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef SHARD_H
+#define SHARD_H
+
+#include <stddef.h>
+
+/* states of a shard */
+typedef enum {
+	SHARD_PENDING = 0,	/* waiting to be dispatched */
+	SHARD_RUNNING,		/* dispatched to a worker */
+	SHARD_DONE,			/* all results have been received */
+} ShardState;
+
+/* shard of a file, i.e. every n-th statement at the top level (see jobs.c) */
+typedef struct shard {
+	int file;			/* index of the file */
+	int num;			/* number of the shard within the file */
+	ShardState state;
+	int attempts;		/* number of times the shard has been dispatched */
+	int status;			/* exit status of the worker (-1, if the shard has
+						   been aborted) */
+	char* data;			/* received JobRecords (each followed by its output
+						   and certificate record) */
+	size_t len;
+	char* output;		/* output following the last list */
+	size_t len_output;
+} Shard;
+
+/* connection of the coordinator to a worker */
+typedef struct worker {
+	int fd;
+	int shard;			/* index of the dispatched shard (-1, if idle) */
+	char* buf;			/* received JobRecords of the shard */
+	size_t len;
+	size_t size;
+	size_t complete;	/* length of the complete JobRecords in the buffer */
+} Worker;
+
+unsigned short int coordinate(char* address, char** files, int n_files,
+		int n_shards);
+unsigned short int work(char* address);
+
+#endif /* SHARD_H */
@@ -0,0 +1,489 @@
+/* [prove]: A proof verification system using bracketed expressions.
+ * Copyright (C) 2021  Gregor Feierabend
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+#include <sys/resource.h>
+#include "strategy.h"
+#include "verify.h"
+#include "cert.h"
+#include "debug.h"
+
+/* --- preprocessor directives ---------------------------------------------- */
+#define TRUE 1
+#define FALSE 0
+
+/* clock measuring the time budget, which is read on every check (the coarse
+ * clock of Linux is read without a system call, but only has the resolution of
+ * a timer tick) */
+#ifdef CLOCK_MONOTONIC_COARSE
+#define BUDGET_CLOCK CLOCK_MONOTONIC_COARSE
+#else
+#define BUDGET_CLOCK CLOCK_MONOTONIC
+#endif
+
+/* --- function prototypes -------------------------------------------------- */
+unsigned short int st_facts(Pnode* pnode, Pnode* pexstart);
+unsigned short int st_idonly(Pnode* pnode, Pnode* pexstart);
+unsigned short int st_full(Pnode* pnode, Pnode* pexstart);
+unsigned short int st_forward(Pnode* pnode, Pnode* pexstart);
+unsigned short int st_cases(Pnode* pnode, Pnode* pexstart);
+
+/* --- global variables ----------------------------------------------------- */
+
+/* all available strategies, roughly ordered by their cost */
+static Strategy strategies[] = {
+	{"facts", st_facts, FALSE, 0, 0, 0, 0, 0},
+	{"idonly", st_idonly, FALSE, 0, 0, 0, 0, 0},
+	{"full", st_full, FALSE, 0, 0, 0, 0, 0},
+	{"forward", st_forward, FALSE, 0, 0, 0, 0, 0},
+	{"cases", st_cases, TRUE, 0, 0, 0, 0, 0},
+};
+#define N_STRATEGIES (sizeof(strategies) / sizeof(Strategy))
+
+/* strategies in the order they are tried */
+static Strategy* pipeline[ST_MAX];
+static int n_pipeline = 0;
+
+/* counters at the beginning of the current list (see start_budget) */
+static uint64_t budget_comparisons;
+static uint64_t budget_substitutions;
+static struct timespec budget_time;
+static uint64_t budget_memory;
+static unsigned long int budget_polls;
+
+/* --- strategies ----------------------------------------------------------- */
+/**
+ * @brief Looks up the statements of the list among the visible constants.
+ */
+unsigned short int st_facts(Pnode* pnode, Pnode* pexstart)
+{
+	return verify_facts(*(pnode->right), pexstart);
+}
+
+/**
+ * @brief Searches, substituting ids only (i.e. constants of the prev_id chain).
+ */
+unsigned short int st_idonly(Pnode* pnode, Pnode* pexstart)
+{
+	return verify_quantifiers(*(pnode->right), pexstart, TRUE, FALSE);
+}
+
+/**
+ * @brief Searches, substituting any visible constants (i.e. constants of the
+ * prev_const chain).
+ */
+unsigned short int st_full(Pnode* pnode, Pnode* pexstart)
+{
+	return verify_quantifiers(*(pnode->right), pexstart, FALSE, FALSE);
+}
+
+/**
+ * @brief Searches, substituting existential ids forwards.
+ */
+unsigned short int st_forward(Pnode* pnode, Pnode* pexstart)
+{
+	return verify_quantifiers(*(pnode->right), pexstart, FALSE, TRUE);
+}
+
+/**
+ * @brief Considers cases (only for lists at the top level, which consist of a
+ * single statement).
+ */
+unsigned short int st_cases(Pnode* pnode, Pnode* pexstart)
+{
+	if (pnode->num != pexstart->num) {
+		return FALSE;
+	}
+	fprintf(stderr, SHELL_BROWN "<trying case-based verification>"
+			SHELL_RESET1);
+	return verify_cases(pnode);
+}
+
+/* --- pipeline ------------------------------------------------------------- */
+/**
+ * @brief Sets up the pipeline of strategies from a comma-separated list of
+ * strategy names, each optionally followed by ":" and a budget. Every
+ * strategy can be given only once.
+ *
+ * @param spec list of strategies (e.g. "facts,idonly:2000,full")
+ *
+ * @return FALSE, if the list is invalid
+ */
+unsigned short int set_strategies(char* spec)
+{
+	char* list;
+	char* name;
+	char* budget;
+	char* end;
+	unsigned int i;
+	int j;
+
+	list = (char*) malloc(sizeof(char) * (strlen(spec) + 1));
+	strcpy(list, spec);
+	n_pipeline = 0;
+
+	for (name = strtok(list, ","); name != NULL; name = strtok(NULL, ",")) {
+		budget = strchr(name, ':');
+		if (budget != NULL) {
+			*budget++ = '\0';
+		}
+
+		for (i = 0; i < N_STRATEGIES; i++) {
+			if (strcmp(name, strategies[i].name) == 0) {
+				break;
+			}
+		}
+		if (i == N_STRATEGIES) {
+			fprintf(stderr, "unknown strategy '%s'\n", name);
+			free(list);
+			return FALSE;
+		}
+		if (n_pipeline == ST_MAX) {
+			fprintf(stderr, "too many strategies (at most %d)\n", ST_MAX);
+			free(list);
+			return FALSE;
+		}
+
+		/* the budget and the statistics belong to the strategy, hence it
+		 * can only be tried once */
+		for (j = 0; j < n_pipeline; j++) {
+			if (pipeline[j] == &strategies[i]) {
+				fprintf(stderr, "strategy '%s' is given more than once\n",
+						name);
+				free(list);
+				return FALSE;
+			}
+		}
+
+		strategies[i].budget = 0;
+		if (budget != NULL) {
+			strategies[i].budget = strtoull(budget, &end, 10);
+			if (*budget == '\0' || *end != '\0') {
+				fprintf(stderr, "invalid budget '%s' for strategy '%s'\n",
+						budget, name);
+				free(list);
+				return FALSE;
+			}
+		}
+		pipeline[n_pipeline++] = &strategies[i];
+	}
+
+	free(list);
+	return (n_pipeline > 0);
+}
+
+/**
+ * @brief Tries the strategies of the pipeline one after another, until one of
+ * them succeeds.
+ *
+ * The strategies share their exploration state (recorded traces, nogoods and
+ * congruence closures), so that e.g. the full search continues the id-only
+ * search instead of starting over.
+ *
+ * @param pnode last Pnode of the list to be verified (followed by the dummy)
+ * @param pexstart Pnode at the beginning of the list
+ * @param idonly TRUE, if "ref=>" suggests to search among ids first (the
+ * budget of the id-only search is lifted)
+ * @param toplevel TRUE, if the list is at the top level of the file
+ *
+ * @return TRUE, if verification was successful
+ */
+unsigned short int run_strategies(Pnode* pnode, Pnode* pexstart,
+		unsigned short int idonly, unsigned short int toplevel)
+{
+	Strategy* st;
+	unsigned short int verified;
+	int i;
+
+	if (n_pipeline == 0) {
+		set_strategies(ST_DEFAULT);
+	}
+
+	verified = FALSE;
+	st_solved = NULL;
+	next_nogood_scope();
+
+	for (i = 0; i < n_pipeline && !verified && !budget_exhausted; i++) {
+		st = pipeline[i];
+
+		vq_effort = 0;
+		vq_budget = (idonly && st->fn == st_idonly) ? 0 : st->budget;
+		vq_exhausted = FALSE;
+		cert_begin();
+
+		verified = (toplevel || !st->toplevel) && st->fn(pnode, pexstart);
+
+		st->tried++;
+		st->effort += vq_effort;
+		if (verified) {
+			st->solved++;
+			st_solved = st->name;
+		} else if (vq_exhausted) {
+			st->exhausted++;
+			DBG_VERIFY(fprintf(stderr, SHELL_BROWN "<%s: budget exhausted>"
+						SHELL_RESET1, st->name););
+		}
+	}
+
+	vq_budget = 0;
+	clear_traces();
+	clear_cc();
+	return verified;
+}
+
+/**
+ * @brief Calculates a fingerprint of the pipeline (i.e. of the names and
+ * budgets of its strategies), as the outcome of a verification depends on it.
+ *
+ * @return fingerprint of the pipeline
+ */
+uint64_t pipeline_fp()
+{
+	uint64_t h;
+	char* c;
+	int i;
+
+	if (n_pipeline == 0) {
+		set_strategies(ST_DEFAULT);
+	}
+
+	h = n_pipeline;
+	for (i = 0; i < n_pipeline; i++) {
+		for (c = pipeline[i]->name; *c != '\0'; c++) {
+			h = mix_fp(h, (unsigned char) *c);
+		}
+		h = mix_fp(h, pipeline[i]->budget);
+	}
+	return h;
+}
+
+/**
+ * @brief Looks up the name of a strategy.
+ *
+ * @param name name of the strategy
+ *
+ * @return name of the strategy (valid until the program exits) or NULL, if
+ * there is no such strategy
+ */
+char* strategy_name(char* name)
+{
+	unsigned int i;
+
+	for (i = 0; i < N_STRATEGIES; i++) {
+		if (strcmp(name, strategies[i].name) == 0) {
+			return strategies[i].name;
+		}
+	}
+	return NULL;
+}
+
+/**
+ * @brief Gets the counters of all strategies (e.g. to be sent to another
+ * process, see jobs.c).
+ *
+ * @param stats array of at least ST_MAX strategies
+ */
+void get_strategy_stats(Strategy* stats)
+{
+	unsigned int i;
+
+	for (i = 0; i < N_STRATEGIES; i++) {
+		stats[i] = strategies[i];
+	}
+}
+
+/**
+ * @brief Adds counters (e.g. of another process) to those of all strategies.
+ *
+ * @param stats array of at least ST_MAX strategies
+ */
+void add_strategy_stats(Strategy* stats)
+{
+	unsigned int i;
+
+	for (i = 0; i < N_STRATEGIES; i++) {
+		strategies[i].tried += stats[i].tried;
+		strategies[i].solved += stats[i].solved;
+		strategies[i].exhausted += stats[i].exhausted;
+		strategies[i].effort += stats[i].effort;
+	}
+}
+
+/**
+ * @brief Prints statistics of all strategies in the pipeline.
+ */
+void print_strategy_stats()
+{
+	int i;
+
+	if (n_pipeline == 0) {
+		set_strategies(ST_DEFAULT);
+	}
+
+	fprintf(stderr, "%-10s %10s %10s %10s %10s %14s\n", "strategy", "budget",
+			"tried", "solved", "exhausted", "effort");
+	for (i = 0; i < n_pipeline; i++) {
+		fprintf(stderr, "%-10s %10llu %10lu %10lu %10lu %14llu\n",
+				pipeline[i]->name,
+				(unsigned long long) pipeline[i]->budget,
+				pipeline[i]->tried, pipeline[i]->solved,
+				pipeline[i]->exhausted,
+				(unsigned long long) pipeline[i]->effort);
+	}
+}
+
+/* --- budget --------------------------------------------------------------- */
+/**
+ * @brief Sets the budget of every list from a comma-separated list of limits,
+ * each of the form "<resource>:<limit>".
+ *
+ * @param spec list of limits (e.g. "comparisons:1000000,time:5000")
+ *
+ * @return FALSE, if the list is invalid
+ */
+unsigned short int set_budget(char* spec)
+{
+	char* list;
+	char* name;
+	char* limit;
+	char* end;
+	uint64_t* field;
+
+	list = (char*) malloc(sizeof(char) * (strlen(spec) + 1));
+	strcpy(list, spec);
+	memset(&budget, 0, sizeof(Budget));
+
+	for (name = strtok(list, ","); name != NULL; name = strtok(NULL, ",")) {
+		limit = strchr(name, ':');
+		if (limit != NULL) {
+			*limit++ = '\0';
+		}
+
+		if (strcmp(name, "comparisons") == 0) {
+			field = &(budget.comparisons);
+		} else if (strcmp(name, "substitutions") == 0) {
+			field = &(budget.substitutions);
+		} else if (strcmp(name, "time") == 0) {
+			field = &(budget.time_ms);
+		} else if (strcmp(name, "memory") == 0) {
+			field = &(budget.memory);
+		} else {
+			fprintf(stderr, "unknown resource '%s'\n", name);
+			free(list);
+			return FALSE;
+		}
+
+		if (limit == NULL || *limit == '\0'
+				|| (*field = strtoull(limit, &end, 10), *end != '\0')) {
+			fprintf(stderr, "invalid limit '%s' for resource '%s'\n",
+					limit != NULL ? limit : "", name);
+			free(list);
+			return FALSE;
+		}
+	}
+
+	free(list);
+	budget_active = (budget.comparisons != 0 || budget.substitutions != 0
+			|| budget.time_ms != 0 || budget.memory != 0);
+	return TRUE;
+}
+
+/**
+ * @brief Measures the bytes allocated on the heap (or the peak resident set
+ * size, where the allocator cannot be queried).
+ *
+ * @return bytes allocated
+ */
+static uint64_t heap_bytes()
+{
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+	struct mallinfo2 mi;
+
+	mi = mallinfo2();
+	return mi.uordblks + mi.hblkhd;
+#else
+	struct rusage usage;
+
+	getrusage(RUSAGE_SELF, &usage);
+	return (uint64_t) usage.ru_maxrss * 1024;
+#endif
+}
+
+/**
+ * @brief Starts the budget of a list (before the cache is looked up and the
+ * strategies are tried).
+ */
+void start_budget()
+{
+	budget_exhausted = FALSE;
+	if (!budget_active) {
+		return;
+	}
+
+	budget_comparisons = perf.comparisons;
+	budget_substitutions = perf.substitutions;
+	budget_polls = 0;
+	if (budget.time_ms != 0) {
+		clock_gettime(BUDGET_CLOCK, &budget_time);
+	}
+	if (budget.memory != 0) {
+		budget_memory = heap_bytes();
+	}
+}
+
+/**
+ * @brief Checks, whether the budget of the current list has run out. The time
+ * is measured on every check, the memory only every BUDGET_POLL checks.
+ *
+ * @return TRUE, if the search has to be stopped
+ */
+unsigned short int check_budget()
+{
+	struct timespec now;
+	uint64_t elapsed_ms;
+	uint64_t mem;
+
+	if (budget_exhausted) {
+		return TRUE;
+	}
+
+	if ((budget.comparisons != 0
+				&& perf.comparisons - budget_comparisons > budget.comparisons)
+			|| (budget.substitutions != 0 && perf.substitutions
+				- budget_substitutions > budget.substitutions)) {
+		budget_exhausted = TRUE;
+	} else if (budget.time_ms != 0) {
+		clock_gettime(BUDGET_CLOCK, &now);
+		elapsed_ms = (now.tv_sec - budget_time.tv_sec) * 1000
+			+ (now.tv_nsec - budget_time.tv_nsec) / 1000000;
+		budget_exhausted = (elapsed_ms > budget.time_ms);
+	}
+	if (!budget_exhausted && budget.memory != 0
+			&& ++budget_polls % BUDGET_POLL == 0
+			&& (mem = heap_bytes()) > budget_memory
+			&& mem - budget_memory > budget.memory) {
+		budget_exhausted = TRUE;
+	}
+
+	return budget_exhausted;
+}
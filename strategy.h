@@ -0,0 +1,99 @@
+/* [prove]: A proof verification system using bracketed expressions.
+ * Copyright (C) 2021  Gregor Feierabend
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef STRATEGY_H
+#define STRATEGY_H
+
+#include <stdint.h>
+#include "pgraph.h"
+
+/* maximal number of strategies in the pipeline */
+#define ST_MAX 16
+
+/* default pipeline; the budget of a strategy may be given after a colon */
+#define ST_DEFAULT "facts,idonly:2000,full,forward,cases"
+
+/**
+ * @brief Verification strategy.
+ *
+ * @param pnode last Pnode of the list to be verified (followed by the dummy)
+ * @param pexstart Pnode at the beginning of the list
+ *
+ * @return TRUE, if verification was successful
+ */
+typedef unsigned short int (*StrategyFn)(Pnode* pnode, Pnode* pexstart);
+
+typedef struct strategy {
+	char* name;
+	StrategyFn fn;
+	unsigned short int toplevel;/* TRUE, if only lists at the top level of the
+								   file are tried */
+	uint64_t budget;			/* maximal effort (0 for unlimited) */
+	unsigned long int tried;	/* number of lists tried */
+	unsigned long int solved;	/* number of lists verified */
+	unsigned long int exhausted;/* number of times the budget ran out */
+	uint64_t effort;			/* total effort spent */
+} Strategy;
+
+/* name of the strategy, which verified the last list (NULL if none) */
+char* st_solved;
+
+/* limits of the effort spent on a single list, however many strategies are
+ * tried (0 for unlimited) */
+typedef struct budget {
+	uint64_t comparisons;	/* calls of const_equal */
+	uint64_t substitutions;	/* substitutions made */
+	uint64_t time_ms;		/* wall clock time in milliseconds */
+	uint64_t memory;		/* bytes allocated on the heap */
+} Budget;
+
+/* number of checks, after which the memory is measured again */
+#define BUDGET_POLL 1024
+/* units of a step of the search, after which the budget is checked (see
+ * search_step) */
+#define BUDGET_STEP 64
+
+Budget budget;
+unsigned short int budget_active;		/* TRUE, if any limit is set */
+unsigned short int budget_exhausted;	/* TRUE, if the budget of the current
+										   list has run out */
+unsigned long int n_unknown;			/* number of lists, whose budget has
+										   run out */
+
+/* checked between the steps of a search, which is aborted, and in the loops
+ * of other explorers, which are stopped as if no reachable sub-trees were
+ * left */
+#define BUDGET_EXHAUSTED() (budget_active && check_budget())
+
+unsigned short int set_strategies(char* spec);
+unsigned short int run_strategies(Pnode* pnode, Pnode* pexstart,
+		unsigned short int idonly, unsigned short int toplevel);
+void print_strategy_stats();
+
+unsigned short int set_budget(char* spec);
+void start_budget();
+unsigned short int check_budget();
+
+/* for parallel verification (see jobs.c) */
+void get_strategy_stats(Strategy* stats);
+void add_strategy_stats(Strategy* stats);
+
+/* for the verification cache (see cert.c) */
+uint64_t pipeline_fp();
+char* strategy_name(char* name);
+
+#endif /* STRATEGY_H */
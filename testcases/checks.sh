@@ -0,0 +1,381 @@
+#!/bin/bash
+# Checks of features, which cannot be tested by verifying a single testcase
+# (e.g. images, certificates or the parallel modes): every check runs the
+# binary in different ways and compares the outcomes. Failures are appended to
+# testcases/out/report_failure.txt like those of the testcases.
+#
+# usage: checks.sh [<proveparser binary>]
+#
+# The script exits with 1, if any check fails.
+
+BIN=${1:-bin/proveparser}
+DIR=$(dirname "$0")
+OUT=$DIR/out/checks
+REPORT=$DIR/out/report_failure.txt
+
+if [ ! -x "$BIN" ]
+then
+	echo "cannot execute '$BIN'" >&2
+	exit 1
+fi
+
+rm -rf "$OUT"
+mkdir -p "$OUT"
+S=0
+
+# Prints the outcome of a check and reports a failure together with the output
+# of the binary.
+#
+# usage: report <name> <status (0 for success)> [<file with output>]
+report()
+{
+	if [ "$2" -eq 0 ]
+	then
+		printf "%-50s[\033[0;32m success \033[0;0m]\n" "$1"
+	else
+		printf "%-50s[\033[0;31m failure \033[0;0m]\n" "$1"
+		printf ">>> [CHECK] %s:\n" "$1" >> "$REPORT"
+		if [ -n "$3" ]
+		then
+			sed 's/^/    /g' "$3" >> "$REPORT"
+		fi
+		printf "\n" >> "$REPORT"
+		S=1
+	fi
+}
+
+printf "\nChecking features:\n"
+
+# --- images -------------------------------------------------------------------
+# a library is compiled to an image, which has to be loaded as it is
+# ("intact", exit code 0), but rejected (exit code 1) after any of its bytes
+# has been corrupted
+$BIN $DIR/valid/Or.prove --compile=$OUT/Or.img > /dev/null 2>&1
+for O in intact 8 240 272 576 1080 5000 6400
+do
+	cp $OUT/Or.img $OUT/corrupt.img
+	EXPECTED=0
+	if [ $O != intact ]
+	then
+		printf '\252' | dd of=$OUT/corrupt.img bs=1 seek=$O conv=notrunc \
+			2> /dev/null
+		EXPECTED=1
+	fi
+	$BIN $DIR/valid/Or.prove --library=$OUT/corrupt.img \
+		> $OUT/corrupt.out 2>&1
+	[ $? -eq $EXPECTED ]
+	report "image ($O)" $? $OUT/corrupt.out
+done
+
+# --- strategies ---------------------------------------------------------------
+# a strategy given twice would share its budget and statistics with itself,
+# hence the pipeline is refused
+$BIN $DIR/valid/Not.prove --strategies=idonly:100,full,idonly:5000 \
+	> $OUT/strategies.out 2>&1
+[ $? -eq 1 ] && grep -q "more than once" $OUT/strategies.out
+report "strategies (duplicate)" $? $OUT/strategies.out
+
+# --- serve --------------------------------------------------------------------
+# the server answers every request on its own line with the status of the text:
+# "verified", "failed" (a list has not been verified) or "error" (the text or
+# the request could not be parsed, e.g. because of an illegal character)
+
+# Prints a request with the contents of a file as text.
+#
+# usage: request <id> <file>
+request()
+{
+	printf '{"id":%d,"file":"%s","text":"' $1 "$2"
+	sed -e 's/\\/\\\\/g' -e 's/"/\\"/g' "$2" | awk '{ printf "%s\\n", $0 }'
+	printf '"}\n'
+}
+
+printf '[a]\n[b] {\n' > $OUT/illegal.prove
+(request 1 $DIR/valid/Not.prove; request 2 $DIR/invalid/wrongimp.prove;
+	request 3 $OUT/illegal.prove; echo "[a]") | $BIN --serve \
+	> $OUT/serve.out 2>&1
+grep -o '"id":[0-9]*,"status":"[a-z]*"' $OUT/serve.out > $OUT/serve.status
+printf '%s\n' '"id":1,"status":"verified"' '"id":2,"status":"failed"' \
+	'"id":3,"status":"error"' '"id":0,"status":"error"' \
+	| cmp -s - $OUT/serve.status
+report "serve" $? $OUT/serve.out
+
+# --- certificates -------------------------------------------------------------
+# a certificate is replayed onto the file it has been written for, but refused
+# for a proof, which does not hold any more (with the same positions of the
+# lists), and if it has been truncated or edited
+cp $DIR/valid/russel2.prove $OUT/cert.prove
+$BIN $OUT/cert.prove --cert=$OUT/cert.cert > $OUT/cert.out 2>&1 \
+	&& $BIN $OUT/cert.prove --replay=$OUT/cert.cert >> $OUT/cert.out 2>&1
+report "certificate (replay)" $? $OUT/cert.out
+
+sed '$s/False/Falsa/' $OUT/cert.prove > $OUT/mutated.prove
+$BIN $OUT/mutated.prove --replay=$OUT/cert.cert > $OUT/cert.out 2>&1
+[ $? -eq 1 ] && grep -q "certificate rejected" $OUT/cert.out
+report "certificate (invalid proof)" $? $OUT/cert.out
+
+for C in truncated cut header edited
+do
+	case $C in
+		truncated) head -n 10 $OUT/cert.cert ;;
+		cut) head -c -4 $OUT/cert.cert ;;
+		header) head -c 8 $OUT/cert.cert ;;
+		edited) sed 's/^q 60 35 39 0$/q 60 35 41 0/' $OUT/cert.cert ;;
+	esac > $OUT/broken.cert
+	: > $OUT/cert.out
+	! cmp -s $OUT/cert.cert $OUT/broken.cert \
+		&& $BIN $OUT/cert.prove --replay=$OUT/broken.cert > $OUT/cert.out 2>&1
+	[ $? -eq 1 ] && grep -q "certificate" $OUT/cert.out
+	report "certificate ($C)" $? $OUT/cert.out
+done
+
+# --- cache --------------------------------------------------------------------
+# the lists of an unchanged file are all found in the cache, after an edit only
+# the lists from the edited statement onwards are searched again, and entries,
+# whose justifications do not hold (e.g. taken from another list), are ignored
+# and replaced
+
+# Verifies a file with the cache and checks its exit code and the number of
+# cache hits and misses.
+#
+# usage: cached <name> <file> <exit code> <hits> <misses>
+cached()
+{
+	$BIN $2 --cache=$OUT/cache --stats > $OUT/cache.out 2>&1
+	[ $? -eq $3 ] && grep -q "cache: $4 hits, $5 misses" $OUT/cache.out
+	report "cache ($1)" $? $OUT/cache.out
+}
+
+cp $DIR/valid/russel2.prove $OUT/cache.prove
+sed '$s/.*/[[A]in[A]]/' $OUT/cache.prove > $OUT/last.prove
+sed '1s/x/y/g' $OUT/cache.prove > $OUT/first.prove
+cached miss $OUT/cache.prove 0 0 7
+cached hit $OUT/cache.prove 0 7 0
+cached "last statement edited" $OUT/last.prove 0 6 1
+cached "first statement edited" $OUT/first.prove 0 0 7
+
+# the entry of the last list of the invalid proof (see certificates) is
+# replaced by the record of the valid proof, or by garbage
+ls $OUT/cache > $OUT/cache.before
+cached "failed list" $OUT/mutated.prove 1 6 1
+E=$OUT/cache/$(ls $OUT/cache | comm -13 $OUT/cache.before -)
+grep -v "^s 9 10 -$" $E > $OUT/poisoned.cert
+sed -n '/^s 9 10 /,$p' $OUT/cert.cert >> $OUT/poisoned.cert
+cp $OUT/poisoned.cert $E
+cached "poisoned entry" $OUT/mutated.prove 1 6 1
+printf 'garbage\n' > $E
+cached "garbage entry" $OUT/mutated.prove 1 6 1
+cached "replaced entry" $OUT/mutated.prove 1 7 0
+
+# --- parallel verification ----------------------------------------------------
+# the profile records, the output and the exit code of every testcase are the
+# same as those of a sequential run (apart from the measured times)
+
+# Verifies a file and writes its profile records and output (without the
+# measured times) and its exit code to <name>.out and its errors to <name>.err.
+#
+# usage: records <name> <file> [<options>]
+records()
+{
+	N=$OUT/$1
+	F=$2
+	shift 2
+	$BIN $F --profile=json --dfinish "$@" 2> $N.err \
+		| sed 's/"wall_ns":[0-9]*,"cpu_ns":[0-9]*,//' > $N.out
+	echo "exit ${PIPESTATUS[0]}" >> $N.out
+}
+
+# Compares the outcomes of all testcases verified with the given options to
+# those of a sequential run.
+#
+# usage: same <name> <options>
+same()
+{
+	NAME=$1
+	shift
+	: > $OUT/same.diff
+	for F in $DIR/valid/*.prove $DIR/invalid/*.prove
+	do
+		records seq $F
+		records opt $F "$@"
+		if ! (diff $OUT/seq.out $OUT/opt.out && diff $OUT/seq.err $OUT/opt.err) \
+			> $OUT/file.diff
+		then
+			echo "$F:" >> $OUT/same.diff
+			cat $OUT/file.diff >> $OUT/same.diff
+		fi
+	done
+	[ ! -s $OUT/same.diff ]
+	report "$NAME" $? $OUT/same.diff
+}
+
+same "jobs (1)" --jobs=1
+same "jobs (4)" --jobs=4
+same "pipeline (1)" --pipeline=1
+same "pipeline" --pipeline
+
+# --- coordinated verification -------------------------------------------------
+# the records and the files, which have not been verified, are the same as for
+# sequential runs of every file, also if a worker disconnects after it has
+# received a shard (which is then dispatched to another worker)
+: > $OUT/seq.rec
+: > $OUT/seq.failed
+for F in $DIR/valid/*.prove $DIR/invalid/*.prove
+do
+	$BIN $F --profile=json 2> /dev/null | grep '^{' \
+		| sed 's/"wall_ns":[0-9]*,"cpu_ns":[0-9]*,//' >> $OUT/seq.rec
+	[ ${PIPESTATUS[0]} -eq 0 ] || echo $F >> $OUT/seq.failed
+done
+
+# Starts the coordinator of all testcases in the background.
+#
+# usage: coordinator <address>
+coordinator()
+{
+	$BIN --coordinate=$1 $DIR/valid/*.prove $DIR/invalid/*.prove \
+		--profile=json > $OUT/co.out 2> $OUT/co.err &
+	CO=$!
+}
+
+# Waits for the coordinator (and its workers) and compares its records and the
+# files, which have not been verified, with those of the sequential runs.
+#
+# usage: coordinated <name>
+coordinated()
+{
+	wait $CO
+	CODE=$?
+	wait
+	grep '^{' $OUT/co.out | sed 's/"wall_ns":[0-9]*,"cpu_ns":[0-9]*,//' \
+		> $OUT/co.rec
+	sed -n "/module '/d; s/^[^']*'\(.*\)' has not been verified.*/\1/p" \
+		$OUT/co.err > $OUT/co.failed
+	(cat $OUT/co.err; diff $OUT/seq.rec $OUT/co.rec \
+		&& diff $OUT/seq.failed $OUT/co.failed) > $OUT/co.diff
+	[ $? -eq 0 ] && [ $CODE -eq 1 ]
+	report "$1" $? $OUT/co.diff
+}
+
+# a worker, which starts after the coordinator has finished, cannot connect
+coordinator $OUT/co.sock
+$BIN --worker=$OUT/co.sock 2> $OUT/worker1.err &
+$BIN --worker=$OUT/co.sock 2> $OUT/worker2.err &
+$BIN --worker=$OUT/co.sock 2> $OUT/worker3.err &
+coordinated "coordinate"
+
+# the first worker reads a shard and disconnects, before the second one starts
+P=$((20000 + RANDOM % 20000))
+coordinator 127.0.0.1:$P
+for I in $(seq 50)
+do
+	{ exec 3<> /dev/tcp/127.0.0.1/$P; } 2> /dev/null && break
+	sleep 0.1
+done
+read -r -t 10 L <&3
+exec 3<&-
+$BIN --worker=127.0.0.1:$P
+coordinated "coordinate (worker failed)"
+grep -q "dispatched again" $OUT/co.err
+report "coordinate (shard dispatched again)" $? $OUT/co.err
+
+# --- profile ------------------------------------------------------------------
+# every line printed with --profile=json is a JSON object with the fields
+# documented in README.md, which names the file verified (even if its name has
+# to be escaped)
+cp $DIR/valid/russel2.prove "$OUT/pro\"file\\.prove"
+for F in $DIR/valid/*.prove $DIR/invalid/*.prove "$OUT/pro\"file\\.prove"
+do
+	$BIN "$F" --profile=json --dfinish 2> /dev/null | python3 -c '
+import json, sys
+
+FIELDS = ["file", "line", "col", "result", "strategy", "wall_ns", "cpu_ns",
+		"comparisons", "substitutions", "max_depth", "vq_recurs",
+		"asmp_lookups", "branches", "nogoods"]
+
+for line in sys.stdin:
+	r = json.loads(line)
+	assert list(r) == FIELDS, line
+	assert r["file"] == sys.argv[1], line
+	assert r["result"] in ["verified", "failed", "postponed", "unknown"], line
+	assert (r["strategy"] is None) == (r["result"] != "verified"), line
+	for f in FIELDS[5:] + ["line", "col"]:
+		assert type(r[f]) == int and r[f] >= 0, line
+' "$F"
+done > $OUT/profile.out 2>&1
+[ ! -s $OUT/profile.out ]
+report "profile (json)" $? $OUT/profile.out
+
+# --- verdicts -----------------------------------------------------------------
+# the search finds the same verdicts, if it does not skip the sub-goals, which
+# are known to fail (the nogoods, which are hit by some testcases), if it
+# explores the reachable sub-trees again instead of replaying their traces, and
+# if it is suspended and resumed after every few units and aborted once
+
+# Verifies a file and writes "<line>:<col> <result>" of every list and the exit
+# code to <name>.out.
+#
+# usage: verdicts <name> <file> [<options>]
+verdicts()
+{
+	N=$OUT/$1
+	F=$2
+	shift 2
+	$BIN $F --profile=json --dfinish "$@" 2> /dev/null | sed \
+		's/.*"line":\([0-9]*\),"col":\([0-9]*\),"result":"\([a-z]*\)".*/\1:\2 \3/' \
+		> $N.out
+	echo "exit ${PIPESTATUS[0]}" >> $N.out
+}
+
+# Compares the verdicts of all testcases verified with the given options to
+# those of a run with the default options.
+#
+# usage: agree <name> <options>
+agree()
+{
+	NAME=$1
+	shift
+	: > $OUT/agree.diff
+	for F in $DIR/valid/*.prove $DIR/invalid/*.prove
+	do
+		verdicts def $F
+		verdicts opt $F "$@"
+		if ! diff $OUT/def.out $OUT/opt.out > $OUT/file.diff
+		then
+			echo "$F:" >> $OUT/agree.diff
+			cat $OUT/file.diff >> $OUT/agree.diff
+		fi
+	done
+	[ ! -s $OUT/agree.diff ]
+	report "$NAME" $? $OUT/agree.diff
+}
+
+for F in $DIR/valid/*.prove $DIR/invalid/*.prove
+do
+	$BIN $F --profile=json --dfinish 2> /dev/null
+done | sed -n 's/.*"nogoods":\([1-9][0-9]*\)}$/\1/p' > $OUT/nogoods.out
+[ -s $OUT/nogoods.out ]
+report "nogoods (hit)" $? $OUT/nogoods.out
+agree "nogoods (disabled)" --nonogoods
+agree "traces (disabled)" --notraces
+agree "search (steps of 1)" --dsteps=1
+agree "search (steps of 7)" --dsteps=7
+
+# --- budget -------------------------------------------------------------------
+# the search for the lists of a generated invalid proof, which takes seconds,
+# is stopped by the time budget of every list (within twice the budget), and
+# the lists are reported as unknown
+$DIR/../bench/genproof.sh vars 6 invalid > $OUT/budget.prove
+START=$(date +%s%N)
+$BIN $OUT/budget.prove --budget=time:500 --profile=json > $OUT/budget.out \
+	2> $OUT/budget.err
+CODE=$?
+END=$(date +%s%N)
+cat $OUT/budget.err >> $OUT/budget.out
+echo "exit $CODE, $(( (END - START) / 1000000 )) ms" >> $OUT/budget.out
+[ $CODE -eq 1 ] && [ $(( (END - START) / 1000000 )) -lt 3000 ] \
+	&& ! grep '^{' $OUT/budget.out | grep -v '"result":"unknown"' \
+	&& ! grep -q '"wall_ns":[0-9]\{10\}' $OUT/budget.out \
+	&& grep -q "budget exhausted" $OUT/budget.out
+report "budget (time)" $? $OUT/budget.out
+
+exit $S
@@ -20,6 +20,8 @@
 #include <stdio.h>
 #include "pgraph.h"
 #include "verify.h"
+#include "cert.h"
+#include "strategy.h"
 #include "debug.h"
 
 #ifdef DVERIFY
@@ -42,10 +44,39 @@
 unsigned short int check_asmp(Pnode* perspective, Pnode** pexplorer,
 		unsigned short int exst);
 void finish_sub(VFlags* vflags, SUB** subd);
+void unsub_var(SUB* s);
 unsigned short int next_forwards(Pnode* perspective, Pnode** pexplorer,
 		Eqwrapper** eqwrapper, BC** checkpoint, VFlags* vflags, unsigned short
 		int p_a);
 
+/* --- steps of the search -------------------------------------------------- */
+static uint64_t step_left;					/* units left in the current step */
+static unsigned short int step_limited;		/* TRUE, while a step is limited */
+static unsigned short int step_suspended;	/* TRUE, if the units of the
+											   current step have run out */
+
+/**
+ * @brief Counts a unit of the search, which is run in limited steps (see
+ * search_step). A unit is a reachable sub-tree examined or a move of the
+ * explorer in next_backwards, so that every step ends after a bounded amount
+ * of work.
+ *
+ * @return TRUE, if the units of the step have run out and the search is to be
+ * suspended
+ */
+static unsigned short int suspend_search()
+{
+	if (!step_limited) {
+		return FALSE;
+	}
+	if (step_left == 0) {
+		step_suspended = TRUE;
+		return TRUE;
+	}
+	step_left--;
+	return FALSE;
+}
+
 /* --- verification specific movement functions ----------------------------- */
 /**
  * @brief Moves pexplorer to the right, if possible. Wrap around to the left, if
@@ -140,6 +171,27 @@ void sub_var(SUB* s)
 	/* number has to be substituted to ensure correct handling of existential
 	 * quantifiers */
 	s->vtree->pnode->parent->num = s->known_const->num;
+
+	bind_fp ^= s->fp;
+	s->fp = mix_fp(NODE_FP(s->vtree->pnode), NODE_FP(s->known_const));
+	bind_fp ^= s->fp;
+}
+
+/**
+ * @brief Substitutes the original identifier back into the variable specified
+ * in SUB.
+ *
+ * @param s SUB structure to be operated on
+ */
+void unsub_var(SUB* s)
+{
+	*(s->vtree->pnode->symbol) = s->sym;
+	s->vtree->pnode->parent->num = s->num;
+	*(s->vtree->pnode->child) = NULL;
+	*(s->vtree->pnode->right) = NULL;
+
+	bind_fp ^= s->fp;
+	s->fp = 0;
 }
 
 /**
@@ -178,6 +230,7 @@ unsigned short int next_sub(Pnode* perspective, SUB* s,
 				s_iter = s_iter->prev;
 			} else {
 				sub_var(s_iter);
+				PERF_INC(substitutions)
 				return TRUE;
 			}
 	}
@@ -227,6 +280,7 @@ unsigned short int init_sub(Pnode* perspective, VTree* vtree, VFlags* vflags,
 				(*subd)->sym = *(vtree->pnode->symbol);
 				(*subd)->num = vtree->pnode->parent->num;
 				(*subd)->vtree = vtree;
+				(*subd)->fp = 0;
 
 				if (!init_known_const(perspective, *subd, idonly, exst,
 							exnum)) {
@@ -240,6 +294,7 @@ unsigned short int init_sub(Pnode* perspective, VTree* vtree, VFlags* vflags,
 		} while (vtree != NULL);
 
 		SET_VFLAG_SUBD(*vflags)
+		PERF_INC(substitutions)
 		return TRUE;
 	} else {
 		return FALSE;
@@ -266,10 +321,7 @@ void finish_sub(VFlags* vflags, SUB** subd)
 	do {
 		prev_sub = (*subd)->prev;
 
-		*((*subd)->vtree->pnode->symbol) = (*subd)->sym;
-		(*subd)->vtree->pnode->parent->num = (*subd)->num;
-		*((*subd)->vtree->pnode->child) = NULL;
-		*((*subd)->vtree->pnode->right) = NULL;
+		unsub_var(*subd);
 
 		UNSET_VARFLAG_LOCK(((*subd)->vtree->flags))
 
@@ -330,7 +382,9 @@ void bc_push(Pnode** pexplorer, Eqwrapper** eqwrapper, BC** checkpoint,
 	bctos->pwrapper = (*eqwrapper)->pwrapper;
 	bctos->pendwrap = (*eqwrapper)->pendwrap;
 	bctos->above = *checkpoint;
+	bctos->depth = (*checkpoint == NULL) ? 1 : (*checkpoint)->depth + 1;
 	*checkpoint = bctos;
+	PERF_MAX(max_depth, bctos->depth)
 }
 
 /**
@@ -376,6 +430,72 @@ unsigned short int bc_pop(Pnode** pnode, Eqwrapper** eqwrapper, BC** checkpoint,
 	return TRUE;
 }
 
+/**
+ * @brief Copies a BC stack.
+ *
+ * @param checkpoint top of the stack to be copied
+ *
+ * @return top of the copy
+ */
+BC* bc_copy(BC* checkpoint)
+{
+	BC* copy;
+	BC** bciter;
+
+	bciter = &copy;
+	for (; checkpoint != NULL; checkpoint = checkpoint->above) {
+		*bciter = (BC*) malloc(sizeof(BC));
+		**bciter = *checkpoint;
+		bciter = &((*bciter)->above);
+	}
+	*bciter = NULL;
+
+	return copy;
+}
+
+/**
+ * @brief Frees a BC stack.
+ *
+ * @param checkpoint top of the stack to be freed
+ */
+void bc_free(BC* checkpoint)
+{
+	BC* bcold;
+
+	while (checkpoint != NULL) {
+		bcold = checkpoint;
+		checkpoint = checkpoint->above;
+		free(bcold);
+	}
+}
+
+/**
+ * @brief Calculates a fingerprint of the state of an explorer moving forwards
+ * (everything next_forwards depends on apart from the current position).
+ *
+ * @param eqwrapper Wrapping information
+ * @param checkpoint BC stack
+ * @param vflags verification flags
+ *
+ * @return fingerprint of the state
+ */
+uint64_t explorer_fp(Eqwrapper* eqwrapper, BC* checkpoint, VFlags vflags)
+{
+	uint64_t h;
+
+	h = mix_fp(vflags & (VFLAG_WRAP | VFLAG_FRST),
+			NODE_FP(eqwrapper->pwrapper));
+	h = mix_fp(h, NODE_FP(eqwrapper->pendwrap));
+	for (; checkpoint != NULL; checkpoint = checkpoint->above) {
+		h = mix_fp(h, NODE_FP(checkpoint->pnode));
+		h = mix_fp(h, (checkpoint->wrap << 1) | checkpoint->frst);
+		h = mix_fp(h, NODE_FP(checkpoint->pwrapper));
+		h = mix_fp(h, NODE_FP(checkpoint->pendwrap));
+	}
+
+	return h;
+}
+
 /**
  * @brief Moves pexplorer to its child node, if it is considered EXPLORABLE.
  *
@@ -656,6 +776,44 @@ unsigned short int next_forwards(Pnode* veri_persp, Pnode** pexplorer,
 	return TRUE;
 }
 
+/**
+ * @brief Enters the branch at pexplorer, if it is explorable, and moves
+ * pexplorer to the first reachable sub-tree within it.
+ *
+ * @param veri_perspec Pnode from whose perspective assumptions are verified
+ * @param pexplorer Pnode pointer exploring the branch
+ * @param eqwrapper Wrapping information
+ * @param checkpoint BC stack holding information corresponding to a level
+ * @param vflags verification flags
+ * @param p_a TRUE, if assumptions are to be processed
+ *
+ * @return FALSE, if the branch has been entered, but has no reachable
+ * sub-trees (the branch has been exited again)
+ */
+static unsigned short int enter_branch(Pnode* veri_perspec, Pnode** pexplorer,
+		Eqwrapper** eqwrapper, BC** checkpoint, VFlags* vflags,
+		unsigned short int p_a)
+{
+	/* known equalities are handled by congruence closure (see check_eq) */
+	if (EXPLORABLE(pexplorer) && !(p_a && veri_perspec != NULL
+				&& veri_perspec->prev_eq != NULL
+				&& (*pexplorer)->vtree == NULL && IS_EQUALITY((*pexplorer)))) {
+		bc_push(pexplorer, eqwrapper, checkpoint, vflags);
+		*pexplorer = *((*pexplorer)->child);
+		SET_VFLAG_BRCH(*vflags)
+		UNSET_VFLAG_FAIL(*vflags)
+		PERF_INC(branches)
+		if (!next_forwards(veri_perspec, pexplorer, eqwrapper, checkpoint,
+					vflags, p_a)) {
+			exit_branch(pexplorer, eqwrapper, checkpoint, vflags);
+			return FALSE;
+		}
+	} else {
+		UNSET_VFLAG_BRCH(*vflags)
+	}
+	return TRUE;
+}
+
 /**
  * @brief Attempts to explore a new branch (as opposed to trying to explore a
  * sub-branch)
@@ -682,20 +840,11 @@ unsigned short int attempt_explore(Pnode* veri_perspec, Pnode* sub_perspec,
 		unsigned short int exst, int exnum, unsigned short int do_sub,
 		unsigned short int p_a)
 {
-	if (EXPLORABLE(pexplorer)) {
-		bc_push(pexplorer, eqwrapper, checkpoint, vflags);
-		*pexplorer = *((*pexplorer)->child);
-		SET_VFLAG_BRCH(*vflags)
-		UNSET_VFLAG_FAIL(*vflags)
-		if (!next_forwards(veri_perspec, pexplorer, eqwrapper, checkpoint,
-					vflags, p_a)) {
-			exit_branch(pexplorer, eqwrapper, checkpoint, vflags);
-			return next_backwards(veri_perspec, sub_perspec,
-					pexplorer, eqwrapper, checkpoint, vflags, subd, idonly,
-					exst, exnum, do_sub, p_a);
-		}
-	} else {
-		UNSET_VFLAG_BRCH(*vflags)
+	if (!enter_branch(veri_perspec, pexplorer, eqwrapper, checkpoint, vflags,
+				p_a)) {
+		return next_backwards(veri_perspec, sub_perspec,
+				pexplorer, eqwrapper, checkpoint, vflags, subd, idonly,
+				exst, exnum, do_sub, p_a);
 	}
 	return TRUE;
 }
@@ -737,15 +886,32 @@ unsigned short int next_backwards(Pnode* veri_perspec,
 			return TRUE;
 		} 
 
+		/* the enumeration of substitutions and the backtracking are
+		 * suspended at the end of a step of the search, or stopped by the
+		 * budget outside of searches, as if no reachable sub-trees were left
+		 * (see next_reachable); all state of the movement is kept in the
+		 * explorer, eqwrapper, checkpoint, vflags and subd, so that calling
+		 * the function again resumes it here */
+		if (step_limited ? suspend_search() : BUDGET_EXHAUSTED()) {
+			return FALSE;
+		}
+
 		/* substitution */
 		if (do_sub && HAS_VFLAG_SUBD(*vflags)) {
 
 			if (next_sub(sub_perspec, *subd, idonly, exst, exnum)) {
-				return attempt_explore(veri_perspec, sub_perspec, pexplorer,
-						eqwrapper, checkpoint, vflags, subd, idonly, exst,
-						exnum, do_sub, p_a);
+				if (enter_branch(veri_perspec, pexplorer, eqwrapper,
+							checkpoint, vflags, p_a)) {
+					return TRUE;
+				}
+				continue;
 			} else {
 				finish_sub(vflags, subd);
+				trace_event(*pexplorer, TR_REND, TRUE);
+				if (HAS_VFLAG_RGN(*vflags)) {
+					UNSET_VFLAG_RGN(*vflags)
+					return FALSE;
+				}
 				continue;
 			}
 		}
@@ -763,19 +929,248 @@ unsigned short int next_backwards(Pnode* veri_perspec,
 			continue;
 		} else {
 			if (do_sub && (*pexplorer)->vtree != NULL) {
-				init_sub(sub_perspec, (*pexplorer)->vtree,
-						vflags, subd, idonly, exst, exnum);
+				trace_event(*pexplorer, TR_SUBST, init_sub(sub_perspec,
+							(*pexplorer)->vtree, vflags, subd, idonly, exst,
+							exnum));
+			}
+			if (enter_branch(veri_perspec, pexplorer, eqwrapper, checkpoint,
+						vflags, p_a)) {
+				return TRUE;
 			}
-			return attempt_explore(veri_perspec, sub_perspec, pexplorer,
-					eqwrapper, checkpoint, vflags, subd, idonly,
-					exst, exnum, do_sub, p_a);
 		}
-		break;
 	} while (TRUE);
 
 	return FALSE;
 }
 
+/* --- replay of reachable sub-trees ---------------------------------------- */
+/**
+ * @brief Initialises the replay status of an explorer. If an explorer with the
+ * same perspectives has been moved before (while verifying the same
+ * statement), its trace is replayed; otherwise a new trace is recorded.
+ *
+ * @param rp replay status to be initialised
+ * @param pexstart Pnode, at which exploration starts
+ * @param veri_perspec Pnode from whose perspective assumptions are verified
+ * @param sub_perspec Pnode from whose perspective substitutions are done
+ * @param exst TRUE if doing a backwards substitution for existence verification
+ * @param exnum Pnode number which must not be exceeded by replaced constants
+ * @param do_sub TRUE, if substitutions are to be made
+ * @param p_a TRUE, if assumptions are to be processed
+ */
+void init_replay(Replay* rp, Pnode* pexstart, Pnode* veri_perspec,
+		Pnode* sub_perspec, unsigned short int exst, int exnum,
+		unsigned short int do_sub, unsigned short int p_a)
+{
+	unsigned short int opts;
+
+	/* idonly is not part of the key: the result of every substitution is
+	 * checked again during replay, so that a trace recorded during the id-only
+	 * search can be continued by the full search */
+	opts = (exst << 1) | (do_sub << 2) | (p_a << 3);
+
+	rp->pexstart = pexstart;
+	rp->pos = 0;
+	rp->delivered = 0;
+	rp->skip = 0;
+	rp->in_region = FALSE;
+	rp->suspended = FALSE;
+	rp->rec = NULL;
+	rp->trace = find_trace(pexstart, veri_perspec, sub_perspec, exnum, opts);
+	if (rp->trace == NULL) {
+		rp->rec = new_trace(pexstart, veri_perspec, sub_perspec, exnum, opts);
+	}
+}
+
+/**
+ * @brief Stores the trace recorded by an explorer (even if exploration has not
+ * been completed).
+ *
+ * @param rp replay status of the explorer
+ */
+void finish_replay(Replay* rp)
+{
+	if (rp->rec != NULL) {
+		store_trace(rp->rec);
+		rp->rec = NULL;
+	}
+}
+
+/**
+ * @brief Skips the remaining events of a substitution region in a trace. An
+ * incomplete trace may end within the region.
+ *
+ * @param rp replay status of the explorer
+ */
+void skip_region(Replay* rp)
+{
+	while (rp->pos < rp->trace->n_events
+			&& rp->trace->events[rp->pos++].kind != TR_REND);
+}
+
+/**
+ * @brief Moves pexplorer to the next reachable constant sub-tree just like
+ * next_backwards. When a trace is available, the movement is replayed from it
+ * and only the recorded checks (assumptions and initialisations of
+ * substitutions) are repeated; the sub-trees reachable while a substitution is
+ * in place are explored live. If a check gives a different result than
+ * recorded, exploration restarts live, skipping all sub-trees which have
+ * already been delivered.
+ *
+ * @param rp replay status of the explorer
+ * @param veri_perspec Pnode from whose perspective assumptions are verified
+ * @param sub_perspec Pnode from whose perspective substitutions are done
+ * @param pexplorer Pnode pointer exploring the branch
+ * @param eqwrapper Wrapping information
+ * @param checkpoint BC stack holding information corresponding to a level
+ * @param vflags verification flags
+ * @param subd substitution information
+ * @param idonly TRUE if only ids are considered eligible constants
+ * @param exst TRUE if doing a backwards substitution for existence verification
+ * @param exnum Pnode number which must not be exceeded by replaced constants
+ * (not carrying the FRST NFLAG)
+ * @param do_sub TRUE, if substitutions are to be made
+ * @param p_a TRUE, if assumptions are to be processed
+ *
+ * @return FALSE, if no reachable sub-trees are left
+ */
+unsigned short int next_reachable(Replay* rp, Pnode* veri_perspec,
+		Pnode* sub_perspec, Pnode** pexplorer, Eqwrapper** eqwrapper,
+		BC** checkpoint, VFlags* vflags, SUB** subd,
+		unsigned short int idonly, unsigned short int exst, int exnum,
+		unsigned short int do_sub, unsigned short int p_a)
+{
+	Trace* rec_cp;
+	TREvent* ev;
+	unsigned short int found;
+
+	/* every reachable sub-tree counts towards the effort (of the strategy
+	 * and of the list), but not again when a suspended search resumes the
+	 * movement to it */
+	if (rp->suspended) {
+		rp->suspended = FALSE;
+	} else {
+		vq_effort++;
+		if ((vq_budget != 0 && vq_effort > vq_budget)
+				|| (!step_limited && BUDGET_EXHAUSTED())) {
+			vq_exhausted = TRUE;
+			return FALSE;
+		}
+	}
+
+	rec_cp = trace_rec;
+	trace_rec = NULL;
+
+	while (rp->trace != NULL) {
+		if (budget_exhausted) {
+			/* next_backwards has been stopped within a region */
+			vq_exhausted = TRUE;
+			trace_rec = rec_cp;
+			return FALSE;
+		}
+		if (rp->in_region) {
+			if (next_backwards(veri_perspec, sub_perspec, pexplorer,
+						eqwrapper, checkpoint, vflags, subd, idonly, exst,
+						exnum, do_sub, p_a)) {
+				rp->delivered++;
+				trace_rec = rec_cp;
+				return TRUE;
+			}
+			if (step_suspended) {
+				rp->suspended = TRUE;
+				trace_rec = rec_cp;
+				return FALSE;
+			}
+			/* substitution has been finished */
+			rp->in_region = FALSE;
+			skip_region(rp);
+			continue;
+		}
+
+		if (rp->pos == rp->trace->n_events) {
+			/* end of an incomplete trace */
+			break;
+		}
+
+		ev = &(rp->trace->events[rp->pos++]);
+		if (ev->kind == TR_YIELD) {
+			*pexplorer = ev->pnode;
+			rp->delivered++;
+			trace_rec = rec_cp;
+			return TRUE;
+		} else if (ev->kind == TR_ASMP) {
+			if (check_asmp(veri_perspec, &(ev->pnode), FALSE) != ev->res) {
+				break;
+			}
+		} else if (ev->kind == TR_SUBST) {
+			*pexplorer = ev->pnode;
+			if (init_sub(sub_perspec, ev->pnode->vtree, vflags, subd, idonly,
+						exst, exnum) != ev->res) {
+				break;
+			}
+			if (ev->res) {
+				rp->in_region = TRUE;
+				SET_VFLAG_RGN(*vflags)
+				if (attempt_explore(veri_perspec, sub_perspec, pexplorer,
+						eqwrapper, checkpoint, vflags, subd, idonly, exst,
+						exnum, do_sub, p_a)) {
+					rp->delivered++;
+					trace_rec = rec_cp;
+					return TRUE;
+				}
+				if (step_suspended) {
+					rp->suspended = TRUE;
+					trace_rec = rec_cp;
+					return FALSE;
+				}
+				/* substitution has been finished during the attempt */
+				rp->in_region = FALSE;
+				skip_region(rp);
+			}
+		} else if (ev->kind == TR_END) {
+			trace_rec = rec_cp;
+			return FALSE;
+		}
+	}
+
+	if (rp->trace != NULL) {
+		/* replay diverged from the trace; restart exploration */
+		finish_verify(pexplorer, eqwrapper, checkpoint, vflags, subd);
+		UNSET_VFLAG_RGN(*vflags)
+		*pexplorer = rp->pexstart;
+		rp->skip = rp->delivered;
+		rp->rec = new_trace(rp->pexstart, rp->trace->veri_perspec,
+				rp->trace->sub_perspec, rp->trace->exnum, rp->trace->opts);
+		rp->trace = NULL;
+	}
+
+	trace_rec = rp->rec;
+	do {
+		found = next_backwards(veri_perspec, sub_perspec, pexplorer,
+				eqwrapper, checkpoint, vflags, subd, idonly, exst, exnum,
+				do_sub, p_a);
+		if (!found && step_suspended) {
+			/* the sub-trees to be skipped and the trace are kept */
+			rp->suspended = TRUE;
+			trace_rec = rec_cp;
+			return FALSE;
+		}
+		if (!found && budget_exhausted) {
+			/* the trace remains incomplete, as there may be sub-trees left */
+			vq_exhausted = TRUE;
+			break;
+		}
+		trace_event(*pexplorer, found ? TR_YIELD : TR_END, found);
+	} while (found && rp->skip-- > 0);
+	rp->skip = 0;
+
+	if (found) {
+		rp->delivered++;
+	}
+	trace_rec = rec_cp;
+	return found;
+}
+
 /* --- verification --------------------------------------------------------- */
 
 /**
@@ -793,9 +1188,7 @@ unsigned short int const_equal(Pnode* p1, Pnode* p2)
 	unsigned short int equal;
 
 	equal = TRUE;
-#ifdef DGMP
-	mpz_add_ui(comp_count, comp_count, 1);
-#endif
+	PERF_INC(comparisons)
 
 	if (IS_ID(p1)) {
 		if (IS_ID(p2)) {
@@ -854,7 +1247,64 @@ unsigned short int verify(Pnode* pnode, Pnode** pexplorer)
 		return FALSE;
 	}
 	return const_equal(*((*pexplorer)->child), *(pnode->child));
-	/* TODO: only when other verification fails, take equalities into account */
+}
+
+/**
+ * @brief Compares two sub-trees with each other; only if they are not similar,
+ * the equalities known from the perspective of pnode are taken into account.
+ *
+ * @param cc congruence closure of the equalities known to pnode (may be NULL)
+ * @param pnode top left Pnode of one sub-tree
+ * @param pexplorer top left Pnode of another sub-tree
+ *
+ * @return TRUE, if the two sub-trees are similar or congruent
+ */
+unsigned short int verify_eq(CC* cc, Pnode* pnode, Pnode** pexplorer)
+{
+	if (verify(pnode, pexplorer)) {
+		return TRUE;
+	}
+	return (cc != NULL && (HAS_CHILD(pnode) || HAS_CHILD((*pexplorer)))
+			&& cc_equal(cc, pnode, *pexplorer));
+}
+
+/**
+ * @brief Checks, whether a goal follows from the equalities known from its
+ * perspective, i.e. whether it is an equality of congruent sides or whether it
+ * is congruent to a side of a known equality and to a constant sub-tree
+ * visible to it. The latter replaces the exploration of known equalities as
+ * two-sided implications.
+ *
+ * @param cc congruence closure of the equalities known to the goal
+ * @param goal Pnode to be verified
+ *
+ * @return TRUE, if the goal follows from a known equality
+ */
+unsigned short int check_eq(CC* cc, Pnode* goal)
+{
+	Pnode* pconst;
+	int cls;
+
+	if (cc == NULL || !HAS_CHILD(goal)) {
+		return FALSE;
+	}
+
+	if (IS_EQUALITY(goal) && cc_sides_equal(cc, goal)) {
+		return TRUE;
+	}
+
+	cls = cc_class(cc, goal);
+	if (!cc_is_side(cc, cls)) {
+		return FALSE;
+	}
+
+	for (pconst = goal->prev_const; pconst != NULL;
+			pconst = pconst->prev_const) {
+		if (HAS_CHILD(pconst) && cc_class(cc, pconst) == cls) {
+			return TRUE;
+		}
+	}
+	return FALSE;
 }
 
 /**
@@ -870,18 +1320,44 @@ unsigned short int check_asmp(Pnode* perspective, Pnode** pexplorer,
 		unsigned short int exst)
 {
 	Pnode* pconst;
+	unsigned short int closed;
+	unsigned short int found;
+	CC* cc;
+	int cls;
+
+	found = FALSE;
+	PERF_INC(asmp_lookups)
+
+	/* the content of an open statement may still change */
+	closed = HAS_NFLAG_CLSD((*pexplorer));
+	if (closed && is_nogood(NG_ASMP, *pexplorer, perspective->prev_const, 0)) {
+		PERF_INC(nogoods)
+		trace_event(*pexplorer, TR_ASMP, FALSE);
+		return FALSE;
+	}
+
+	/* with known equalities, compare the classes of the sub-trees */
+	cc = cc_context(perspective);
+	cls = (cc != NULL) ? cc_class(cc, *pexplorer) : -1;
 
 	for (pconst = perspective->prev_const; pconst != NULL;
 			pconst = pconst->prev_const) {
-		if (verify(pconst, pexplorer)) {
+		if (verify(pconst, pexplorer)
+				|| (cc != NULL && cc_class(cc, pconst) == cls)) {
 			if (exst) {
 				DBG_VERIFY(fprintf(stderr, SHELL_MAGENTA "<%d:%d>",
 							(*pexplorer)->num_c, pconst->num_c););
 			}
-			return TRUE;
+			found = TRUE;
+			break;
 		}
 	}
-	return FALSE;
+
+	if (closed && !found) {
+		add_nogood(NG_ASMP, *pexplorer, perspective->prev_const, 0);
+	}
+	trace_event(*pexplorer, TR_ASMP, found);
+	return found;
 }
 
 #if 0
@@ -956,185 +1432,858 @@ unsigned short int verify_universal(Pnode* pn)
 #endif
 
 /**
- * @brief Recursive verification of quantifiers (helper function for
- * verify_quantifiers).
+ * @brief Finds the Pnode, at which the exploration towards a reachable
+ * sub-tree has started, i.e. the bottom of the BC stack or (if the sub-tree
+ * has been replayed from a trace) the Pnode on the backtracking path from
+ * pexstart, which contains the sub-tree.
  *
  * @param pexstart Pnode at the beginning of the list
- * @param p_perspective perspective taken, while moving through the list
- * @param p_pexplorer Pnode advancing through the list
- * @param p_eqwrapper Wrapping information corresponding to this movement
- * @param p_checkpoint BC stack for recursive exploration
- * @param p_vflags verification flags
- * @param dbg turn debugging on (deprecated)
- * @param idonly TRUE, if only ids are considered eligible for substitution
- * @param exnum Pnode number which must not be exceeded by replaced constants
- * (not carrying the FRST NFLAG)
- * @param carry_over TRUE, if node has been verified and status of successful
- * verification is to be carried over to parent level
+ * @param pexplorer reachable sub-tree
+ * @param checkpoint BC stack of the explorer
  *
- * @return TRUE, if verification of current node in list was successful
+ * @return Pnode, at which exploration has started (NULL, if none)
  */
-unsigned short int vq_recurs(Pnode* pexstart,
-		Pnode* p_perspective, Pnode** p_pexplorer, Eqwrapper** p_eqwrapper,
-		BC** p_checkpoint, VFlags* p_vflags, unsigned short int dbg,
-		unsigned short int idonly, int exnum, unsigned short int carry_over)
+Pnode* find_root(Pnode* pexstart, Pnode* pexplorer, BC* checkpoint)
 {
-	unsigned short int success;
-	unsigned short int rightmost;
-	Pnode* expl_cp; /* checkpoint for parent explorer */
-	Pnode* perspective; /* perspective for validation of next_reachable */
+	Pnode* proot;
+	Pnode* panc;
 
-	Eqwrapper* eqwrapper;
-	Pnode** pexplorer;
-	BC** checkpoint;
-	SUB** subd;
-	VFlags vflags;
+	if (checkpoint != NULL) {
+		while (checkpoint->above != NULL) {
+			checkpoint = checkpoint->above;
+		}
+		return checkpoint->pnode;
+	}
 
-	eqwrapper = (Eqwrapper*) malloc(sizeof(Eqwrapper));
+	proot = pexstart;
+	do {
+		while (!move_left(&proot)) {
+			if (!move_up(&proot)) {
+				return NULL;
+			}
+		}
+		for (panc = pexplorer; panc != proot;) {
+			while (move_left(&panc));
+			if (!move_up(&panc)) {
+				break;
+			}
+		}
+	} while (panc != proot);
+
+	return proot;
+}
+
+/**
+ * @brief Records the step of vq_recurs, which justifies a statement, in the
+ * certificate.
+ *
+ * @param pexstart Pnode at the beginning of the list
+ * @param goal statement, which has been verified
+ * @param pexplorer reachable sub-tree equal to the goal
+ * @param checkpoint BC stack of the explorer
+ * @param subd substitutions in place
+ * @param carry_over TRUE, if the goal has been carried over
+ * @param eq_hit TRUE, if the goal follows from known equalities
+ */
+void record_step(Pnode* pexstart, Pnode* goal, Pnode* pexplorer,
+		BC* checkpoint, SUB* subd, unsigned short int carry_over,
+		unsigned short int eq_hit)
+{
+	if (!do_cert) {
+		return;
+	}
+
+	if (carry_over) {
+		cert_step(CERT_CARRY, goal, NULL, NULL, NULL);
+	} else if (eq_hit) {
+		cert_step(CERT_EQ, goal, NULL, NULL, NULL);
+	} else {
+		cert_step(CERT_REACH, goal, find_root(pexstart, pexplorer,
+					checkpoint), pexplorer, subd);
+	}
+}
+
+/**
+ * @brief Starts a level of the search, i.e. the verification of the statement
+ * of the list, at which the explorer of the search points. A level examines
+ * the reachable sub-trees of the statement; once a sub-tree matches, the
+ * explorer advances and the level of the next statement is started.
+ *
+ * @param s search
+ * @param carry_over TRUE, if node has been verified and status of successful
+ * verification is to be carried over to parent level
+ *
+ * @return FALSE, if the level is known to fail (see nogood.h)
+ */
+static unsigned short int push_level(Search* s, unsigned short int carry_over)
+{
+	VQFrame* f;
+	uint64_t ng_aux;
+
+	ng_aux = mix_fp(explorer_fp(*(s->p_eqwrapper), *(s->p_checkpoint),
+				*(s->p_vflags)), (carry_over << 1) | s->idonly);
+	ng_aux = mix_fp(ng_aux, s->exnum);
+	PERF_INC(vq_calls)
+	if (is_nogood(NG_VQ, *(s->p_pexplorer), s->pexstart, ng_aux)) {
+		PERF_INC(nogoods)
+		DBG_FAIL(fprintf(stderr, SHELL_RED "<%d:ng>" SHELL_RESET1,
+					(*(s->p_pexplorer))->num_c););
+		return FALSE;
+	}
+
+	f = (VQFrame*) malloc(sizeof(VQFrame));
+	f->state = VQ_NEXT;
+	f->carry_over = carry_over;
+	f->ng_aux = ng_aux;
+	f->below = s->top;
+	s->top = f;
+
+	/* state of the parent explorer to be restored on failure, such that a
+	 * failing level has no side effects and can be remembered as nogood */
+	f->p_eqwrapper_cp = **(s->p_eqwrapper);
+	f->p_checkpoint_cp = bc_copy(*(s->p_checkpoint));
+	f->p_vflags_cp = *(s->p_vflags);
+
+	f->eqwrapper = (Eqwrapper*) malloc(sizeof(Eqwrapper));
+	f->pexplorer = (Pnode**) malloc(sizeof(Pnode*));
+	f->checkpoint = (BC**) malloc(sizeof(BC*));
+	f->subd = (SUB**) malloc(sizeof(SUB*));
+
+	*(f->pexplorer) = s->pexstart;
+	*(f->checkpoint) = NULL;
+	*(f->subd) = NULL;
+	f->eqwrapper->pwrapper = f->eqwrapper->pendwrap = NULL;
+	f->vflags = VFLAG_NONE;
+
+	f->perspective = *(s->p_pexplorer);
+	move_rightmost(&(f->perspective));
+
+	f->cc = cc_context(*(s->p_pexplorer));
+	f->eq_hit = !carry_over && check_eq(f->cc, *(s->p_pexplorer));
+
+	init_replay(&(f->replay), s->pexstart, *(s->p_pexplorer), f->perspective,
+			TRUE, s->exnum, TRUE, TRUE);
+	return TRUE;
+}
+
+/**
+ * @brief Finishes the level at the top of the search. On failure, the parent
+ * explorer is restored (the explorer itself has to be moved back by the
+ * caller).
+ *
+ * @param s search
+ * @param verified TRUE, if the statements of the level and all following
+ * levels have been verified
+ */
+static void pop_level(Search* s, unsigned short int verified)
+{
+	VQFrame* f;
+
+	f = s->top;
+	finish_verify(f->pexplorer, &(f->eqwrapper), f->checkpoint, &(f->vflags),
+			f->subd);
+	finish_replay(&(f->replay));
+
+	free(f->eqwrapper);
+	free(f->pexplorer);
+	free(f->checkpoint);
+	free(f->subd);
+
+	if (verified) {
+		bc_free(f->p_checkpoint_cp);
+	} else {
+		**(s->p_eqwrapper) = f->p_eqwrapper_cp;
+		bc_free(*(s->p_checkpoint));
+		*(s->p_checkpoint) = f->p_checkpoint_cp;
+		*(s->p_vflags) = f->p_vflags_cp;
+		if (!vq_exhausted && !s->aborted) {
+			/* a search stopped by its budget or aborted has not failed */
+			add_nogood(NG_VQ, *(s->p_pexplorer), s->pexstart, f->ng_aux);
+		}
+	}
+
+	s->top = f->below;
+	s->result = verified;
+	free(f);
+}
+
+/**
+ * @brief Finishes the level at the top of the search, after its reachable
+ * sub-trees have been examined.
+ *
+ * @param s search
+ * @param verified TRUE, if the statements of the level and all following
+ * levels have been verified
+ */
+static void finish_level(Search* s, unsigned short int verified)
+{
+	DBG_VERIFY(if (s->top->carry_over) {
+			fprintf(stderr, SHELL_GREEN "<%d:co>" SHELL_RESET1,
+					(*(s->p_pexplorer))->num_c);
+			} else if (verified && s->top->eq_hit) {
+			fprintf(stderr, SHELL_GREEN "<%d:eq>" SHELL_RESET1,
+					(*(s->p_pexplorer))->num_c);
+			} else if (verified) {
+			fprintf(stderr, SHELL_GREEN "<%d:%d",
+					(*(s->p_pexplorer))->num_c, (*(s->top->pexplorer))->num_c);
+			print_sub(s->top->subd);
+			fprintf(stderr, ">" SHELL_RESET1);
+			});
+
+	pop_level(s, verified);
+}
+
+/**
+ * @brief Starts the search for the statements of a list (see search_step).
+ *
+ * @param s search to be initialised
+ * @param pexstart Pnode at the beginning of the list
+ * @param p_perspective perspective taken, while moving through the list
+ * @param p_pexplorer Pnode advancing through the list
+ * @param p_eqwrapper Wrapping information corresponding to this movement
+ * @param p_checkpoint BC stack for recursive exploration
+ * @param p_vflags verification flags
+ * @param idonly TRUE, if only ids are considered eligible for substitution
+ * @param exnum Pnode number which must not be exceeded by replaced constants
+ * (not carrying the FRST NFLAG)
+ * @param carry_over TRUE, if node has been verified and status of successful
+ * verification is to be carried over to parent level
+ */
+void search_init(Search* s, Pnode* pexstart, Pnode* p_perspective,
+		Pnode** p_pexplorer, Eqwrapper** p_eqwrapper, BC** p_checkpoint,
+		VFlags* p_vflags, unsigned short int idonly, int exnum,
+		unsigned short int carry_over)
+{
+	s->pexstart = pexstart;
+	s->p_perspective = p_perspective;
+	s->p_pexplorer = p_pexplorer;
+	s->p_eqwrapper = p_eqwrapper;
+	s->p_checkpoint = p_checkpoint;
+	s->p_vflags = p_vflags;
+	s->idonly = idonly;
+	s->exnum = exnum;
+	s->top = NULL;
+	s->result = FALSE;
+	s->aborted = FALSE;
+
+	push_level(s, carry_over);
+}
+
+/**
+ * @brief Continues a search for the statements of a list. Instead of
+ * recursing for every statement, the levels of the search are kept on an
+ * explicit stack (see push_level), and the movement of the explorer of the
+ * current level is kept in its replay status (see next_reachable), so that
+ * the search can be suspended after any unit and resumed by the next call.
+ * Only one search may be active on a graph at a time, as a suspended search
+ * keeps its substitutions in place.
+ *
+ * @param s search
+ * @param units maximum number of units (reachable sub-trees examined and
+ * moves of the explorer in next_backwards) of this step (0 for unlimited)
+ *
+ * @return SEARCH_RUNNING, if the search has been suspended
+ */
+SearchStatus search_step(Search* s, uint64_t units)
+{
+	VQFrame* f;
+	unsigned short int rightmost;
+
+	step_left = units;
+	step_limited = (units != 0);
+	step_suspended = FALSE;
+
+	while (s->top != NULL) {
+		f = s->top;
+
+		/* the level of the following statement has finished */
+		if (f->state == VQ_RETURN) {
+			*(s->p_pexplorer) = f->expl_cp;
+			f->state = VQ_NEXT;
+			if (s->result) {
+				record_step(s->pexstart, f->expl_cp, *(f->pexplorer),
+						*(f->checkpoint), *(f->subd), f->carry_over,
+						f->eq_hit);
+				finish_level(s, TRUE);
+				continue;
+			}
+			f->eq_hit = FALSE;
+		}
+
+		if (!f->eq_hit) {
+			/* a sub-tree, to which the explorer has not been moved completely,
+			 * is counted only once */
+			if (!f->replay.suspended) {
+				if (suspend_search()) {
+					break;
+				}
+			}
+			if (!next_reachable(&(f->replay), *(s->p_pexplorer),
+						f->perspective, f->pexplorer, &(f->eqwrapper),
+						f->checkpoint, &(f->vflags), f->subd, s->idonly, TRUE,
+						s->exnum, TRUE, TRUE)) {
+				if (step_suspended) {
+					break;
+				}
+				finish_level(s, FALSE);
+				continue;
+			}
+		}
+
+		if (!f->eq_hit && !f->carry_over
+				&& !verify_eq(f->cc, *(s->p_pexplorer), f->pexplorer)) {
+			DBG_FAIL(
+				fprintf(stderr, SHELL_RED "<%d:%d",
+						(*(s->p_pexplorer))->num_c, (*(f->pexplorer))->num_c);
+				print_sub(f->subd);
+				fprintf(stderr, ">" SHELL_RESET1);
+			);
+			continue;
+		}
+
+		DBG_PATH(if (f->eq_hit) {
+				fprintf(stderr, SHELL_MAGENTA "<%d:eq>" SHELL_RESET1,
+					(*(s->p_pexplorer))->num_c);
+				} else {
+				fprintf(stderr, SHELL_MAGENTA "<%d:%d",
+					(*(s->p_pexplorer))->num_c, (*(f->pexplorer))->num_c);
+				print_sub(f->subd);
+				fprintf(stderr, ">" SHELL_RESET1);
+				});
+
+		f->expl_cp = *(s->p_pexplorer);
+
+		rightmost = !HAS_RIGHT((*(s->p_pexplorer)));
+
+		if (!next_forwards(NULL, s->p_pexplorer, s->p_eqwrapper,
+					s->p_checkpoint, s->p_vflags, FALSE)) {
+			*(s->p_pexplorer) = f->expl_cp;
+			pop_level(s, FALSE);
+			continue;
+		}
+
+		/* if the dummy node has been reached, verification has been
+		 * successful */
+		if ((*(s->p_pexplorer))->num == -1) {
+			record_step(s->pexstart, f->expl_cp, *(f->pexplorer),
+					*(f->checkpoint), *(f->subd), f->carry_over, f->eq_hit);
+
+			DBG_VERIFY(if (f->carry_over) {
+					fprintf(stderr, SHELL_GREEN "<%d:co>" SHELL_RESET1,
+							f->expl_cp->num_c);
+					} else if (f->eq_hit) {
+					fprintf(stderr, SHELL_GREEN "<%d:eq>" SHELL_RESET1,
+							f->expl_cp->num_c);
+					} else {
+					fprintf(stderr, SHELL_GREEN "<%d:%d",
+							f->expl_cp->num_c, (*(f->pexplorer))->num_c);
+					print_sub(f->subd);
+					fprintf(stderr, ">" SHELL_RESET1);
+					});
+
+			pop_level(s, TRUE);
+			continue;
+		}
+
+		/* the following statement is verified in the context of this
+		 * match */
+		f->state = VQ_RETURN;
+		if (!push_level(s, rightmost)) {
+			s->result = FALSE;
+		}
+	}
+
+	step_limited = FALSE;
+	if (s->top != NULL) {
+		return SEARCH_RUNNING;
+	}
+	return s->result ? SEARCH_FOUND : SEARCH_FAILED;
+}
+
+/**
+ * @brief Aborts a suspended search. Its levels are finished like failures,
+ * but are not remembered as nogoods, and the explorer of the list is restored.
+ *
+ * @param s search
+ */
+void search_abort(Search* s)
+{
+	s->aborted = TRUE;
+	while (s->top != NULL) {
+		if (s->top->state == VQ_RETURN) {
+			*(s->p_pexplorer) = s->top->expl_cp;
+		}
+		pop_level(s, FALSE);
+	}
+}
+
+/**
+ * @brief Verification of quantifiers (helper function for
+ * verify_quantifiers). The search is run in steps, if the list has a budget,
+ * which is checked between them.
+ *
+ * @param pexstart Pnode at the beginning of the list
+ * @param p_perspective perspective taken, while moving through the list
+ * @param p_pexplorer Pnode advancing through the list
+ * @param p_eqwrapper Wrapping information corresponding to this movement
+ * @param p_checkpoint BC stack for recursive exploration
+ * @param p_vflags verification flags
+ * @param dbg turn debugging on (deprecated)
+ * @param idonly TRUE, if only ids are considered eligible for substitution
+ * @param exnum Pnode number which must not be exceeded by replaced constants
+ * (not carrying the FRST NFLAG)
+ * @param carry_over TRUE, if node has been verified and status of successful
+ * verification is to be carried over to parent level
+ *
+ * @return TRUE, if verification of current node in list was successful
+ */
+unsigned short int vq_recurs(Pnode* pexstart,
+		Pnode* p_perspective, Pnode** p_pexplorer, Eqwrapper** p_eqwrapper,
+		BC** p_checkpoint, VFlags* p_vflags, unsigned short int dbg,
+		unsigned short int idonly, int exnum, unsigned short int carry_over)
+{
+	Search s;
+	SearchStatus status;
+	uint64_t units;
+	uint64_t effort;
+
+	units = vq_steps != 0 ? vq_steps : (budget_active ? BUDGET_STEP : 0);
+	effort = vq_effort;
+
+	search_init(&s, pexstart, p_perspective, p_pexplorer, p_eqwrapper,
+			p_checkpoint, p_vflags, idonly, exnum, carry_over);
+	status = search_step(&s, units);
+
+	if (vq_steps != 0 && status == SEARCH_RUNNING) {
+		/* debugging: the search starts again from scratch, counting the
+		 * effort only once */
+		search_abort(&s);
+		vq_effort = effort;
+		search_init(&s, pexstart, p_perspective, p_pexplorer, p_eqwrapper,
+				p_checkpoint, p_vflags, idonly, exnum, carry_over);
+		status = search_step(&s, units);
+	}
+
+	while (status == SEARCH_RUNNING) {
+		if (BUDGET_EXHAUSTED()) {
+			vq_exhausted = TRUE;
+			search_abort(&s);
+			return FALSE;
+		}
+		status = search_step(&s, units);
+	}
+
+	return status == SEARCH_FOUND;
+}
+
+/**
+ * @brief Collects variables for forward substituion during existence
+ * verification - currently only at top-most level.
+ *
+ * @param pcollector Pnode to start collection at
+ *
+ * @return pointer to VTree holding the collected variables
+ */
+VTree* collect_forward_vars(Pnode* pcollector)
+{
+	VTree* vtree;
+	VTree* newvtree;
+
+	vtree = NULL;
+
+	/* TODO: think about how to handle _variables_ during forward substitution*/
+	while (pcollector->num != -1) {
+		if (HAS_NFLAG_NEWC(pcollector)) {
+			//DBG_VERIFY(fprintf(stderr, SHELL_RED "." SHELL_RESET1););	
+			newvtree = (VTree*) malloc(sizeof(VTree));
+			newvtree->pnode = *(pcollector->child);
+			newvtree->right = vtree;
+			newvtree->left = NULL;
+			newvtree->parent = NULL;
+			newvtree->flags = VARFLAG_NONE;
+			if (vtree != NULL) {
+				vtree->parent = newvtree;
+				SET_VARFLAG_RGHT(vtree->flags)
+			}
+			vtree = newvtree;
+		}
+		pcollector = *(pcollector->right);
+	}
+
+	return vtree;
+}
+
+/* --- candidate sets ------------------------------------------------------- */
+/**
+ * @brief Initialises candidate sets for the forward substitution of the
+ * variables in a VTree. Initially every id known before pexstart is a
+ * candidate for every variable.
+ *
+ * The ids introduced within the list (which next_sub offers after wrapping
+ * around) need not be candidates: these are exactly the collected variables,
+ * each of which holds an id known before pexstart while being substituted in,
+ * so substituting one of them gives a combination, which is enumerated
+ * anyway (see testcases/valid/forwardwrap.prove).
+ *
+ * @param pexstart Pnode at the beginning of the list
+ * @param vtree variables collected for forward substitution
+ * @param cs candidate sets to be initialised
+ *
+ * @return FALSE if there are no ids to be substituted in
+ */
+unsigned short int init_cset(Pnode* pexstart, VTree* vtree, CSet* cs)
+{
+	Pnode* pid;
+	VTree* viter;
+	int i;
+
+	cs->n_known = 0;
+	cs->n_vars = 0;
+	for (pid = pexstart->prev_id; pid != NULL; pid = pid->prev_id) {
+		cs->n_known++;
+	}
+	for (viter = pos_in_vtree(vtree); viter != NULL; viter = next_var(viter)) {
+		if (!HAS_VARFLAG_LOCK(viter->flags) && viter->pnode != NULL) {
+			cs->n_vars++;
+		}
+	}
+
+	cs->n_words = CS_WORDS(cs->n_known);
+	cs->known = (Pnode**) malloc(sizeof(Pnode*) * (cs->n_known + 1));
+	cs->vars = (VTree**) malloc(sizeof(VTree*) * (cs->n_vars + 1));
+	cs->cur = (int*) malloc(sizeof(int) * (cs->n_vars + 1));
+	cs->bits = (unsigned long*) calloc(cs->n_vars * cs->n_words + 1,
+			sizeof(unsigned long));
+
+	for (pid = pexstart->prev_id, i = 0; pid != NULL; pid = pid->prev_id) {
+		cs->known[i++] = pid;
+	}
+	for (viter = pos_in_vtree(vtree), i = 0; viter != NULL;
+			viter = next_var(viter)) {
+		if (!HAS_VARFLAG_LOCK(viter->flags) && viter->pnode != NULL) {
+			cs->vars[i++] = viter;
+		}
+	}
+	for (i = 0; i < cs->n_vars * cs->n_known; i++) {
+		CS_SET(cs->bits, (i / cs->n_known) * cs->n_words * CS_WORDBITS
+				+ i % cs->n_known)
+	}
+
+	return (cs->n_known > 0 && cs->n_vars > 0);
+}
+
+/**
+ * @brief Frees memory allocated for candidate sets.
+ *
+ * @param cs candidate sets to be freed
+ */
+void free_cset(CSet* cs)
+{
+	free(cs->known);
+	free(cs->vars);
+	free(cs->cur);
+	free(cs->bits);
+}
+
+/**
+ * @brief Finds the next candidate of a variable.
+ *
+ * @param cs candidate sets
+ * @param v index of the variable
+ * @param from index of the first known id to be considered
+ *
+ * @return index of next candidate or -1, if there is none
+ */
+int next_candidate(CSet* cs, int v, int from)
+{
+	unsigned long* bits;
+
+	bits = cs->bits + v * cs->n_words;
+	for (; from < cs->n_known; from++) {
+		if (CS_HAS(bits, from)) {
+			return from;
+		}
+	}
+	return -1;
+}
+
+/**
+ * @brief Checks whether a variable occurs in a sub-tree (known ids share the
+ * symbol of the variable they refer to).
+ *
+ * @param pnode top left Pnode of the sub-tree
+ * @param var variable to look for
+ *
+ * @return TRUE, if the variable occurs in the sub-tree
+ */
+unsigned short int contains_var(Pnode* pnode, VTree* var)
+{
+	if (pnode->symbol == var->pnode->symbol) {
+		return TRUE;
+	}
+	return (HAS_CHILD(pnode) && contains_var(*(pnode->child), var))
+		|| (HAS_RIGHT(pnode) && contains_var(*(pnode->right), var));
+}
+
+/**
+ * @brief Checks whether a single statement of the list is reachable
+ * independently of the other statements, i.e. performs the same search as
+ * vq_recurs does for one level without recursing.
+ *
+ * @param pconj statement to be verified
+ * @param pexstart Pnode at the beginning of the list
+ * @param perspective perspective for substitutions
+ * @param idonly TRUE, if only ids are considered eligible for substitution
+ * @param exnum Pnode number which must not be exceeded by replaced constants
+ *
+ * @return TRUE, if a reachable sub-tree equal to pconj was found
+ */
+unsigned short int conj_reachable(Pnode* pconj, Pnode* pexstart,
+		Pnode* perspective, unsigned short int idonly, int exnum)
+{
+	unsigned short int found;
+
+	Eqwrapper* eqwrapper;
+	Pnode** pexplorer;
+	BC** checkpoint;
+	SUB** subd;
+	VFlags vflags;
+	Replay replay;
+	CC* cc;
+
+	eqwrapper = (Eqwrapper*) malloc(sizeof(Eqwrapper));
 	pexplorer = (Pnode**) malloc(sizeof(Pnode*));
 	checkpoint = (BC**) malloc(sizeof(BC*));
 	subd = (SUB**) malloc(sizeof(SUB*));
-	
+
 	*pexplorer = pexstart;
 	*checkpoint = NULL;
 	*subd = NULL;
-
+	eqwrapper->pwrapper = eqwrapper->pendwrap = NULL;
 	vflags = VFLAG_NONE;
-	success = FALSE;
-	perspective = *p_pexplorer;
+	cc = cc_context(pconj);
+	found = check_eq(cc, pconj);
 
-	move_rightmost(&perspective);
+	init_replay(&replay, pexstart, pconj, perspective, TRUE, exnum, TRUE,
+			TRUE);
 
-	while (next_backwards(*p_pexplorer /*perspective*/, perspective,
-		pexplorer, &eqwrapper, checkpoint, &vflags, subd, idonly, TRUE,
-		exnum, TRUE, TRUE)) {
-		if (carry_over || verify(*p_pexplorer, pexplorer)) {	
-
-			DBG_PATH(
-					fprintf(stderr, SHELL_MAGENTA "<%d:%d",
-						(*p_pexplorer)->num_c, (*pexplorer)->num_c);
-					print_sub(subd);
-					fprintf(stderr, ">" SHELL_RESET1);
-			);
-
-			expl_cp = *p_pexplorer;
+	while (!found && next_reachable(&replay, pconj, perspective, pexplorer,
+				&eqwrapper, checkpoint, &vflags, subd, idonly, TRUE, exnum,
+				TRUE, TRUE)) {
+		if (verify_eq(cc, pconj, pexplorer)) {
+			found = TRUE;
+			break;
+		}
+	}
 
-			rightmost = !HAS_RIGHT((*p_pexplorer));
+	finish_verify(pexplorer, &eqwrapper, checkpoint, &vflags, subd);
+	finish_replay(&replay);
 
-			if (!next_forwards(NULL, p_pexplorer, p_eqwrapper, p_checkpoint, p_vflags, FALSE)) {
+	free(eqwrapper);
+	free(pexplorer);
+	free(checkpoint);
+	free(subd);
 
-				*p_pexplorer = expl_cp;
+	return found;
+}
 
-				finish_verify(pexplorer, &eqwrapper, checkpoint, &vflags,
-									subd);
+/**
+ * @brief Prunes the candidate sets of the variables occurring in a single
+ * statement (generalised arc consistency): a candidate is kept only, if the
+ * statement can be verified for some combination of remaining candidates of
+ * the other variables occurring in it.
+ *
+ * @param pconj statement constraining the variables
+ * @param pexstart Pnode at the beginning of the list
+ * @param perspective perspective for substitutions
+ * @param cs candidate sets to be pruned
+ * @param idonly TRUE, if only ids are considered eligible for substitution
+ * @param exnum Pnode number which must not be exceeded by replaced constants
+ * @param changed set to TRUE, if any candidate set has been changed
+ *
+ * @return FALSE, if a candidate set became empty
+ */
+unsigned short int prune_conj(Pnode* pconj, Pnode* pexstart,
+		Pnode* perspective, CSet* cs, unsigned short int idonly, int exnum,
+		unsigned short int* changed)
+{
+	unsigned short int empty;
+	unsigned long* supp;
+	unsigned long* bits;
+	SUB* subs;
+	int* occ;
+	int m;
+	int i;
+	int j;
+
+	occ = (int*) malloc(sizeof(int) * cs->n_vars);
+	for (i = 0, m = 0; i < cs->n_vars; i++) {
+		if (contains_var(*(pconj->child), cs->vars[i])) {
+			occ[m++] = i;
+		}
+	}
+	if (m == 0) {
+		free(occ);
+		return TRUE;
+	}
 
-				free(eqwrapper);
-				free(pexplorer);
-				free(checkpoint);
-				free(subd);
-				
-				return FALSE;
-			}
+	supp = (unsigned long*) calloc(cs->n_vars * cs->n_words,
+			sizeof(unsigned long));
+	subs = (SUB*) malloc(sizeof(SUB) * m);
+
+	for (i = 0; i < m; i++) {
+		subs[i].vtree = cs->vars[occ[i]];
+		subs[i].sym = *(subs[i].vtree->pnode->symbol);
+		subs[i].num = subs[i].vtree->pnode->parent->num;
+		subs[i].fp = 0;
+		cs->cur[occ[i]] = next_candidate(cs, occ[i], 0);
+		subs[i].known_const = cs->known[cs->cur[occ[i]]];
+		sub_var(&subs[i]);
+	}
 
-			/* if the dummy node has been reached, verification has been
-			 * successful */
-			if ((*p_pexplorer)->num == -1) {
-				DBG_VERIFY(if (carry_over) {
-						fprintf(stderr, SHELL_GREEN "<%d:co>" SHELL_RESET1,
-								expl_cp->num_c);
-						} else {
-						fprintf(stderr, SHELL_GREEN "<%d:%d",
-								expl_cp->num_c, (*pexplorer)->num_c);
-						print_sub(subd);
-						fprintf(stderr, ">" SHELL_RESET1);
-						});
-
-				finish_verify(pexplorer, &eqwrapper, checkpoint, &vflags,
-									subd);
-
-				free(eqwrapper);
-				free(pexplorer);
-				free(checkpoint);
-				free(subd);
-				
-				return TRUE;
+	/* enumerate all combinations of candidates of the occurring variables */
+	do {
+		if (conj_reachable(pconj, pexstart, perspective, idonly, exnum)) {
+			for (i = 0; i < m; i++) {
+				CS_SET(supp, occ[i] * cs->n_words * CS_WORDBITS
+						+ cs->cur[occ[i]])
 			}
+		}
 
-			if (vq_recurs(pexstart, p_perspective,
-					p_pexplorer, p_eqwrapper, p_checkpoint, p_vflags,
-					FALSE, idonly, exnum, rightmost)) {
-				success = TRUE;
-				*p_pexplorer = expl_cp;
+		for (i = m - 1; i >= 0; i--) {
+			j = next_candidate(cs, occ[i], cs->cur[occ[i]] + 1);
+			if (j != -1) {
+				cs->cur[occ[i]] = j;
+				subs[i].known_const = cs->known[j];
+				sub_var(&subs[i]);
 				break;
-			} else {
-				*p_pexplorer = expl_cp;
 			}
+			cs->cur[occ[i]] = next_candidate(cs, occ[i], 0);
+			subs[i].known_const = cs->known[cs->cur[occ[i]]];
+			sub_var(&subs[i]);
+		}
+	} while (i >= 0);
 
-		} else {
-			DBG_FAIL(
-				fprintf(stderr, SHELL_RED "<%d:%d",
-						(*p_pexplorer)->num_c, (*pexplorer)->num_c);
-				print_sub(subd);
-				fprintf(stderr, ">" SHELL_RESET1);
-			);
+	empty = FALSE;
+	for (i = 0; i < m; i++) {
+		unsub_var(&subs[i]);
+
+		bits = cs->bits + occ[i] * cs->n_words;
+		for (j = 0; j < cs->n_words; j++) {
+			if (bits[j] != supp[occ[i] * cs->n_words + j]) {
+				bits[j] = supp[occ[i] * cs->n_words + j];
+				*changed = TRUE;
+			}
+		}
+		if (next_candidate(cs, occ[i], 0) == -1) {
+			empty = TRUE;
 		}
 	}
 
-	DBG_VERIFY(if (carry_over) {
-			fprintf(stderr, SHELL_GREEN "<%d:co>" SHELL_RESET1,
-					(*p_pexplorer)->num_c);
-			} else if (success) {
-			fprintf(stderr, SHELL_GREEN "<%d:%d",
-					(*p_pexplorer)->num_c, (*pexplorer)->num_c);
-			print_sub(subd);
-			fprintf(stderr, ">" SHELL_RESET1);
-			});
+	free(occ);
+	free(supp);
+	free(subs);
+
+	return !empty;
+}
+
+/**
+ * @brief Prunes candidate sets with every statement of the list until a fixed
+ * point is reached, such that only substitutions satisfying all statements
+ * independently are enumerated afterwards.
+ *
+ * @param pn dummy Pnode at the end of the list
+ * @param pexstart Pnode at the beginning of the list
+ * @param cs candidate sets to be pruned
+ * @param idonly TRUE, if only ids are considered eligible for substitution
+ * @param exnum Pnode number which must not be exceeded by replaced constants
+ *
+ * @return FALSE, if a candidate set became empty
+ */
+unsigned short int prune_cset(Pnode* pn, Pnode* pexstart, CSet* cs,
+		unsigned short int idonly, int exnum)
+{
+	unsigned short int changed;
+	Pnode* pconj;
+
+	do {
+		changed = FALSE;
+		for (pconj = pexstart; pconj->num != -1; pconj = *(pconj->right)) {
+			/* only statements, which are verified as a whole, constrain the
+			 * candidates */
+			if (HAS_SYMBOL(pconj) || !HAS_CHILD(pconj)
+					|| EXPLORABLE((&pconj))) {
+				continue;
+			}
+			if (!prune_conj(pconj, pexstart, pn, cs, idonly, exnum,
+						&changed)) {
+				return FALSE;
+			}
+		}
+	} while (changed);
+
+	return TRUE;
+}
+
+/**
+ * @brief Substitutes the first remaining candidate into every variable.
+ *
+ * @param cs candidate sets
+ * @param vflags Vflags corresponding to current substitution
+ * @param subd SUB structure to be initialised
+ */
+void init_cset_sub(CSet* cs, VFlags* vflags, SUB** subd)
+{
+	SUB* prev;
+	int i;
+
+	prev = *subd;
+	for (i = 0; i < cs->n_vars; i++) {
+		SET_VARFLAG_LOCK(cs->vars[i]->flags)
 
-	finish_verify(pexplorer, &eqwrapper, checkpoint, &vflags,
-		subd);
+		*subd = (SUB*) malloc(sizeof(SUB));
+		(*subd)->prev = prev;
+		prev = *subd;
 
-	free(eqwrapper);
-	free(pexplorer);
-	free(checkpoint);
-	free(subd);
+		(*subd)->vtree = cs->vars[i];
+		(*subd)->sym = *(cs->vars[i]->pnode->symbol);
+		(*subd)->num = cs->vars[i]->pnode->parent->num;
+		(*subd)->fp = 0;
 
-	return success;
+		cs->cur[i] = next_candidate(cs, i, 0);
+		(*subd)->known_const = cs->known[cs->cur[i]];
+		sub_var(*subd);
+	}
+	SET_VFLAG_SUBD(*vflags)
 }
 
 /**
- * @brief Collects variables for forward substituion during existence
- * verification - currently only at top-most level.
+ * @brief Performs next substitution of remaining candidates (the last variable
+ * is changing fastest, like in next_sub).
  *
- * @param pcollector Pnode to start collection at
+ * @param cs candidate sets
+ * @param s SUB corresponding to the last variable
  *
- * @return pointer to VTree holding the collected variables
+ * @return FALSE if no more substitutions are possible
  */
-VTree* collect_forward_vars(Pnode* pcollector)
+unsigned short int next_cset_sub(CSet* cs, SUB* s)
 {
-	VTree* vtree;
-	VTree* newvtree;
-
-	vtree = NULL;
-
-	/* TODO: think about how to handle _variables_ during forward substitution*/
-	while (pcollector->num != -1) {
-		if (HAS_NFLAG_NEWC(pcollector)) {
-			//DBG_VERIFY(fprintf(stderr, SHELL_RED "." SHELL_RESET1););	
-			newvtree = (VTree*) malloc(sizeof(VTree));
-			newvtree->pnode = *(pcollector->child);
-			newvtree->right = vtree;
-			newvtree->left = NULL;
-			newvtree->flags = VARFLAG_NONE;
-			if (vtree != NULL) {
-				vtree->parent = newvtree;
-				SET_VARFLAG_RGHT(vtree->flags)
-			}
-			vtree = newvtree;
+	int i;
+	int j;
+
+	for (i = cs->n_vars - 1; i >= 0; i--, s = s->prev) {
+		j = next_candidate(cs, i, cs->cur[i] + 1);
+		if (j != -1) {
+			cs->cur[i] = j;
+			s->known_const = cs->known[j];
+			sub_var(s);
+			return TRUE;
 		}
-		pcollector = *(pcollector->right);
+		cs->cur[i] = next_candidate(cs, i, 0);
+		s->known_const = cs->known[cs->cur[i]];
+		sub_var(s);
 	}
-
-	return vtree;
+	return FALSE;
 }
 
 /**
@@ -1143,11 +2292,13 @@ VTree* collect_forward_vars(Pnode* pcollector)
  * @param pn Pnode to be verified
  * @param pexstart Pnode at the beginning of the list
  * @param idonly TRUE, if only ids are considered eligible for substitution
+ * @param forward TRUE, if existential ids are to be substituted forwards
+ * (instead of searching without forward substitution)
  *
  * @return TRUE, if verification was successful
  */
 unsigned short int verify_quantifiers(Pnode* pn, Pnode* pexstart,
-		unsigned short int idonly)
+		unsigned short int idonly, unsigned short int forward)
 {
 	int exnum;
 
@@ -1158,6 +2309,7 @@ unsigned short int verify_quantifiers(Pnode* pn, Pnode* pexstart,
 	SUB** subd;
 	VFlags vflags;
 	VTree* fw_vtree;
+	CSet cset;
 
 	eqwrapper = (Eqwrapper*) malloc(sizeof(Eqwrapper));
 	pexplorer = (Pnode**) malloc(sizeof(Pnode*));
@@ -1169,20 +2321,27 @@ unsigned short int verify_quantifiers(Pnode* pn, Pnode* pexstart,
 	*subd = NULL;
 	vflags = VFLAG_NONE;
 	exnum = pexstart->num;
+	eqwrapper->pwrapper = eqwrapper->pendwrap = NULL;
 
 	bc_push(pexplorer, &eqwrapper, checkpoint, &vflags);
 
-	if (vq_recurs(pexstart, pn, pexplorer, &eqwrapper, checkpoint,
-			&vflags, TRUE, idonly, exnum, FALSE)) {
-		SET_GFLAG_VRFD
+	if (!forward) {
+		if (vq_recurs(pexstart, pn, pexplorer, &eqwrapper, checkpoint,
+				&vflags, TRUE, idonly, exnum, FALSE)) {
+			cert_reverse();
+			SET_GFLAG_VRFD
+		}
 	} else {
 		DBG_VERIFY(fprintf(stderr, SHELL_BROWN "<not verified; "
 					"trying forward substitution>"););	
 
 		fw_vtree = collect_forward_vars(pexstart);
 		if (fw_vtree != NULL) {
-			if (init_sub(pexstart, fw_vtree, &vflags, subd, TRUE, FALSE,
-						exnum)) {
+			/* only try substitutions, which satisfy every statement of the
+			 * list on its own */
+			if (init_cset(pexstart, fw_vtree, &cset)
+					&& prune_cset(pn, pexstart, &cset, idonly, exnum)) {
+				init_cset_sub(&cset, &vflags, subd);
 				do {
 					DBG_VERIFY(
 							fprintf(stderr, SHELL_BROWN "<");
@@ -1192,12 +2351,15 @@ unsigned short int verify_quantifiers(Pnode* pn, Pnode* pexstart,
 					if (vq_recurs(pexstart, pn, pexplorer, &eqwrapper,
 								checkpoint, &vflags, TRUE, idonly, exnum,
 								FALSE)) {
+						cert_step(CERT_FORWARD, NULL, NULL, NULL, *subd);
+						cert_reverse();
 						SET_GFLAG_VRFD
 						break;
 					}
-				} while (next_sub(pn, *subd, TRUE, FALSE, 0));
+				} while (!vq_exhausted && next_cset_sub(&cset, *subd));
 				finish_sub(&vflags, subd);
 			}
+			free_cset(&cset);
 		}
 	}
 	DBG_VERIFY(fprintf(stderr, SHELL_RESET1););	
@@ -1212,6 +2374,61 @@ unsigned short int verify_quantifiers(Pnode* pn, Pnode* pexstart,
 	return HAS_GFLAG_VRFD;
 }
 
+/**
+ * @brief Verifies a list of Pnodes by looking up every statement among the
+ * constant sub-trees visible at the beginning of the list (taking known
+ * equalities into account). Lists introducing new ids are left to the search.
+ *
+ * @param pn Pnode to be verified
+ * @param pexstart Pnode at the beginning of the list
+ *
+ * @return TRUE, if verification was successful
+ */
+unsigned short int verify_facts(Pnode* pn, Pnode* pexstart)
+{
+	Pnode* pgoal;
+	Pnode* pconst;
+	CC* cc;
+
+	for (pgoal = pexstart; pgoal != pn; pgoal = *(pgoal->right)) {
+		if (HAS_SYMBOL(pgoal)) { /* skip formulators */
+			continue;
+		}
+		if (HAS_NFLAG_NEWC(pgoal) || !HAS_CHILD(pgoal)) {
+			return FALSE;
+		}
+
+		cc = cc_context(pgoal);
+		if (check_eq(cc, pgoal)) {
+			DBG_VERIFY(fprintf(stderr, SHELL_GREEN "<%d:eq>" SHELL_RESET1,
+						pgoal->num_c););
+			cert_step(CERT_EQ, pgoal, NULL, NULL, NULL);
+			continue;
+		}
+
+		for (pconst = pexstart->prev_const; pconst != NULL;
+				pconst = pconst->prev_const) {
+			if ((vq_budget != 0 && ++vq_effort > vq_budget)
+					|| BUDGET_EXHAUSTED()) {
+				vq_exhausted = TRUE;
+				return FALSE;
+			}
+			if (verify_eq(cc, pgoal, &pconst)) {
+				DBG_VERIFY(fprintf(stderr, SHELL_GREEN "<%d:%d>" SHELL_RESET1,
+							pgoal->num_c, pconst->num_c););
+				cert_step(CERT_FACT, pgoal, NULL, pconst, NULL);
+				break;
+			}
+		}
+		if (pconst == NULL) {
+			return FALSE;
+		}
+	}
+
+	SET_GFLAG_VRFD
+	return TRUE;
+}
+
 /**
  * @brief Attempts to verify a Pnode based on the consideration of different
  * cases.
@@ -1257,6 +2474,394 @@ unsigned short int verify_cases(Pnode* pn)
 	return FALSE;
 }
 
+/* --- certificates --------------------------------------------------------- */
+/**
+ * @brief Finds a constant sub-tree by its num_c.
+ *
+ * @param pconst first constant sub-tree to be considered
+ * @param num_c number of the constant sub-tree
+ * @param idonly TRUE, if the prev_id chain is followed (instead of the
+ * prev_const chain)
+ *
+ * @return constant sub-tree or NULL, if it is not in the chain
+ */
+Pnode* find_const(Pnode* pconst, int num_c, unsigned short int idonly)
+{
+	while (pconst != NULL && pconst->num_c != num_c) {
+		pconst = idonly ? pconst->prev_id : pconst->prev_const;
+	}
+	return pconst;
+}
+
+/**
+ * @brief Substitutes the variables of a VTree just like init_sub, but with the
+ * constants recorded in a certificate step. Every constant has to be eligible
+ * for the variable, i.e. be found from the perspective like in init_sub.
+ *
+ * @param perspective Pnode from whose perspective constants are known
+ * @param vtree variable tree holding pointers to Pnodes for substitution
+ * @param vflags Vflags corresponding to current substitution
+ * @param subd SUB structure to be initialised
+ * @param st certificate step holding the substitutions
+ * @param exnum Pnode number which must not be exceeded by replaced constants
+ * (not carrying the FRST NFLAG)
+ *
+ * @return FALSE, if the recorded substitution is not possible
+ */
+unsigned short int cert_sub(Pnode* perspective, VTree* vtree, VFlags* vflags,
+		SUB** subd, CertStep* st, int exnum)
+{
+	SUB probe;
+	SUB* prev;
+	Pnode* pconst;
+	unsigned short int frst;
+	int i;
+
+	vtree = pos_in_vtree(vtree);
+
+	if (st->n_binds == 0) {
+		/* the search explores without substitution, if there is nothing to
+		 * be substituted or if init_sub fails (which happens first with
+		 * id-only substitution) */
+		if (perspective->prev_id == NULL) {
+			return TRUE;
+		}
+		for (i = 0; vtree != NULL; vtree = next_var(vtree)) {
+			if (!HAS_VARFLAG_LOCK(vtree->flags) && vtree->pnode != NULL) {
+				probe.vtree = vtree;
+				if (!init_known_const(perspective, &probe, TRUE, TRUE, exnum)) {
+					return TRUE;
+				}
+				i++;
+			}
+		}
+		return (i == 0);
+	}
+
+	i = 0;
+	for (; vtree != NULL; vtree = next_var(vtree)) {
+		if (HAS_VARFLAG_LOCK(vtree->flags) || vtree->pnode == NULL) {
+			continue;
+		}
+		if (i == st->n_binds || st->binds[2 * i] != vtree->pnode->num_c) {
+			break;
+		}
+
+		frst = HAS_VARFLAG_FRST(vtree->flags);
+		pconst = find_const(frst ? perspective->prev_const
+				: perspective->prev_id, st->binds[2 * i + 1], !frst);
+		if (pconst == NULL || (!frst && pconst->num < exnum
+					&& pconst->num_c < exnum)) {
+			break;
+		}
+
+		SET_VARFLAG_LOCK(vtree->flags)
+		SET_VFLAG_SUBD(*vflags)
+
+		prev = *subd;
+		*subd = (SUB*) malloc(sizeof(SUB));
+		(*subd)->prev = prev;
+		(*subd)->sym = *(vtree->pnode->symbol);
+		(*subd)->num = vtree->pnode->parent->num;
+		(*subd)->vtree = vtree;
+		(*subd)->fp = 0;
+		(*subd)->known_const = pconst;
+		sub_var(*subd);
+		i++;
+	}
+
+	return (vtree == NULL && i == st->n_binds);
+}
+
+/**
+ * @brief Checks a step of a certificate, which claims that a goal is equal to
+ * a reachable sub-tree. Instead of searching, the explorer only follows the
+ * branch of the recorded Pnode (verifying its assumptions on the way) until it
+ * reaches the recorded sub-tree, which is compared to the goal once.
+ *
+ * Like in vq_recurs, the substitutions stay in place, while the following
+ * statements of the list are verified.
+ *
+ * @param pexstart Pnode at the beginning of the list
+ * @param goal statement to be verified
+ * @param st certificate step
+ * @param svflags Vflags corresponding to the substitutions of the list
+ * @param subd substitutions of the list
+ * @param exnum Pnode number which must not be exceeded by replaced constants
+ * (not carrying the FRST NFLAG)
+ *
+ * @return TRUE, if the step holds
+ */
+unsigned short int check_reach(Pnode* pexstart, Pnode* goal, CertStep* st,
+		VFlags* svflags, SUB** subd, int exnum)
+{
+	Eqwrapper* eqwrapper;
+	Pnode** pexplorer;
+	BC** checkpoint;
+	VFlags vflags;
+	Pnode* perspective;
+	Pnode* proot;
+	unsigned short int found;
+
+	/* the recorded Pnode has to be on the backtracking path of the search */
+	proot = pexstart;
+	do {
+		while (!move_left(&proot)) {
+			if (!move_up(&proot)) {
+				return FALSE;
+			}
+		}
+	} while (proot->num_c != st->root);
+	if (HAS_SYMBOL(proot) || (proot->vtree == NULL && st->n_binds != 0)) {
+		return FALSE;
+	}
+
+	perspective = goal;
+	move_rightmost(&perspective);
+
+	eqwrapper = (Eqwrapper*) malloc(sizeof(Eqwrapper));
+	pexplorer = (Pnode**) malloc(sizeof(Pnode*));
+	checkpoint = (BC**) malloc(sizeof(BC*));
+
+	*pexplorer = proot;
+	*checkpoint = NULL;
+	vflags = VFLAG_NONE;
+	eqwrapper->pwrapper = eqwrapper->pendwrap = NULL;
+	found = FALSE;
+
+	if (proot->vtree == NULL || cert_sub(perspective, proot->vtree, svflags,
+				subd, st, exnum)) {
+		/* sub-trees are reached just like in attempt_explore and
+		 * next_backwards */
+		if (EXPLORABLE(pexplorer) && !(goal->prev_eq != NULL
+					&& proot->vtree == NULL && IS_EQUALITY(proot))) {
+			bc_push(pexplorer, &eqwrapper, checkpoint, &vflags);
+			*pexplorer = *(proot->child);
+			SET_VFLAG_BRCH(vflags)
+			if (next_forwards(goal, pexplorer, &eqwrapper, checkpoint, &vflags,
+						TRUE)) {
+				while (!(found = ((*pexplorer)->num_c == st->expl))
+						&& next_forwards(goal, pexplorer, &eqwrapper,
+							checkpoint, &vflags, TRUE));
+				if (!found) {
+					/* the branch itself is reached after its exploration */
+					exit_branch(pexplorer, &eqwrapper, checkpoint, &vflags);
+					found = (proot->num_c == st->expl);
+				}
+			}
+		} else {
+			found = (proot->num_c == st->expl);
+		}
+	}
+
+	found = found && verify_eq(cc_context(goal), goal, pexplorer);
+
+	if (HAS_VFLAG_BRCH(vflags)) {
+		exit_branch(pexplorer, &eqwrapper, checkpoint, &vflags);
+	}
+
+	free(eqwrapper);
+	free(pexplorer);
+	free(checkpoint);
+
+	return found;
+}
+
+/**
+ * @brief Substitutes the existential ids of a list forwards, as recorded in a
+ * certificate step (see verify_quantifiers).
+ *
+ * @param pexstart Pnode at the beginning of the list
+ * @param fw_vtree variables collected for forward substitution
+ * @param vflags Vflags corresponding to current substitution
+ * @param subd SUB structure to be initialised
+ * @param st certificate step holding the substitutions
+ *
+ * @return FALSE, if the recorded substitution is not possible
+ */
+unsigned short int cert_forward_sub(Pnode* pexstart, VTree* fw_vtree,
+		VFlags* vflags, SUB** subd, CertStep* st)
+{
+	SUB* prev;
+	Pnode* pid;
+	VTree* viter;
+	int i;
+
+	i = 0;
+	for (viter = pos_in_vtree(fw_vtree); viter != NULL;
+			viter = next_var(viter)) {
+		if (HAS_VARFLAG_LOCK(viter->flags) || viter->pnode == NULL) {
+			continue;
+		}
+		if (i == st->n_binds || st->binds[2 * i] != viter->pnode->num_c
+				|| (pid = find_const(pexstart->prev_id, st->binds[2 * i + 1],
+						TRUE)) == NULL) {
+			return FALSE;
+		}
+
+		SET_VARFLAG_LOCK(viter->flags)
+		SET_VFLAG_SUBD(*vflags)
+
+		prev = *subd;
+		*subd = (SUB*) malloc(sizeof(SUB));
+		(*subd)->prev = prev;
+		(*subd)->vtree = viter;
+		(*subd)->sym = *(viter->pnode->symbol);
+		(*subd)->num = viter->pnode->parent->num;
+		(*subd)->fp = 0;
+		(*subd)->known_const = pid;
+		sub_var(*subd);
+		i++;
+	}
+
+	return (i == st->n_binds);
+}
+
+/**
+ * @brief Verifies a list by checking the steps of a certificate recorded by
+ * the facts strategy (see verify_facts).
+ *
+ * @param pn Pnode to be verified
+ * @param pexstart Pnode at the beginning of the list
+ * @param steps steps of the certificate
+ * @param n_steps number of steps
+ *
+ * @return TRUE, if every step holds
+ */
+unsigned short int check_facts(Pnode* pn, Pnode* pexstart, CertStep* steps,
+		int n_steps)
+{
+	Pnode* pgoal;
+	Pnode* pconst;
+	CC* cc;
+	int i;
+
+	i = 0;
+	for (pgoal = pexstart; pgoal != pn; pgoal = *(pgoal->right)) {
+		if (HAS_SYMBOL(pgoal)) { /* skip formulators */
+			continue;
+		}
+		if (i == n_steps || steps[i].goal != pgoal->num_c
+				|| HAS_NFLAG_NEWC(pgoal) || !HAS_CHILD(pgoal)) {
+			return FALSE;
+		}
+
+		cc = cc_context(pgoal);
+		if (steps[i].kind == CERT_EQ) {
+			if (!check_eq(cc, pgoal)) {
+				return FALSE;
+			}
+		} else if (steps[i].kind == CERT_FACT) {
+			pconst = find_const(pexstart->prev_const, steps[i].expl, FALSE);
+			if (pconst == NULL || !verify_eq(cc, pgoal, &pconst)) {
+				return FALSE;
+			}
+		} else {
+			return FALSE;
+		}
+		i++;
+	}
+
+	return (i == n_steps);
+}
+
+/**
+ * @brief Verifies a list by checking the steps of a certificate recorded by
+ * one of the searching strategies (see verify_quantifiers and vq_recurs). The
+ * goals are visited in the same order as by vq_recurs.
+ *
+ * @param pexstart Pnode at the beginning of the list
+ * @param steps steps of the certificate
+ * @param n_steps number of steps
+ *
+ * @return TRUE, if every step holds
+ */
+unsigned short int check_quantifiers(Pnode* pexstart, CertStep* steps,
+		int n_steps)
+{
+	Eqwrapper* eqwrapper;
+	Pnode** pexplorer;
+	BC** checkpoint;
+	SUB** subd;
+	VFlags vflags;
+	VFlags svflags;
+	VTree* fw_vtree;
+	VTree* vnext;
+	Pnode* goal;
+	unsigned short int carry_over;
+	unsigned short int verified;
+	int exnum;
+	int i;
+
+	eqwrapper = (Eqwrapper*) malloc(sizeof(Eqwrapper));
+	pexplorer = (Pnode**) malloc(sizeof(Pnode*));
+	checkpoint = (BC**) malloc(sizeof(BC*));
+	subd = (SUB**) malloc(sizeof(SUB*));
+
+	*pexplorer = pexstart;
+	*checkpoint = NULL;
+	*subd = NULL;
+	vflags = svflags = VFLAG_NONE;
+	exnum = pexstart->num;
+	eqwrapper->pwrapper = eqwrapper->pendwrap = NULL;
+	fw_vtree = NULL;
+	verified = TRUE;
+	i = 0;
+
+	if (n_steps > 0 && steps[0].kind == CERT_FORWARD) {
+		fw_vtree = collect_forward_vars(pexstart);
+		verified = cert_forward_sub(pexstart, fw_vtree, &svflags, subd,
+				&steps[0]);
+		i++;
+	}
+
+	bc_push(pexplorer, &eqwrapper, checkpoint, &vflags);
+
+	carry_over = FALSE;
+	for (; verified && i < n_steps; i++) {
+		goal = *pexplorer;
+		if (steps[i].goal != goal->num_c) {
+			verified = FALSE;
+		} else if (carry_over) {
+			verified = (steps[i].kind == CERT_CARRY);
+		} else if (steps[i].kind == CERT_EQ) {
+			verified = check_eq(cc_context(goal), goal);
+		} else if (steps[i].kind == CERT_REACH) {
+			verified = check_reach(pexstart, goal, &steps[i], &svflags, subd,
+					exnum);
+		} else {
+			verified = FALSE;
+		}
+
+		carry_over = !HAS_RIGHT(goal);
+		if (verified && !next_forwards(NULL, pexplorer, &eqwrapper,
+					checkpoint, &vflags, FALSE)) {
+			verified = FALSE;
+		}
+		if ((*pexplorer)->num == -1) {
+			/* the dummy node has been reached */
+			break;
+		}
+	}
+	verified = verified && i == n_steps - 1;
+
+	while (*checkpoint != NULL) {
+		bc_pop(pexplorer, &eqwrapper, checkpoint, &vflags, TRUE);
+	}
+	finish_sub(&svflags, subd);
+	for (; fw_vtree != NULL; fw_vtree = vnext) {
+		vnext = fw_vtree->right;
+		free(fw_vtree);
+	}
+
+	free(eqwrapper);
+	free(pexplorer);
+	free(checkpoint);
+	free(subd);
+
+	return verified;
+}
+
 /**
  * @brief Cleanly finishes verification by exiting explored branches and
  * finishing substitution.
@@ -19,7 +19,10 @@
 #define VERIFY_H
 
 #include "pgraph.h"
-#include <gmp.h>
+#include "nogood.h"
+#include "reach.h"
+#include "congr.h"
+#include "perf.h"
 
 typedef enum {
 	VFLAG_NONE = 0,
@@ -28,6 +31,7 @@ typedef enum {
 	VFLAG_WRAP = 4,
 	VFLAG_FRST = 8, /* deprecated */
 	VFLAG_FAIL = 16,
+	VFLAG_RGN = 32, /* return at the end of the current substitution */
 } VFlags;
 
 #define HAS_VFLAG_SUBD(vflags) (vflags & VFLAG_SUBD)
@@ -35,18 +39,21 @@ typedef enum {
 #define HAS_VFLAG_WRAP(vflags) (vflags & VFLAG_WRAP)
 #define HAS_VFLAG_FRST(vflags) (vflags & VFLAG_FRST)
 #define HAS_VFLAG_FAIL(vflags) (vflags & VFLAG_FAIL)
+#define HAS_VFLAG_RGN(vflags) (vflags & VFLAG_RGN)
 
 #define SET_VFLAG_SUBD(vflags) vflags |= VFLAG_SUBD;
 #define SET_VFLAG_BRCH(vflags) vflags |= VFLAG_BRCH;
 #define SET_VFLAG_WRAP(vflags) vflags |= VFLAG_WRAP;
 #define SET_VFLAG_FRST(vflags) vflags |= VFLAG_FRST;
 #define SET_VFLAG_FAIL(vflags) vflags |= VFLAG_FAIL;
+#define SET_VFLAG_RGN(vflags) vflags |= VFLAG_RGN;
 
 #define UNSET_VFLAG_SUBD(vflags) vflags &= ~VFLAG_SUBD;
 #define UNSET_VFLAG_BRCH(vflags) vflags &= ~VFLAG_BRCH;
 #define UNSET_VFLAG_WRAP(vflags) vflags &= ~VFLAG_WRAP;
 #define UNSET_VFLAG_FRST(vflags) vflags &= ~VFLAG_FRST;
 #define UNSET_VFLAG_FAIL(vflags) vflags &= ~VFLAG_FAIL;
+#define UNSET_VFLAG_RGN(vflags) vflags &= ~VFLAG_RGN;
 
 #define POS_FRST(pexplorer, vflags) \
 	(HAS_NFLAG_FRST((*pexplorer)) || HAS_VFLAG_FRST((*vflags)))
@@ -64,6 +71,7 @@ typedef struct branch_checkpoint { /* stack for jumping back to parent levels */
 	unsigned short int fail;
 	Pnode* pwrapper;
 	Pnode* pendwrap;
+	int depth;		/* number of checkpoints on the stack */
 	struct branch_checkpoint* above;
 } BC;
 
@@ -73,20 +81,119 @@ typedef struct substitution_status {
 	char* sym;			/* symbol of substituted variable */
 	int num;			/* node number of substituted variable */
 	VTree* vtree;		/* substituted variable */
+	uint64_t fp;		/* contribution to bind_fp */
 	struct substitution_status* prev;
 	struct substitution_status* next;
 } SUB;
 
+/* candidate sets for forward substitution of existential ids */
+#define CS_WORDBITS (8 * sizeof(unsigned long))
+#define CS_WORDS(n) (((n) + CS_WORDBITS - 1) / CS_WORDBITS)
+#define CS_HAS(bits, i) (bits[(i) / CS_WORDBITS] & (1UL << ((i) % CS_WORDBITS)))
+#define CS_SET(bits, i) bits[(i) / CS_WORDBITS] |= (1UL << ((i) % CS_WORDBITS));
+
+typedef struct candidate_set {
+	Pnode** known;		/* ids known before the existential statement */
+	int n_known;		/* number of known ids */
+	int n_words;		/* number of words in a single bitset */
+	int n_vars;			/* number of variables to be substituted */
+	VTree** vars;		/* variables in order of substitution */
+	unsigned long* bits;/* one bitset over known ids per variable */
+	int* cur;			/* index of currently substituted known id */
+} CSet;
+
+/* states of a level of the search */
+typedef enum {
+	VQ_NEXT = 0,	/* next reachable sub-tree is to be examined */
+	VQ_RETURN,		/* level of the following statement has finished */
+} VQState;
+
+/* outcome of a step of the search (see search_step) */
+typedef enum {
+	SEARCH_RUNNING = 0,	/* search has been suspended */
+	SEARCH_FOUND,		/* statements of the list have been verified */
+	SEARCH_FAILED,
+} SearchStatus;
+
+/* level of the search, i.e. the statement of the list being verified */
+typedef struct vq_frame {
+	VQState state;
+	unsigned short int carry_over;
+	unsigned short int eq_hit;	/* TRUE, if the statement follows from a known
+								   equality */
+	Pnode* expl_cp;				/* statement, when the following level has
+								   been started */
+	Pnode* perspective;			/* perspective for substitutions */
+	Eqwrapper* eqwrapper;		/* explorer of reachable sub-trees */
+	Pnode** pexplorer;
+	BC** checkpoint;
+	SUB** subd;
+	VFlags vflags;
+	Replay replay;
+	CC* cc;
+	uint64_t ng_aux;			/* context of the level as nogood */
+	Eqwrapper p_eqwrapper_cp;	/* state of the parent explorer to be restored
+								   on failure */
+	BC* p_checkpoint_cp;
+	VFlags p_vflags_cp;
+	struct vq_frame* below;		/* level of the previous statement */
+} VQFrame;
+
+/* search for the statements of a list (explicit stack of levels instead of
+ * recursion, see vq_recurs) */
+typedef struct search {
+	Pnode* pexstart;
+	Pnode* p_perspective;
+	Pnode** p_pexplorer;		/* parent explorer advancing through the list */
+	Eqwrapper** p_eqwrapper;
+	BC** p_checkpoint;
+	VFlags* p_vflags;
+	unsigned short int idonly;
+	int exnum;
+	VQFrame* top;				/* level of the current statement */
+	unsigned short int result;	/* outcome of the level finished last */
+	unsigned short int aborted;	/* TRUE, if the search has been aborted */
+} Search;
+
 //unsigned short int verify_universal(Pnode* pn);
 unsigned short int verify_quantifiers(Pnode* pn, Pnode* pexstart,
-		unsigned short int idonly);
+		unsigned short int idonly, unsigned short int forward);
+unsigned short int verify_facts(Pnode* pn, Pnode* pexstart);
 unsigned short int verify_cases(Pnode* pn);
 
 unsigned short int are_equal(Pnode* p1, Pnode* p2);
 
+/* for searching the statements of a list step by step */
+void search_init(Search* s, Pnode* pexstart, Pnode* p_perspective,
+		Pnode** p_pexplorer, Eqwrapper** p_eqwrapper, BC** p_checkpoint,
+		VFlags* p_vflags, unsigned short int idonly, int exnum,
+		unsigned short int carry_over);
+SearchStatus search_step(Search* s, uint64_t units);
+void search_abort(Search* s);
+
+/* for replaying certificates (see cert.h) */
+struct cert_step;
+unsigned short int check_facts(Pnode* pn, Pnode* pexstart,
+		struct cert_step* steps, int n_steps);
+unsigned short int check_quantifiers(Pnode* pexstart, struct cert_step* steps,
+		int n_steps);
+
 /* for verification */
 void finish_verify();
 unsigned short int verify(Pnode* pnode, Pnode** pexplorer);
+unsigned short int const_equal(Pnode* p1, Pnode* p2);
+unsigned short int check_asmp(Pnode* perspective, Pnode** pexplorer,
+		unsigned short int exst);
+unsigned short int verify_eq(CC* cc, Pnode* pnode, Pnode** pexplorer);
+unsigned short int check_eq(CC* cc, Pnode* goal);
+
+/* for substitution */
+unsigned short int init_sub(Pnode* perspective, VTree* vtree, VFlags* vflags,
+		SUB** subd, unsigned short int idonly, unsigned short int exst,
+		int exnum);
+unsigned short int next_sub(Pnode* perspective, SUB* s,
+		unsigned short int idonly, unsigned short int exst, int exnum);
+void finish_sub(VFlags* vflags, SUB** subd);
 
 /* for backtracking */
 unsigned short int next_backwards(Pnode* veri_perspec,
@@ -94,8 +201,24 @@ unsigned short int next_backwards(Pnode* veri_perspec,
 		BC** checkpoint, VFlags* vflags, SUB** subd,
 		unsigned short int idonly, unsigned short int exst, int exnum,
 		unsigned short int do_sub, unsigned short int p_a);
+void init_replay(Replay* rp, Pnode* pexstart, Pnode* veri_perspec,
+		Pnode* sub_perspec, unsigned short int exst, int exnum,
+		unsigned short int do_sub, unsigned short int p_a);
+void finish_replay(Replay* rp);
+unsigned short int next_reachable(Replay* rp, Pnode* veri_perspec,
+		Pnode* sub_perspec, Pnode** pexplorer, Eqwrapper** eqwrapper,
+		BC** checkpoint, VFlags* vflags, SUB** subd,
+		unsigned short int idonly, unsigned short int exst, int exnum,
+		unsigned short int do_sub, unsigned short int p_a);
+
+/* effort (i.e. number of reachable sub-trees examined) of the current
+ * verification strategy and its budget (0 for unlimited) */
+uint64_t vq_effort;
+uint64_t vq_budget;
+unsigned short int vq_exhausted;
+
+/* units of every step of a search, which is aborted after its first step and
+ * started again (0 for uninterrupted searches, see "--dsteps") */
+uint64_t vq_steps;
 
-#ifdef DGMP
-mpz_t comp_count;
-#endif
 #endif /* VERIFY_H */